@@ -0,0 +1,38 @@
+#ifndef ACCURACY_H
+#define ACCURACY_H
+
+#include <cstdint>
+
+/*
+    Accuracy policies. The interpreter's step (CPUEmu.cpp), the op functions that touch memory and the PPU
+    are templates on one of these, so the fast and the accurate emulator are built from the same source and
+    neither one has a check for the other's behaviour. Which one runs is picked with CPU::setAccuracy.
+*/
+
+// Instruction granular: everything else catches up once an instruction is done, decoded blocks, fusion, the JIT and AOT code can all be used
+struct FastAccuracy
+{
+    static constexpr bool TIMED_ACCESSES = false;
+    static constexpr bool HALT_BUG = false;
+    static constexpr bool STAT_BLOCKING = false;
+    static constexpr bool PIXEL_FIFO = false;
+    static constexpr bool LAZY_PPU = true;          // the PPU is only caught up when something could see it or it is due to change mode
+};
+
+// Sub-instruction: one instruction at a time through the interpreter
+struct CycleAccuracy
+{
+    static constexpr bool TIMED_ACCESSES = true;    // the PPU, timers and DMA are caught up to every memory access (fetches too) before it happens
+    static constexpr bool HALT_BUG = true;          // HALT with IME off and an interrupt pending doesn't halt and the next byte is read twice
+    static constexpr bool STAT_BLOCKING = true;     // the STAT interrupt only fires when its sources ORed together go from 0 to 1
+    static constexpr bool PIXEL_FIFO = true;        // mode 3 is drawn a pixel at a time by the fetcher and FIFOs, so it varies in length and sees mid-line writes
+    static constexpr bool LAZY_PPU = false;
+};
+
+enum class AccuracyMode : uint8_t
+{
+    Fast,
+    Cycle
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,351 @@
+#ifndef AOTRUNTIME_H
+#define AOTRUNTIME_H
+
+#include <cstdint>
+#include <array>
+
+#include "CPU.hpp"
+
+/*
+    What code generated by tools/RomToCpp builds on. A game's ROM is walked from its entry point and
+    vectors ahead of time and every basic block found becomes a C++ function, so at run time a block
+    costs no fetching, decoding or dispatching. Blocks are entered at any of their instructions.
+    A run of instructions the generator wrote out is charged its cycles in one go when nothing the
+    interpreter would stop for (PPU, timers, input, end of the run) is due before it is over, and
+    its instructions then skip the bookkeeping in between. Otherwise, or when one of them touches
+    memory that isn't plain (IO, VRAM, a mapper register), instructions end like they do in the
+    interpreter, so where a generated block stops, or for code the walk never found, the interpreter takes over.
+*/
+
+// Where one instruction of a generated block is, the same block is listed once per instruction in it
+struct AotEntry
+{
+    uint16_t bank;
+    uint16_t pc;
+    AotBlock block;
+};
+
+// Everything generated for one game, found again by the hash of the ROM it was made from
+struct AotProgram
+{
+    uint32_t romHash;       // Cartridge::getROMHash
+    uint16_t romBanks;
+    const AotEntry* entries;
+    uint32_t entryCount;
+};
+
+struct AotRuntime
+{
+    // Generated files register their program from a static initializer (definitions in CPUAot.cpp)
+    static bool registerProgram(const AotProgram& program);
+    static const AotProgram* findProgram(uint32_t romHash, uint16_t romBanks);
+
+    /* What a generated block does to the CPU, the same as the op functions in CPUOpcode.cpp */
+    static uint8_t& reg(CPU& cpu, uint8_t index)
+    {
+        return cpu.registers[index];
+    }
+
+    static uint16_t& pair(CPU& cpu, uint8_t index)
+    {
+        return cpu.registers.pair(index);
+    }
+
+    static uint16_t& sp(CPU& cpu)
+    {
+        return cpu.sp;
+    }
+
+    static uint16_t& pc(CPU& cpu)
+    {
+        return cpu.pc;
+    }
+
+    static void addCycles(CPU& cpu, uint8_t mCycles)
+    {
+        cpu.cycleCount += mCycles;
+    }
+
+    /* Runs (see CPU::updateRunHorizon) */
+    static bool charge(CPU& cpu, uint16_t mCycles)
+    {
+        uint64_t runEnd{cpu.cyclesSincePowerOn + 4 * mCycles};
+        if(runEnd >= cpu.mRunHorizon)
+        {
+            return false;
+        }
+        cpu.cyclesSincePowerOn = runEnd;
+        cpu.mPPUPendingCycles += mCycles;
+        return true;
+    }
+
+    // what is left of the run is taken back, the instruction ends like in the interpreter after all
+    static bool uncharge(CPU& cpu, uint16_t mCycles)
+    {
+        cpu.cyclesSincePowerOn -= 4 * mCycles;
+        cpu.mPPUPendingCycles -= mCycles;
+        return false;
+    }
+
+    /* Memory, a charged instruction only touches what readMemory and writeMemory would read and write straight (pages and HRAM) */
+    static bool isHRAM(uint16_t addr)
+    {
+        return (addr >= HRAM_LOC) && (addr < INTERRUPT_ENABLE);
+    }
+
+    static bool canRead(CPU& cpu, uint16_t addr)
+    {
+        return (cpu.mPages.read[addr >> PAGE_SHIFT] != nullptr) || isHRAM(addr);
+    }
+
+    static bool canWrite(CPU& cpu, uint16_t addr)
+    {
+        return (cpu.mPages.write[addr >> PAGE_SHIFT] != nullptr) || isHRAM(addr);
+    }
+
+    static uint8_t read(CPU& cpu, bool charged, uint16_t addr)
+    {
+        if(!charged)
+        {
+            return cpu.readMemory(addr);
+        }
+        const uint8_t* page{cpu.mPages.read[addr >> PAGE_SHIFT]};
+        return (page != nullptr) ? page[addr & PAGE_MASK] : cpu.memMap[addr];
+    }
+
+    // the m-cycles fetching them took, for where an uncharged LCD write lands in the line
+    static void fetchOperands(CPU& cpu, bool charged, uint8_t count)
+    {
+        if(!charged)
+        {
+            cpu.mAccessCycles += count;
+        }
+    }
+
+    static void write(CPU& cpu, bool charged, uint16_t addr, uint8_t data)
+    {
+        if(!charged)
+        {
+            cpu.writeMemory(addr, data);
+            return;
+        }
+        uint8_t* page{cpu.mPages.write[addr >> PAGE_SHIFT]};
+        if(page != nullptr)
+        {
+            page[addr & PAGE_MASK] = data;
+        }
+        else
+        {
+            cpu.memMap[addr] = data;
+        }
+    }
+
+    /* Stack */
+    static bool canPush(CPU& cpu)
+    {
+        return canWrite(cpu, cpu.sp - 1) && canWrite(cpu, cpu.sp - 2);
+    }
+
+    static bool canPop(CPU& cpu)
+    {
+        return canRead(cpu, cpu.sp) && canRead(cpu, cpu.sp + 1);
+    }
+
+    static void push(CPU& cpu, bool charged, uint16_t data)
+    {
+        cpu.sp--;
+        write(cpu, charged, cpu.sp, data >> 8);
+        cpu.sp--;
+        write(cpu, charged, cpu.sp, data & 0xFF);
+    }
+
+    static uint16_t pop(CPU& cpu, bool charged)
+    {
+        uint8_t lower{read(cpu, charged, cpu.sp)};
+        cpu.sp++;
+        uint8_t upper{read(cpu, charged, cpu.sp)};
+        cpu.sp++;
+        return (upper << 8) | lower;
+    }
+
+    static uint16_t getAF(CPU& cpu)
+    {
+        cpu.materializeFlags();
+        return (cpu.registers[R_A] << 8) | cpu.registers[R_F];
+    }
+
+    static void setAF(CPU& cpu, uint16_t data)
+    {
+        cpu.registers[R_F] = data & 0xF0;
+        cpu.registers[R_A] = data >> 8;
+        cpu.mFlagOp = FLAG_OP_NONE;
+    }
+
+    /* ALU and flags */
+    static void setFlag(CPU& cpu, uint8_t flag, bool set)
+    {
+        cpu.registers[R_F] = set ? (cpu.registers[R_F] | (1 << flag)) : (cpu.registers[R_F] & ~(1 << flag));
+    }
+
+    // ADD ADC SUB SBC AND XOR OR CP, in the order of the opcode's middle bits
+    static void alu(CPU& cpu, uint8_t operation, uint8_t operand)
+    {
+        uint8_t a{cpu.registers[R_A]};
+        bool carry{false};
+        switch(operation)
+        {
+            case 0:
+            case 1:
+                carry = (operation == 1) && cpu.carryFlag();
+                cpu.registers[R_A] = a + operand + carry;
+                cpu.add8Bit(a, operand, carry);
+                break;
+            case 2:
+            case 3:
+                carry = (operation == 3) && cpu.carryFlag();
+                cpu.registers[R_A] = a - operand - carry;
+                cpu.sub8Bit(a, operand, carry);
+                break;
+            case 4:
+                cpu.registers[R_A] = a & operand;
+                cpu.logic8Bit(cpu.registers[R_A], true);
+                break;
+            case 5:
+                cpu.registers[R_A] = a ^ operand;
+                cpu.logic8Bit(cpu.registers[R_A], false);
+                break;
+            case 6:
+                cpu.registers[R_A] = a | operand;
+                cpu.logic8Bit(cpu.registers[R_A], false);
+                break;
+            case 7:
+                cpu.sub8Bit(a, operand, false);
+                break;
+        }
+    }
+
+    static uint8_t inc(CPU& cpu, uint8_t data)
+    {
+        cpu.inc8Bit(data);
+        return data + 1;
+    }
+
+    static uint8_t dec(CPU& cpu, uint8_t data)
+    {
+        cpu.dec8Bit(data);
+        return data - 1;
+    }
+
+    static void addHL(CPU& cpu, uint16_t operand)
+    {
+        cpu.materializeFlags();
+        uint16_t hl{cpu.registers.pair(RP_HL)};
+        cpu.registers.pair(RP_HL) = hl + operand;
+        setFlag(cpu, F_N, false);
+        setFlag(cpu, F_H, ((hl & 0xFFF) + (operand & 0xFFF)) > 0xFFF);
+        setFlag(cpu, F_C, (hl + operand) > 0xFFFF);
+    }
+
+    // CB rotates and shifts: RLC RRC RL RR SLA SRA SWAP SRL, the same as CPU::opROT
+    static uint8_t rotate(CPU& cpu, uint8_t operation, uint8_t data)
+    {
+        cpu.materializeFlags();
+        uint8_t result{0};
+        switch(operation)
+        {
+            case 0:
+                result = cpu.opRLCr(data);
+                break;
+            case 1:
+                result = cpu.opRRCr(data);
+                break;
+            case 2:
+                result = cpu.opRLr(data);
+                break;
+            case 3:
+                result = cpu.opRRr(data);
+                break;
+            case 4:
+                result = cpu.opSLAr(data);
+                break;
+            case 5:
+                result = cpu.opSRAr(data);
+                break;
+            case 6:
+                result = cpu.opSWAPr(data);
+                setFlag(cpu, F_C, false);
+                break;
+            case 7:
+                result = cpu.opSRLr(data);
+                break;
+        }
+        setFlag(cpu, F_N, false);
+        setFlag(cpu, F_H, false);
+        setFlag(cpu, F_Z, result == 0);
+        return result;
+    }
+
+    // RLCA RRCA RLA RRA, like their CB versions but Z is always reset
+    static void rotateA(CPU& cpu, uint8_t operation)
+    {
+        cpu.registers[R_A] = rotate(cpu, operation, cpu.registers[R_A]);
+        setFlag(cpu, F_Z, false);
+    }
+
+    static void bit(CPU& cpu, uint8_t position, uint8_t data)
+    {
+        cpu.materializeFlags();
+        setFlag(cpu, F_Z, ((data >> position) & 1) == 0);
+        setFlag(cpu, F_N, false);
+        setFlag(cpu, F_H, true);
+    }
+
+    static void cpl(CPU& cpu)
+    {
+        cpu.materializeFlags();
+        cpu.registers[R_A] = ~cpu.registers[R_A];
+        setFlag(cpu, F_N, true);
+        setFlag(cpu, F_H, true);
+    }
+
+    // SCF sets the carry, CCF flips it
+    static void setCarry(CPU& cpu, bool flip)
+    {
+        cpu.materializeFlags();
+        setFlag(cpu, F_C, !flip || ((cpu.registers[R_F] & (1 << F_C)) == 0));
+        setFlag(cpu, F_N, false);
+        setFlag(cpu, F_H, false);
+    }
+
+    // cc of JR cc / JP cc / CALL cc / RET cc, NZ Z NC C
+    static bool condition(CPU& cpu, uint8_t condition)
+    {
+        return cpu.passedCondition(condition);
+    }
+
+    // instructions the generator does not write out itself are run by the interpreter from their bytes
+    static void execute(CPU& cpu, std::array<uint8_t, 3> bytes)
+    {
+        cpu.executeBytes(bytes.data());
+    }
+
+    // after an instruction that was not charged, false if the block has to stop here
+    static bool next(CPU& cpu, uint16_t nextPC)
+    {
+        cpu.endInstruction();
+        if(!cpu.continueBlock(nextPC))
+        {
+            return false;
+        }
+        cpu.updateRunHorizon();
+        return true;
+    }
+
+    // after the last instruction of a block when it was not charged
+    static void end(CPU& cpu)
+    {
+        cpu.endInstruction();
+    }
+};
+
+#endif
\ No newline at end of file
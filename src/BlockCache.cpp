@@ -0,0 +1,92 @@
+#include "BlockCache.hpp"
+
+std::shared_ptr<const DecodedBlock> BlockCache::find(const uint8_t* code) const
+{
+    auto block{mBlocks.find(code)};
+    if(block == mBlocks.end())
+    {
+        return nullptr;
+    }
+    return block->second;
+}
+
+void BlockCache::insert(const uint8_t* code, const uint8_t* page, uint16_t length, std::shared_ptr<const DecodedBlock> block)
+{
+    mBlocks[code] = block;
+    forEachCodeChunk(code, page, length, [this, code](const uint8_t* chunk) { mChunkBlocks[chunk].push_back(code); });
+}
+
+void BlockCache::invalidateChunk(const uint8_t* chunk)
+{
+    // a block in two chunks stays listed in the other one, dropping it again from there is harmless
+    auto chunkBlocks{mChunkBlocks.find(chunk)};
+    if(chunkBlocks == mChunkBlocks.end())
+    {
+        return;
+    }
+
+    for(const uint8_t* code : chunkBlocks->second)
+    {
+        mBlocks.erase(code);
+    }
+    mChunkBlocks.erase(chunkBlocks);
+}
+
+void BlockCache::invalidatePage(const uint8_t* page)
+{
+    for(uint8_t i{0}; i < CODE_CHUNKS_PER_PAGE; i++)
+    {
+        invalidateChunk(page + (i * CODE_CHUNK_SIZE));
+    }
+}
+
+void BlockCache::flush()
+{
+    mBlocks.clear();
+    mChunkBlocks.clear();
+}
+
+uint8_t BlockCache::getLength(uint8_t opcode)
+{
+    switch(opcode)
+    {
+        // LD rr,nn / LD (nn),SP / JP / CALL / LD (nn),A / LD A,(nn)
+        case 0x01: case 0x11: case 0x21: case 0x31: case 0x08:
+        case 0xC2: case 0xC3: case 0xCA: case 0xD2: case 0xDA:
+        case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC:
+        case 0xEA: case 0xFA:
+            return 3;
+
+        // LD r,n / JR / LDH / ADD SP,d / LD HL,SP+d / ALU n / CB prefix
+        case 0x06: case 0x0E: case 0x16: case 0x1E: case 0x26: case 0x2E: case 0x36: case 0x3E:
+        case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+        case 0xE0: case 0xF0: case 0xE8: case 0xF8:
+        case 0xC6: case 0xCE: case 0xD6: case 0xDE: case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+        case 0xCB:
+            return 2;
+    }
+
+    // STOP is run as HALT, which does not skip the byte after it
+    return 1;
+}
+
+bool BlockCache::endsBlock(uint8_t opcode)
+{
+    switch(opcode)
+    {
+        // JR, JP, CALL, RET, RETI, RST, JP HL
+        case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+        case 0xC2: case 0xC3: case 0xCA: case 0xD2: case 0xDA: case 0xE9:
+        case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC:
+        case 0xC0: case 0xC8: case 0xD0: case 0xD8: case 0xC9: case 0xD9:
+        case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+
+        // HALT, STOP, EI (the interrupt enable delay is left to the interpreter loop)
+        case 0x76: case 0x10: case 0xFB:
+
+        // unused opcodes
+        case 0xD3: case 0xDB: case 0xDD: case 0xE3: case 0xE4: case 0xEB: case 0xEC: case 0xED: case 0xF4: case 0xFC: case 0xFD:
+            return true;
+    }
+    return false;
+}
\ No newline at end of file
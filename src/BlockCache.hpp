@@ -0,0 +1,103 @@
+#ifndef BLOCKCACHE_H
+#define BLOCKCACHE_H
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+/* BLOCK CACHE */
+constexpr uint8_t BLOCK_MAX_INSTRUCTIONS = 32;
+constexpr uint8_t FUSED_MAX_BYTES = 8;      // longest run of instructions done by one fused op
+constexpr uint8_t NOT_FUSED = 0xFF;
+constexpr uint8_t LOOP_FILL = 0xFF;         // LoopShape::source for loops that store A
+constexpr uint8_t LOOP_COUNTER_BC = 0xFF;   // LoopShape::counter for DEC BC / LD A,B / OR C
+
+/* CODE CHUNKS (what a write to work RAM code drops) */
+constexpr uint8_t CODE_CHUNK_SHIFT = 8;
+constexpr uint16_t CODE_CHUNK_SIZE = 0x100;
+constexpr uint16_t CODE_CHUNK_MASK = 0x00FF;
+constexpr uint16_t CODE_CHUNK_COUNT = 0x100;            // chunks in the whole address space
+constexpr uint8_t CODE_CHUNKS_PER_PAGE = 16;            // of the 4 KB pages
+constexpr uint8_t CODE_CHUNK_MAX_INVALIDATIONS = 16;    // a chunk written over this often has its code interpreted from then on
+
+class CPU;
+
+/*
+    What one iteration of a copy or fill loop does, so a run of iterations can be done as one copy.
+    The counter is a register counted down by DEC r, which can't be half of either pointer,
+    or BC tested with LD A,B / OR C (only for copies, A is overwritten every iteration).
+*/
+struct LoopShape
+{
+    uint8_t source;     // register pair read through, or LOOP_FILL to store A
+    int8_t sourceStep;
+    uint8_t dest;       // register pair written through
+    int8_t destStep;
+    uint8_t counter;    // register index, or LOOP_COUNTER_BC
+    uint8_t cycles;     // m-cycles of an iteration that jumps back, 0 for sequences that are not loops
+};
+
+// One instruction decoded ahead of time, everything the op function would have fetched and decoded itself
+struct DecodedOp
+{
+    void (CPU::*handler)(); // nullptr for the unused opcodes, which do nothing
+    uint8_t opcode;         // the byte after 0xCB for prefixed ops
+    uint8_t opcodeLength;   // 2 for prefixed ops, the op function expects pc past these bytes
+    uint8_t length;         // opcode and operands
+    uint8_t XX;
+    uint8_t YYY;
+    uint8_t ZZZ;
+    uint8_t P;
+    uint8_t Q;
+    uint8_t operands[FUSED_MAX_BYTES];
+
+    // a fused op does several instructions in one go and has every byte of them in operands
+    // it returns false when it had to stop between two of them (see CPUFusion.cpp)
+    bool (CPU::*fused)(const DecodedOp& op);
+    uint8_t fusedIndex;
+    const LoopShape* loop;  // the whole op is a loop that jumps back to itself
+};
+
+using DecodedBlock = std::vector<DecodedOp>;
+
+/*
+    Straight runs of guest code, decoded once and run from here until a branch.
+    Like the recompiler, blocks are keyed by the host address of their first byte (so the bank is part
+    of the key) and never cross a 4 KB page. A write to a 256 byte chunk of a page only drops the blocks
+    made from that chunk, so data kept next to code doesn't throw the code away.
+*/
+class BlockCache
+{
+    public:
+        // nullptr if the block starting at code has not been decoded yet
+        std::shared_ptr<const DecodedBlock> find(const uint8_t* code) const;
+        // length is how many bytes of guest code the block was made from
+        void insert(const uint8_t* code, const uint8_t* page, uint16_t length, std::shared_ptr<const DecodedBlock> block);
+
+        // Drop every block made from this chunk or page (it was written to), a running block is kept alive by its owner
+        void invalidateChunk(const uint8_t* chunk);
+        void invalidatePage(const uint8_t* page);
+        void flush();
+
+        // Instruction lengths and which instructions end a block, shared with the recompiler
+        static uint8_t getLength(uint8_t opcode);
+        static bool endsBlock(uint8_t opcode);
+
+    private:
+        std::unordered_map<const uint8_t*, std::shared_ptr<const DecodedBlock>> mBlocks;
+        std::unordered_map<const uint8_t*, std::vector<const uint8_t*>> mChunkBlocks;
+};
+
+// Calls f with the start of every chunk of page that [code, code + length) touches
+template<class F>
+void forEachCodeChunk(const uint8_t* code, const uint8_t* page, uint16_t length, F f)
+{
+    uint16_t offset{static_cast<uint16_t>(code - page)};
+    for(uint16_t chunk{static_cast<uint16_t>(offset & ~CODE_CHUNK_MASK)}; chunk < offset + length; chunk += CODE_CHUNK_SIZE)
+    {
+        f(page + chunk);
+    }
+}
+
+#endif
\ No newline at end of file
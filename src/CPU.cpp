@@ -1,5 +1,8 @@
 #include "CPU.hpp"
 
+// what the ROM area reads as until a cartridge is loaded
+static const uint8_t emptyROM[2*ROM_BANK_SIZE]{};
+
 CPU::CPU()
 {
     isHalted = false;
@@ -13,22 +16,56 @@ CPU::CPU()
     mJoypad = Joypad();
 
     // Register resetting
-    memset(registers, 0, 8);
+    memset(registers.r8, 0, sizeof(registers.r8));
+
+    mLazyFlags = true;
+    mFlagOp = FLAG_OP_NONE;
+    mFlagOperand1 = 0;
+    mFlagOperand2 = 0;
+    mFlagCarry = false;
 
     // Initialize memory map
     memMap = std::vector<uint8_t>(0x10000, 0);
 
-    maxRAMBanks = 1;
-    maxROMBanks = 2;
-    curROMBank = 1;
-    curRAMBank = 1;
-
-    enableRAM = false;
-    doingROMBanking = true;
+    mExtRAM = nullptr;
+    mExtRAMSize = 0;
+    mSaveExtra = nullptr;
+
+    // nothing is mapped until a cartridge is loaded
+    memset(&mPages, 0, sizeof(mPages));
+    mapWorkRAM();
+    mMapper = std::make_unique<MapperNoMBC>(emptyROM, 2, mExtRAM, mExtRAMSize, mPages);
+
+    mDMACyclesLeft = 0;
+    mDMASource = 0;
+    memset(&mDMASavedPages, 0, sizeof(mDMASavedPages));
+
+    mBlockCacheEnabled = true;
+    mOperands = nullptr;
+    mFusionEnabled.fill(true);
+    mFusionHits.fill(0);
+    mBulkIterations = 0;
+    mBulkCycles = 0;
+    mJitEnabled = false;
+    mRunHorizon = 0;
+    mAotEnabled = true;
+    memset(mCodePages, 0, sizeof(mCodePages));
+    memset(mCodeChunks, 0, sizeof(mCodeChunks));
+    memset(mChunkInvalidations, 0, sizeof(mChunkInvalidations));
+    mBlockPage = nullptr;
+    mBlockDirty = false;
+    mPPUPendingCycles = 0;
+    mPPUDeadline = 0;
+    mRunUntil = 0;
+    mStopAtVBlank = false;
+    mNextInputEvent = NO_INPUT_EVENT;
+
+    // the fast core until told otherwise
+    setAccuracy(AccuracyMode::Fast);
 
     // Reset cycle count
     cycleCount = 0;
-    totalCycleCount = 0;
+    cyclesSincePowerOn = 0;
 
     // Resetting opcode decode variables
     opcode = 0;
@@ -57,7 +94,6 @@ CPU::CPU()
     memMap[0xFF00] = 0xFF;
     memMap[0xFF01] = 0x00;
     memMap[0xFF02] = 0x7E;
-    memMap[0xFF04] = 0x18;
     memMap[0xFF05] = 0x00;
     memMap[0xFF06] = 0x00;
     memMap[0xFF07] = 0xf8;
@@ -94,13 +130,12 @@ CPU::CPU()
     memMap[0xFF4A] = 0x00;
     memMap[0xFF4B] = 0x00;
     memMap[0xFFFF] = 0x00;
-
-
-
+    updatePendingInterrupts();
 }
 
 CPU::~CPU()
 {
+    flushSaveRAM();
 
 }
 
@@ -108,3 +143,8 @@ uint8_t* CPU::getPPUArray()
 {
     return mPPU.mPixelArray.data();
 }
+
+void CPU::setRenderEnabled(bool enabled)
+{
+    mPPU.setRenderEnabled(enabled);
+}
\ No newline at end of file
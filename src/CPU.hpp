@@ -10,12 +10,18 @@
 #include <chrono>
 #include <filesystem>
 #include <cstring>
+#include <array>
+#include <deque>
 #include <SDL_keyboard.h>
 
 #include "Helper.hpp"
 #include "PPU.hpp"
 #include "Timers.hpp"
 #include "Joypad.hpp"
+#include "Cartridge.hpp"
+#include "Mapper.hpp"
+#include "Jit.hpp"
+#include "Accuracy.hpp"
 
 /* DEBUG FLAG */
 constexpr bool DEBUG_MODE = false;
@@ -24,11 +30,36 @@ constexpr bool DEBUG_MODE = false;
 constexpr uint8_t DISPLAY_WIDTH = 160;
 constexpr uint8_t DISPLAY_HEIGHT = 144;
 
+/* 
+    A frame is 154 scanlines of 456 dots, 70224 t-cycles (4194304 Hz / 70224 is the 59.7 Hz refresh rate).
+    With the LCD on runFrame stops at VBlank instead, which comes around that often, this is only how long it
+    runs for with the LCD off (plus a scanline of leeway with it on, in case the LCD is turned off mid-frame)
+*/
+constexpr uint32_t CYCLES_PER_FRAME = 70224;
+
 /* CONFIGURABLE SPECS */
 constexpr uint32_t CGB_HZ = 8388608; // 8.388608 MHz
 constexpr uint32_t DMG_HZ = 4194304; // 4.194304 MHz
 constexpr uint32_t DIV_HZ = 16384;
 
+/* INPUT */
+constexpr uint64_t NO_INPUT_EVENT = UINT64_MAX; // nothing queued
+
+// A key change from the host, applied once emulated time reaches its timestamp
+struct InputEvent
+{
+    uint64_t timestamp;
+    SDL_Scancode key;
+    bool pressed;
+};
+
+// What the host has given the core that save states leave out, queued key changes and the buttons held down
+struct HostInput
+{
+    std::deque<InputEvent> queue;
+    uint16_t heldButtons;
+};
+
 /* FLAG REGISTER */
 constexpr uint8_t F_Z = 7;
 constexpr uint8_t F_N = 6;
@@ -42,6 +73,15 @@ constexpr uint8_t F_YES_Z = 1;
 constexpr uint8_t F_NO_C = 2;
 constexpr uint8_t F_YES_C = 3;
 
+/* LAZY FLAGS (the last ALU op, kept until F is read) */
+constexpr uint8_t FLAG_OP_NONE = 0; // F is up to date
+constexpr uint8_t FLAG_OP_ADD = 1;  // ADD/ADC
+constexpr uint8_t FLAG_OP_SUB = 2;  // SUB/SBC/CP
+constexpr uint8_t FLAG_OP_INC = 3;
+constexpr uint8_t FLAG_OP_DEC = 4;
+constexpr uint8_t FLAG_OP_AND = 5;
+constexpr uint8_t FLAG_OP_OR = 6;   // OR/XOR
+
 /* REGISTER INDICES */
 constexpr uint8_t R_B = 0;
 constexpr uint8_t R_C = 1;
@@ -54,6 +94,19 @@ constexpr uint8_t R_A = 7;
 
 constexpr uint8_t R_F = 6; // register index 6 will be for F register
 
+/* REGISTER PAIRS (same numbering as P in the opcode) */
+constexpr uint8_t RP_BC = 0;
+constexpr uint8_t RP_DE = 1;
+constexpr uint8_t RP_HL = 2;
+// AF is not a pair, A and F sit the other way round (index 6 is taken by (HL) in the opcode)
+
+// On little endian hosts the low register of each pair has to come first for the pair to be one uint16_t
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+constexpr uint8_t REG_BYTE_SWAP = 0;
+#else
+constexpr uint8_t REG_BYTE_SWAP = 1;
+#endif
+
 /* MEMORY MAP START VALUES */
 constexpr uint16_t ROM_00 = 0x0000;
 constexpr uint16_t ROM_NN = 0x4000;
@@ -62,33 +115,80 @@ constexpr uint16_t EXT_RAM = 0xA000;
 constexpr uint16_t WRAM_0 = 0xC000;
 constexpr uint16_t WRAM_N = 0xD000;
 constexpr uint16_t ECHO_RAM = 0xE000;
+constexpr uint16_t ECHO_OFFSET = 0x2000; // echo RAM is work RAM seen again this far up
 constexpr uint16_t SPRITE_TABLE = 0xFE00;
 constexpr uint16_t UNUSABLE_AREA = 0xFEA0;
 constexpr uint16_t IO_REGISTERS = 0xFF00;
 constexpr uint16_t HRAM_LOC = 0xFF80;
 constexpr uint16_t INTERRUPT_ENABLE = 0xFFFF;
 
-/* CARTRIDGE HEADER */
-constexpr uint16_t CART_TYPE = 0x147;
-constexpr uint16_t ROM_HEADER = 0x148;
-constexpr uint16_t RAM_HEADER = 0x149;
+/* IO REGISTERS */
+constexpr uint16_t JOYPAD_REG = 0xFF00;
+constexpr uint16_t SERIAL_DATA = 0xFF01;
+constexpr uint16_t SERIAL_CONTROL = 0xFF02;
+constexpr uint16_t DMA_REG = 0xFF46;
+constexpr uint16_t INTERRUPT_FLAG = 0xFF0F;
+constexpr uint16_t LYC_REG = 0xFF45;
+
+/* INTERRUPTS */
+constexpr uint8_t INT_VBLANK = 0;
+constexpr uint8_t INT_LCD = 1;
+constexpr uint8_t INT_TIMER = 2;
+constexpr uint8_t INT_JOYPAD = 4;
+constexpr uint8_t INTERRUPT_MASK = 0x1F;
+constexpr uint16_t INTERRUPT_VECTOR = 0x40;   // bit i jumps to 0x40 + 8*i
+
+/* OAM DMA */
+constexpr uint16_t DMA_LENGTH = 0xA0;  // bytes copied into OAM
+constexpr uint16_t DMA_CYCLES = 160;   // m-cycles before the copy is done and the bus is given back
+
+/* FUSED SEQUENCES */
+constexpr uint8_t FUSED_SEQUENCE_COUNT = 12;
+constexpr uint8_t LOOP_HINT_INDEX = FUSED_SEQUENCE_COUNT;   // loops from the per-ROM hint table, counted after the sequences
+constexpr uint16_t LOOP_BULK_MAX_CYCLES = 0x1000;           // most m-cycles of a loop done at once
+
+/* SAVE STATES */
+constexpr uint8_t SAVE_STATE_MAGIC[3] = {'G', 'B', 'M'};
+constexpr uint8_t SAVE_STATE_VERSION = 8;
+
+/*
+    The registers, as 8 bit registers by index (R_B..R_A, the order the opcodes use)
+    or as BC/DE/HL in one read or write.
+*/
+struct RegisterFile
+{
+    union
+    {
+        uint8_t r8[8];
+        uint16_t r16[4];
+    };
+
+    uint8_t& operator[](uint8_t index) { return r8[index ^ REG_BYTE_SWAP]; }
+    const uint8_t& operator[](uint8_t index) const { return r8[index ^ REG_BYTE_SWAP]; }
+    uint16_t& pair(uint8_t pairIndex) { return r16[pairIndex]; }
+};
 
-/* MBC CLASSIFICATIONS */
-constexpr uint8_t NO_MBC = 0;
-constexpr uint8_t MBC1 = 1;
-constexpr uint8_t MBC2 = 2;
-constexpr uint8_t MBC3 = 3;
-constexpr uint8_t MBC5 = 5;
+class CPU;
+
+// A block of ROM code translated ahead of time by tools/RomToCpp (see AotRuntime.hpp)
+using AotBlock = void (*)(CPU& cpu);
+struct AotEntry;
 
 class CPU
 {
+    // generated code reaches the registers and the interpreter through it
+    friend struct AotRuntime;
+    // and the checks in UnitTesting set them up and look at them
+    friend class CoreTest;
 
     /* VARIABLES */
     public:
 
         // CPU cycle tracker (m-cycles)
         uint16_t cycleCount;
-        int32_t totalCycleCount;
+
+        // t-cycles since power on, emulated time for anything that needs it (like the MBC3 clock), runUntil takes a timestamp on it
+        uint64_t cyclesSincePowerOn;
 
     
     private:
@@ -99,12 +199,20 @@ class CPU
         bool nextInstrExecuted; // used exclusively alongside prepareIME
         bool isHalted;
         uint8_t lastIReqs;
+        uint8_t mPendingInterrupts; // IE & IF, kept up to date whenever either changes
 
         // All CPU registers
-        uint8_t registers[8];
+        RegisterFile registers;
         uint16_t sp;
         uint16_t pc;
 
+        // Lazy flags, what the last ALU op worked on so F can be worked out only when it is read
+        bool mLazyFlags;
+        uint8_t mFlagOp;       // FLAG_OP_NONE when registers[R_F] is up to date
+        uint8_t mFlagOperand1; // the result for AND/OR/XOR
+        uint8_t mFlagOperand2;
+        bool mFlagCarry;       // carry in for ADC/SBC, the carry INC/DEC leave alone
+
         // For graphics related stuff
         PPU mPPU;
         Joypad mJoypad;
@@ -115,21 +223,58 @@ class CPU
         std::vector<uint8_t> memMap;
 
 
+        // Pages that can be read or written without going through the slow path, the mapper keeps ROM and RAM up to date
+        PageTable mPages;
+
+        // OAM DMA in progress, the CPU only sees the high page until it is done
+        uint16_t mDMACyclesLeft;
+        uint16_t mDMASource;
+        PageTable mDMASavedPages;
+
+        // Decoded blocks and the recompiler, work RAM pages that code was taken from lose their write page so writes can drop the code
+        BlockCache mBlockCache;
+        bool mBlockCacheEnabled;
+        const uint8_t* mOperands; // operands of the decoded op being run, nullptr when they are read from memory
+
+        // Accuracy policy, runUntil and runFrame go through the copy of the run loop built for it
+        void (CPU::*mRun)();
+        uint64_t mRunUntil;
+        bool mStopAtVBlank;
+        uint16_t mAccessCycles;   // memory accesses so far this instruction, the accurate core has moved everything on by one m-cycle for each
+        bool mHaltBug;            // the next opcode fetch doesn't move pc
+        uint32_t mPPUPendingCycles;   // m-cycles the fast core's PPU is behind by
+        uint16_t mPPUDeadline;        // how far behind it can get before it has to catch up
+        std::deque<InputEvent> mInputQueue;  // oldest timestamp first, belongs to the host so save states leave it out
+        uint64_t mNextInputEvent;             // timestamp of the first one, NO_INPUT_EVENT when there are none
+        std::array<bool, FUSED_SEQUENCE_COUNT + 1> mFusionEnabled;
+        std::array<uint64_t, FUSED_SEQUENCE_COUNT + 1> mFusionHits;
+        uint64_t mBulkIterations;  // loop iterations done as one copy instead of one instruction at a time
+        uint64_t mBulkCycles;
+        Jit mJit;
+        bool mJitEnabled;
+        uint64_t mRunHorizon;   // see updateRunHorizon
+        std::unordered_map<const uint8_t*, std::pair<const AotEntry*, bool>> mAotBlocks;  // by where each instruction is in ROM, and if a fused loop starts there
+        bool mAotEnabled;
+        bool mCodePages[PAGE_COUNT];          // work RAM pages writes can't go straight to, some of their chunks have code
+        bool mCodeChunks[CODE_CHUNK_COUNT];   // code was decoded or compiled from this chunk
+        uint8_t mChunkInvalidations[CODE_CHUNK_COUNT];
+        const uint8_t* mBlockPage; // page the running block was made from
+        bool mBlockDirty;          // the running block's page was written to
+
         // ROM and RAM Banks
-        std::vector<uint8_t> ROMBanks;
-        std::vector<uint8_t> RAMBanks;
-        std::vector<uint8_t> workRAMBanks;
-        
-        uint8_t curROMBank;
-        uint8_t curRAMBank;
-        uint8_t curworkRAMBank;
+        // ROM is shared with every other CPU running the same game
+        std::shared_ptr<const Cartridge> mCartridge;
+        std::unique_ptr<Mapper> mMapper;
 
-        uint8_t mbcType;
-        uint16_t maxROMBanks;
-        uint8_t maxRAMBanks;
+        // External RAM, every bank one after another, mapped from the .sav file when the cart has a battery
+        MappedFile mSaveFile;
+        std::vector<uint8_t> mExtRAMCopy;
+        uint8_t* mExtRAM;
+        uint32_t mExtRAMSize;
+        uint8_t* mSaveExtra; // the clock data after the RAM in the .sav, nullptr if there is none
 
-        bool enableRAM;
-        bool doingROMBanking;
+        std::vector<uint8_t> workRAMBanks;
+        uint8_t curworkRAMBank;
 
         // Opcode Decoding (In Octal)
         uint8_t opcode;
@@ -149,23 +294,148 @@ class CPU
 
         ~CPU();
 
-        // ROM loader
+        // ROM loader, the save goes next to the ROM unless savePath says where (empty keeps it in memory only)
         void loadROM(const std::string fileName);
-        // main execution loop
-        void runCPU();
-
-        // Memory Read and Write
-        uint8_t readMemory(uint16_t addr);
-        void writeMemory(uint16_t addr, uint8_t data);
+        void loadROM(const std::string fileName, const std::string& savePath);
+        // savePath is where battery backed RAM is kept, empty keeps it in memory only
+        void loadCartridge(std::shared_ptr<const Cartridge> cartridge, const std::string& savePath = "");
+        // force battery backed RAM out to disk (it is written back by the OS anyway, this just makes it certain)
+        void flushSaveRAM();
+        // Main execution loop: whole instructions until cyclesSincePowerOn reaches timestamp (it can go past by the rest
+        // of an instruction), so emulation can be interleaved with anything else at any granularity
+        void runUntil(uint64_t timestamp);
+        // up to the instruction that enters VBlank, so the picture is complete (a frame's time with the LCD off)
+        void runFrame();
+        // the fast core (the default) or the cycle accurate one, see Accuracy.hpp
+        void setAccuracy(AccuracyMode mode);
+
+        // Memory Read and Write, the accurate core's accesses also take their m-cycle
+        template<class Accuracy = FastAccuracy> uint8_t readMemory(uint16_t addr);
+        template<class Accuracy = FastAccuracy> void writeMemory(uint16_t addr, uint8_t data);
 
         uint8_t* getPPUArray();
+        void setRenderEnabled(bool enabled);
+        // false computes F on every ALU op (the original core), to check the lazy one against it
+        void setLazyFlags(bool enabled);
+        // false fetches and decodes every instruction as it runs (the original core), to check the block cache against it
+        void setBlockCacheEnabled(bool enabled);
+        // turn one of the fused sequences in CPUFusion.cpp on or off by name, and how often each one has run
+        bool setFusionEnabled(const std::string& name, bool enabled);
+        void printFusionStats(std::ostream& out);
+        // run the game's code that was translated to C++ ahead of time, when there is any for it (the default is on)
+        void setAotEnabled(bool enabled);
+        // run through the x86-64 recompiler where possible, false if it can't be used here (the default is off)
+        bool setJitEnabled(bool enabled);
 
         void handleJoypadInput(SDL_Scancode inputIndex, bool pressed);
+        // applies the key change when cyclesSincePowerOn reaches timestamp instead of right away (right away if it already has)
+        void queueInput(uint64_t timestamp, SDL_Scancode inputIndex, bool pressed);
+
+        // Save states, kept in memory (definitions in CPUState.cpp)
+        void saveState(std::vector<uint8_t>& buffer);
+        bool loadState(const std::vector<uint8_t>& buffer);
+        // for going back to the input there was before running ahead, which loadState leaves as it is
+        void saveInput(HostInput& input) const;
+        void loadInput(const HostInput& input);
 
 
     private:
-        void handleInterrupt();
+        // High page register handlers, indexed by the low byte of the address (definitions in CPUIO.cpp)
+        using IOReadHandler = uint8_t (CPU::*)(uint16_t addr);
+        using IOWriteHandler = void (CPU::*)(uint16_t addr, uint8_t data);
+        static const std::array<IOReadHandler, 256> ioReadHandlers;
+        static const std::array<IOWriteHandler, 256> ioWriteHandlers;
+        static std::array<IOReadHandler, 256> makeIOReadHandlers();
+        static std::array<IOWriteHandler, 256> makeIOWriteHandlers();
+
+        uint8_t readJoypad(uint16_t addr);
+        void writeJoypad(uint16_t addr, uint8_t data);
+        void writeSerialControl(uint16_t addr, uint8_t data);
+        void writeResetRegister(uint16_t addr, uint8_t data);
+        uint8_t readTimer(uint16_t addr);
+        void writeTimer(uint16_t addr, uint8_t data);
+        void writeDMA(uint16_t addr, uint8_t data);
+        void writeInterruptRegister(uint16_t addr, uint8_t data);
+
+        // One interpreter step is beginInstruction, executeInstruction, endInstruction (definitions in CPUEmu.cpp)
+        template<class Accuracy> void run();
+        void beginInstruction();
+        template<class Accuracy = FastAccuracy> void executeInstruction();
+        template<class Accuracy = FastAccuracy> void endInstruction();
+        template<class Accuracy> void stepComponents(uint16_t mCycles);
+        void timeAccess();
+        void syncPPU();
+        // one instruction from bytes already fetched, returns its length
+        uint8_t executeBytes(const uint8_t* bytes);
+
+        // Decoded and recompiled blocks
+        const uint8_t* getCodePage();
+        bool continueBlock(uint32_t nextPC);
+        bool runDecodedBlock();
+        std::shared_ptr<const DecodedBlock> decodeBlock(const uint8_t* page);
+
+        // Fused sequences (definitions in CPUFusion.cpp)
+        using FusedHandler = bool (CPU::*)(const DecodedOp& op);
+        struct FusedSequence
+        {
+            const char* name;
+            uint8_t length;
+            uint8_t pattern[FUSED_MAX_BYTES];
+            uint8_t mask[FUSED_MAX_BYTES];
+            FusedHandler handler;
+            LoopShape loop;
+        };
+        static const std::array<FusedSequence, FUSED_SEQUENCE_COUNT> fusedSequences;
+
+        // Loops in particular games that the patterns don't catch, bank and address are where the loop starts
+        struct LoopHint
+        {
+            uint32_t romHash;   // Cartridge::getROMHash
+            uint16_t bank;
+            uint16_t address;
+            uint8_t length;     // the loop ends with a JR NZ back to its start
+            uint8_t code[FUSED_MAX_BYTES];  // the loop itself, the checksums alone could match some other game
+            LoopShape loop;
+        };
+        static const std::vector<LoopHint> loopHints;
+        std::vector<std::pair<const uint8_t*, const LoopHint*>> mLoopHints; // hints for the loaded game, by where the loop is in ROM
+        void findLoopHints();
+
+        bool matchFusedSequence(const uint8_t* code, uint16_t bytesLeft, DecodedOp& op);
+        bool hasFusedSequence(const uint8_t* code, uint16_t bytesLeft, uint16_t length);
+        bool endFusedInstruction();
+        bool runFusedBytes(const DecodedOp& op);
+        bool fusedLoop(const DecodedOp& op);
+        void runLoopInBulk(const LoopShape& loop);
+        bool fusedCopy(const DecodedOp& op);
+        bool fusedCopyCount(const DecodedOp& op);
+        bool fusedLoopBC(const DecodedOp& op);
+        bool fusedPoll(const DecodedOp& op);
+        bool fusedCountDown(const DecodedOp& op);
+        void fusedJumpRelative(uint8_t jumpOpcode, int8_t offset);
+        bool runJitBlock();
+        bool runAotBlock();
+        void findAotProgram();
+        void flushBlocks();
+        void protectCode(uint16_t addr, uint16_t length);
+        bool isCodeUncached(uint16_t addr) const;
+        void releaseCodeChunk(uint16_t addr);
+        void releaseCodePage(uint8_t pageIndex);
+        void updateRunHorizon();
+        static bool jitEndInstruction(CPU* cpu, uint32_t nextPC);
+        static bool jitInterpret(CPU* cpu, uint32_t opcode, uint32_t nextPC);
+        static const uint8_t* jitSlowPath(CPU* cpu, const JitStep* steps, uint32_t index);
+
+        template<class Accuracy = FastAccuracy> void handleInterrupt();
+        void requestInterrupt(uint8_t bit);
+        void takeInterruptRequests();
+        void applyInputEvents();
+        void updatePendingInterrupts();
         void DMATransfer(uint8_t data);
+        void tickDMA(uint16_t mCycles);
+        void finishDMA();
+        void blockPagesForDMA();
+        bool pagesBlockedForDMA() const;
         void debugLog(std::ostream& logFile);
 
         // Timer operations, we want these to bypass our R/W functions
@@ -176,71 +446,85 @@ class CPU
         uint8_t readTAC(bool clockSelect);
         
         // Banking functions
-        void getBankMode(const uint8_t type);
-        void getROMSize(const uint8_t type);
-        void getRAMSize(const uint8_t type);
-        void generateBanks();
+        void generateBanks(const std::string& savePath);
+        void mapWorkRAM();
 
-        void doBanking(const uint16_t addr, const uint8_t data);
 
         // LCD Functions
 
         /* BEGIN: Definitions in Opcode.cpp */
         // Opcode Decode and Execution
+        // op functions that touch memory are templates on the accuracy policy, every caller outside the accurate core uses the fast one
         void decode();
-        void executeOp();
+        template<class Accuracy = FastAccuracy> void executeOp();
+        template<class Accuracy = FastAccuracy> uint8_t fetchOperand();
+
+        // The op function for the decoded opcode
+        using OpHandler = void (CPU::*)();
+        template<class Accuracy = FastAccuracy> OpHandler selectOp();
+        template<class Accuracy = FastAccuracy> OpHandler selectPrefixedOp();
 
         // Sub functions to decode opcodes that have many cases
-        void x0z0Decode();
-        void x0z2Decode();
-        void x0z7Decode();
-        void x3z0Decode();
-        void x3z1Decode();
-        void x3z2Decode();
+        template<class Accuracy> OpHandler x0z0Decode();
+        template<class Accuracy> OpHandler x0z2Decode();
+        template<class Accuracy> OpHandler x0z7Decode();
+        template<class Accuracy> OpHandler x3z0Decode();
+        template<class Accuracy> OpHandler x3z1Decode();
+        template<class Accuracy> OpHandler x3z2Decode();
 
         /* OPCODES (format opXXYYYZZZ) */
         // Opcode helpers
         bool passedCondition(uint8_t condition);
+        // set the flags for an ALU op, or only record it when flags are lazy
+        void add8Bit(uint8_t operand1, uint8_t operand2, bool carry);
+        void sub8Bit(uint8_t minuend, uint8_t subtrahend, bool carry);
+        void inc8Bit(uint8_t data); // carry is kept
+        void dec8Bit(uint8_t data); // carry is kept
+        void logic8Bit(uint8_t result, bool halfCarry);
+        // anything that reads F or only changes some of it has to materialize first
+        void materializeFlags();
+        bool zeroFlag();
+        bool carryFlag();
 
         // XX = 0 (00)
             // ZZZ = 0
                 // YYY = 0
                 void opNOP();
                 // YYY = 1
-                void opLDnnSP();
+                template<class Accuracy> void opLDnnSP();
                 // YYY = 2
-                void opSTOP();
+                template<class Accuracy> void opSTOP();
                 // YYY = 3
-                void opJRd();
+                template<class Accuracy> void opJRd();
                 // YYY = 4-7
-                void opJRccd();
+                template<class Accuracy> void opJRccd();
             // ZZZ = 1
                 // Q = 0
-                void opLDrpnn();
+                template<class Accuracy> void opLDrpnn();
                 // Q = 1
                 void opADDHLrp();
             // ZZZ = 2
                 // Q = 0
                     // P = 0-1
-                    void opLDrrA();
+                    template<class Accuracy> void opLDrrA();
                     
                     // P = 2-3
-                    void opLDHLIDA();
+                    template<class Accuracy> void opLDHLIDA();
                     
                 // Q = 1
                     // P = 0-1
-                    void opLDArr();
+                    template<class Accuracy> void opLDArr();
                     
                     // P = 2
-                    void opLDAHLID();
+                    template<class Accuracy> void opLDAHLID();
 
             // ZZZ = 3
                 // Q = 0-1
                 void opINCDECrp();
             // ZZZ = 4-5
-                void opINCDECr();
+                template<class Accuracy> void opINCDECr();
             // ZZZ = 6
-                void opLDrn();
+                template<class Accuracy> void opLDrn();
             // ZZZ = 7
                 // YYY = 0
                     void opRLCA();
@@ -261,64 +545,64 @@ class CPU
         
         // XX = 1 (01)
             // ZZZ = 6 AND YYY = 6
-            void opHALT();
+            template<class Accuracy> void opHALT();
             // ELSE
-            void opLDrr();
+            template<class Accuracy> void opLDrr();
         
         // XX = 2 (10) (ALU using register)
             // YYY = 0-1
-            void opADDAr();
+            template<class Accuracy> void opADDAr();
             // YYY = 2-3
-            void opSUBAr();
-            void opSBCAr();
+            template<class Accuracy> void opSUBAr();
+            template<class Accuracy> void opSBCAr();
             // YYY = 4
-            void opANDAr();
+            template<class Accuracy> void opANDAr();
             // YYY = 5
-            void opXORAr();
+            template<class Accuracy> void opXORAr();
             // YYY = 6
-            void opORAr();
+            template<class Accuracy> void opORAr();
             // YYY = 7
-            void opCPAr();
+            template<class Accuracy> void opCPAr();
 
        
         // XX = 3 (11)
             // ZZZ = 0
                 // YYY = 0-3
-                void opRETcc();
+                template<class Accuracy> void opRETcc();
                 // YYY = 4
-                void opLDHnA();
+                template<class Accuracy> void opLDHnA();
                 // YYY = 5
-                void opADDSPd();
+                template<class Accuracy> void opADDSPd();
                 // YYY = 6
-                void opLDHAn();
+                template<class Accuracy> void opLDHAn();
                 // YYY = 7
-                void opLDHLSPId();
+                template<class Accuracy> void opLDHLSPId();
             // ZZZ = 1
                 // Q = 0
-                    void opPOPrp2();
+                    template<class Accuracy> void opPOPrp2();
                 // Q = 1
                     // P = 0
-                    void opRET();
+                    template<class Accuracy> void opRET();
                     // P = 1
-                    void opRETI();
+                    template<class Accuracy> void opRETI();
                     // P = 2
                     void opJPHL();
                     // P = 3
                     void opLDSPHL();
             // ZZZ = 2
                 // YYY = 0-3
-                void opJPccnn();
+                template<class Accuracy> void opJPccnn();
                 // YYY = 4
-                void opLDHCA();
+                template<class Accuracy> void opLDHCA();
                 // YYY = 5
-                void opLDnnA();
+                template<class Accuracy> void opLDnnA();
                 // YYY = 6
-                void opLDHAC();
+                template<class Accuracy> void opLDHAC();
                 // YYY = 7
-                void opLDAnn();
+                template<class Accuracy> void opLDAnn();
             // ZZZ = 3
                 // YYY = 0
-                void opJPnn();
+                template<class Accuracy> void opJPnn();
                 // YYY = 1 (NONE; goes to CB prefix)
                 // YYY = 2 (NONE)
                 // YYY = 3 (NONE)
@@ -330,35 +614,35 @@ class CPU
                 void opEI();
             // ZZZ = 4
                 // YYY = 0-3
-                void opCALLccnn();
+                template<class Accuracy> void opCALLccnn();
                 // YYY = 4-7 (NONE)
             // ZZZ = 5
                 // Q = 0
-                    void opPUSHrp2();
+                    template<class Accuracy> void opPUSHrp2();
                 // Q = 1
                     // P = 0
-                    void opCALLnn();
+                    template<class Accuracy> void opCALLnn();
                     // P = 1-3 (NONE)
             // ZZZ = 6
                 // YYY = 0-1
-                void opADDAn();
+                template<class Accuracy> void opADDAn();
                 // YYY = 2-3
-                void opSUBAn();
-                void opSBCAn();
+                template<class Accuracy> void opSUBAn();
+                template<class Accuracy> void opSBCAn();
                 // YYY = 4
-                void opANDAn();
+                template<class Accuracy> void opANDAn();
                 // YYY = 5
-                void opXORAn();
+                template<class Accuracy> void opXORAn();
                 // YYY = 6
-                void opORAn();
+                template<class Accuracy> void opORAn();
                 // YYY = 7
-                void opCPAn();
+                template<class Accuracy> void opCPAn();
             // ZZZ = 7
-                void opRST();
+                template<class Accuracy> void opRST();
         
         // CB Prefix Opcodes
             // XX = 0 (00)
-            void opROT(); // master function for rotational CB opcodes
+            template<class Accuracy> void opROT(); // master function for rotational CB opcodes
                 /// YYY = 0
                 uint8_t opRLCr(uint8_t data);
 
@@ -384,13 +668,13 @@ class CPU
                 uint8_t opSRLr(uint8_t data);
             
             // XX = 1 (01)
-            void opBIT();
+            template<class Accuracy> void opBIT();
             
             // XX = 2 (10)
-            void opRES();
+            template<class Accuracy> void opRES();
             
             // XX = 3 (11)
-            void opSET();
+            template<class Accuracy> void opSET();
         /* END of definitions in Opcode.cpp */
 
 
@@ -0,0 +1,82 @@
+#include "AotRuntime.hpp"
+
+// generated files register from static initializers in any order, so the list is made on first use
+static std::vector<AotProgram>& aotPrograms()
+{
+    static std::vector<AotProgram> programs;
+    return programs;
+}
+
+bool AotRuntime::registerProgram(const AotProgram& program)
+{
+    aotPrograms().push_back(program);
+    return true;
+}
+
+const AotProgram* AotRuntime::findProgram(uint32_t romHash, uint16_t romBanks)
+{
+    for(const AotProgram& program : aotPrograms())
+    {
+        if((program.romHash == romHash) && (program.romBanks == romBanks))
+        {
+            return &program;
+        }
+    }
+    return nullptr;
+}
+
+void CPU::setAotEnabled(bool enabled)
+{
+    mAotEnabled = enabled;
+}
+
+void CPU::findAotProgram()
+{
+    mAotBlocks.clear();
+    const AotProgram* program{AotRuntime::findProgram(mCartridge->getROMHash(), mCartridge->getROMBankCount())};
+    if(program == nullptr)
+    {
+        return;
+    }
+
+    for(uint32_t i{0}; i < program->entryCount; i++)
+    {
+        const AotEntry& entry{program->entries[i]};
+        const uint8_t* code{mCartridge->getROM() + (entry.bank * ROM_BANK_SIZE) + (entry.pc % ROM_BANK_SIZE)};
+        DecodedOp loop{};
+        bool fusedLoop{matchFusedSequence(code, PAGE_SIZE - (entry.pc & PAGE_MASK), loop) && (loop.loop != nullptr)};
+        mAotBlocks[code] = {&entry, fusedLoop};
+    }
+}
+
+bool CPU::runAotBlock()
+{
+    if(!mAotEnabled || mAotBlocks.empty() || (pc >= VRAM))
+    {
+        return false;
+    }
+    const uint8_t* page{getCodePage()};
+    if(page == nullptr)
+    {
+        return false;
+    }
+
+    // the same ROM bytes can be mapped somewhere the generator did not expect them (MBC1 multicarts)
+    auto entry{mAotBlocks.find(page + (pc & PAGE_MASK))};
+    if((entry == mAotBlocks.end()) || (entry->second.first->pc != pc))
+    {
+        return false;
+    }
+
+    // loops the decoded blocks run in bulk are left to them, generated code runs them an iteration at a time
+    if(entry->second.second && mBlockCacheEnabled)
+    {
+        return false;
+    }
+
+    updateRunHorizon();
+    mBlockPage = page;
+    mBlockDirty = false;
+    entry->second.first->block(*this);
+    return true;
+}
\ No newline at end of file
@@ -1,520 +1,898 @@
 #include "CPU.hpp"
 #include <sstream>
+#include <algorithm>
 
-/* 
-    Try to emulate 59.7 Hz refresh rate (to be hardware accurate)
-    Some Math: 4194304 Hz / 59.7 Hz is around 70256 cycles per frame (rounded) 
-    Since we counted using m-cycles, which is approximately a quarter of a cycle, we should multiply by 4 (t cycles)
-*/
-constexpr int32_t CYCLES_PER_FRAME = 70256; 
-constexpr bool DEBUG = true;
+constexpr bool DEBUG = false;
 
 std::ofstream logFile("GBMoo.log");
-void CPU::runCPU()
+void CPU::runUntil(uint64_t timestamp)
 {
-    
-    while(totalCycleCount < CYCLES_PER_FRAME)
+    mStopAtVBlank = false;
+    mRunUntil = timestamp;
+    (this->*mRun)();
+}
+
+void CPU::runFrame()
+{
+    mStopAtVBlank = true;
+    mRunUntil = cyclesSincePowerOn + CYCLES_PER_FRAME;
+    if(Helper::getBit(memMap[LCDC], 7))
+    {
+        mRunUntil += SCANLINE_TIME;
+    }
+    (this->*mRun)();
+    mStopAtVBlank = false;
+}
+
+/* Whole instructions until mRunUntil, with the accuracy policy picked by setAccuracy, each policy is its own copy of the loop */
+template<class Accuracy>
+void CPU::run()
+{
+    while(cyclesSincePowerOn < mRunUntil)
     {   
-        if(DEBUG)
+        beginInstruction();
+
+        if constexpr(Accuracy::TIMED_ACCESSES)
         {
-            debugLog(logFile);
+            // blocks and compiled code only stop between whole instructions, so everything goes through the interpreter
+            executeInstruction<Accuracy>();
+            endInstruction<Accuracy>();
         }
 
-        if(prepareIME)
+        // a precompiled, compiled or decoded block runs one or more whole instructions itself
+        // compiled code leaves blocks with fused sequences to the decoded ones (see runJitBlock)
+        else if(!runAotBlock() && !runJitBlock() && !runDecodedBlock())
         {
-            nextInstrExecuted = 1;
+            executeInstruction();
+            endInstruction();
         }
-        if(!isHalted)
-        {
-            opcode = readMemory(pc);
-            pc++;
-            decode();
-            executeOp();
+    }
+
+    // the last lines are drawn and the PPU is where a save state expects it
+    if constexpr(Accuracy::LAZY_PPU)
+    {
+        syncPPU();
+    }
+}
+
+void CPU::setAccuracy(AccuracyMode mode)
+{
+    switch(mode)
+    {
+        case AccuracyMode::Fast:
+            mRun = &CPU::run<FastAccuracy>;
+            break;
+        case AccuracyMode::Cycle:
+            mRun = &CPU::run<CycleAccuracy>;
+            break;
+    }
+    mHaltBug = false;
+    mAccessCycles = (mode == AccuracyMode::Fast) ? 1 : 0;
+
+    // whatever the fast core's PPU was behind by is caught up with it, and it checks its registers again next time
+    syncPPU();
+    mPPUDeadline = 0;
+
+    // the accurate core never runs blocks, so their work RAM pages can be written straight again
+    flushBlocks();
+}
 
+void CPU::beginInstruction()
+{
+    if(DEBUG)
+    {
+        debugLog(logFile);
+    }
+
+    if(prepareIME)
+    {
+        nextInstrExecuted = 1;
+    }
+}
+
+template<class Accuracy>
+void CPU::executeInstruction()
+{
+    if(!isHalted)
+    {
+        // the fetch counts itself here, endInstruction counted it for the paths that have the opcode in hand already
+        if constexpr(!Accuracy::TIMED_ACCESSES)
+        {
+            mAccessCycles = 0;
         }
-        else
+        opcode = readMemory<Accuracy>(pc);
+
+        // the halt bug, pc doesn't move past the byte after HALT so it is read again
+        if constexpr(Accuracy::HALT_BUG)
         {
-            opNOP();
+            if(mHaltBug)
+            {
+                mHaltBug = false;
+                pc--;
+            }
         }
+        pc++;
+        decode();
+        executeOp<Accuracy>();
 
-        if(nextInstrExecuted && prepareIME)
+    }
+    else
+    {
+        opNOP();
+    }
+}
+
+uint8_t CPU::executeBytes(const uint8_t* bytes)
+{
+    // like executeInstruction, but the instruction is already in hand instead of in memory
+    opcode = bytes[0];
+    pc++;
+    mOperands = bytes + 1;
+    if(opcode == 0xCB)
+    {
+        opcode = fetchOperand();
+        decode();
+        (this->*selectPrefixedOp())();
+    }
+    else
+    {
+        decode();
+        OpHandler handler{selectOp()};
+        if(handler != nullptr)
         {
-            IMEflag = 1;
-            prepareIME = 0;
-            nextInstrExecuted = 0;
+            (this->*handler)();
         }
+    }
+    mOperands = nullptr;
+    return BlockCache::getLength(bytes[0]);
+}
+
+template<class Accuracy>
+void CPU::endInstruction()
+{
+    if(nextInstrExecuted && prepareIME)
+    {
+        IMEflag = 1;
+        prepareIME = 0;
+        nextInstrExecuted = 0;
+    }
 
-        mPPU.PPUCycle(cycleCount, memMap);
-        mTimerControl.tickTimer(cycleCount, memMap);
-        totalCycleCount += cycleCount * 4;
-        handleInterrupt();
-        cycleCount = 0;
-        
+    // with timed accesses everything has already caught up to the last access, only the m-cycles after it are left
+    if constexpr(Accuracy::TIMED_ACCESSES)
+    {
+        cycleCount = (cycleCount > mAccessCycles) ? cycleCount - mAccessCycles : 0;
     }
 
-    totalCycleCount -= CYCLES_PER_FRAME;
+    stepComponents<Accuracy>(cycleCount);
+    handleInterrupt<Accuracy>();
+    cycleCount = 0;
+
+    // the fast core only counts accesses to place LCD writes in the line, the next opcode fetch is the first
+    mAccessCycles = Accuracy::TIMED_ACCESSES ? 0 : 1;
 }
 
-void CPU::handleInterrupt()
+/* Everything that runs alongside the CPU, moved on by some m-cycles */
+template<class Accuracy>
+void CPU::stepComponents(uint16_t mCycles)
 {
-    if(mPPU.reqLCDInterrupt)
+    if(mDMACyclesLeft != 0)
     {
-        isHalted = false;
-        mPPU.reqLCDInterrupt = false;
-        Helper::setBit(memMap[0xFF0F], 1);
+        tickDMA(mCycles);
+    }
 
+    if constexpr(Accuracy::LAZY_PPU)
+    {
+        mPPUPendingCycles += mCycles;
+        if(mPPUPendingCycles >= mPPUDeadline)
+        {
+            syncPPU();
+        }
     }
-    if(mPPU.reqVBInterrupt)
+    else
     {
-        isHalted = false;
-        mPPU.reqVBInterrupt = false;
-        Helper::setBit(memMap[0xFF0F], 0);
+        mPPU.PPUCycle<Accuracy>(mCycles, memMap);
+        takeInterruptRequests();
     }
-    if(mTimerControl.reqInterrupt)
+    cyclesSincePowerOn += mCycles * 4;
+
+    // the timers only need anything done when TIMA overflows
+    if(cyclesSincePowerOn >= mTimerControl.getNextEvent())
     {
-        isHalted = false;
-        mTimerControl.reqInterrupt = false;
-        Helper::setBit(memMap[0xFF0F], 2);
+        mTimerControl.catchUp(cyclesSincePowerOn, memMap);
+        takeInterruptRequests();
     }
-    if(mJoypad.reqInterrupt)
+
+    // and queued input on the cycle it was stamped with
+    if(cyclesSincePowerOn >= mNextInputEvent)
     {
-        isHalted = false;
-        mTimerControl.reqInterrupt = false;
-        Helper::setBit(memMap[0xFF0F], 4);
+        applyInputEvents();
     }
-    if(IMEflag)
-    {   
-        isHalted = false;
-        for(uint8_t i{0}; i < 5; i++)
-        {
-            uint8_t interruptEnable{Helper::getBit(memMap[0xFFFF], i)};
-            uint8_t interruptReq{Helper::getBit(memMap[0xFF0F], i)};
-            if((interruptEnable & interruptReq) > 0)
-            {
-                isHalted = false;
-                Helper::resetBit(memMap[0xFF0F], i);
-                IMEflag = false;
-                sp--;
-                uint8_t loPC{Helper::loBits(pc)};
-                uint8_t hiPC{Helper::hiBits(pc)};
-                writeMemory(sp, hiPC);
-                sp--;
-                writeMemory(sp, loPC);
-
-                switch(i)
-                {
-                    case 0:
-                        pc = 0x40;
-                        break;
-                    case 1:
-                        pc = 0x48;
-                        break;
-                    case 2:
-                        pc = 0x50;
-                        break;
-                    case 3:
-                        pc = 0x58;
-                        break;
-                    case 4:
-                        pc = 0x60;
-                        break;
-                }
-                
-            }
-        }
+}
+
+/* The fast core's PPU is stepped here, when the CPU touches VRAM, OAM, the LCD registers or IF/IE, or when its next mode change is due */
+void CPU::syncPPU()
+{
+    if(mPPUPendingCycles != 0)
+    {
+        mPPU.PPUCycle(mPPUPendingCycles, memMap);
+        mPPUPendingCycles = 0;
+        takeInterruptRequests();
     }
+    mPPUDeadline = mPPU.getCatchUpDeadline(memMap);
 }
 
-void CPU::handleJoypadInput(SDL_Scancode inputIndex, bool pressed)
+/* A memory access in the accurate core takes its m-cycle before it happens */
+void CPU::timeAccess()
 {
-    uint8_t i{0};
-    bool dPad{false};
-    switch(inputIndex)
+    stepComponents<CycleAccuracy>(1);
+    mAccessCycles++;
+}
+
+// blocks, fused ops, the JIT and AOT code end their instructions through the fast one
+template void CPU::endInstruction<FastAccuracy>();
+// and the JSON opcode tests run single instructions through it
+template void CPU::executeInstruction<FastAccuracy>();
+
+void CPU::setBlockCacheEnabled(bool enabled)
+{
+    mBlockCacheEnabled = enabled;
+    if(!enabled)
     {
-        case SDL_SCANCODE_D:
-            dPad = true;
-            i = 0;
-            break;
-        case SDL_SCANCODE_A:
-            dPad = true;
-            i = 1;
-            break;
-        case SDL_SCANCODE_W:
-            dPad = true;
-            i = 2;
-            break;
-        case SDL_SCANCODE_S:
-            dPad = true;
-            i = 3;
-            break;
-        case SDL_SCANCODE_G:
-            i = 0;
-            break;
-        case SDL_SCANCODE_F:
-            i = 1;
-            break;
-        case SDL_SCANCODE_SPACE:
-            i = 2;
-            break;
-        case SDL_SCANCODE_RETURN:
-            i = 3;
-            break;
-        default:
-            break;
+        flushBlocks();
     }
-    if (pressed)
+}
+
+bool CPU::setJitEnabled(bool enabled)
+{
+    if(!enabled)
     {
-        mJoypad.setJoypadState(dPad, i, memMap);
+        mJitEnabled = false;
+        flushBlocks();
+        return true;
     }
-    else
+
+    // compiled code finds everything relative to the CPU it is given
+    uint8_t* base{reinterpret_cast<uint8_t*>(this)};
+    JitLayout layout;
+    layout.endInstruction = &CPU::jitEndInstruction;
+    layout.interpret = &CPU::jitInterpret;
+    layout.slowPath = &CPU::jitSlowPath;
+    layout.registers = reinterpret_cast<uint8_t*>(registers.r8) - base;
+    layout.registerSwap = REG_BYTE_SWAP;
+    layout.sp = reinterpret_cast<uint8_t*>(&sp) - base;
+    layout.pc = reinterpret_cast<uint8_t*>(&pc) - base;
+    layout.cycleCount = reinterpret_cast<uint8_t*>(&cycleCount) - base;
+    layout.cyclesSincePowerOn = reinterpret_cast<uint8_t*>(&cyclesSincePowerOn) - base;
+    layout.ppuPendingCycles = reinterpret_cast<uint8_t*>(&mPPUPendingCycles) - base;
+    layout.horizon = reinterpret_cast<uint8_t*>(&mRunHorizon) - base;
+    layout.readPages = reinterpret_cast<uint8_t*>(mPages.read) - base;
+    layout.writePages = reinterpret_cast<uint8_t*>(mPages.write) - base;
+
+    mJitEnabled = mJit.init(layout);
+    if(!mJitEnabled)
     {
-        mJoypad.resetJoypadState(dPad, i);
+        std::cout << "JIT is not available, interpreting" << std::endl;
     }
+    return mJitEnabled;
+}
 
+const uint8_t* CPU::getCodePage()
+{
+    // blocks start where the interpreter would fetch normally, the EI delay and DMA are left to it
+    if(isHalted || prepareIME || (mDMACyclesLeft != 0))
+    {
+        return nullptr;
+    }
+
+    // only ROM and work RAM, VRAM and cart RAM are not paged like code and HRAM has no page
+    if((pc >= VRAM) && (pc < WRAM_0))
+    {
+        return nullptr;
+    }
+    return mPages.read[pc >> PAGE_SHIFT];
 }
 
-void CPU::executeOp()
+bool CPU::continueBlock(uint32_t nextPC)
 {
-    // do CB prefix instead
-    if(opcode == 0xCB)
+    // branches, interrupts, HALT, a bank switch under the block, code written, or the run is done
+    if((pc != nextPC) || isHalted || prepareIME || (mDMACyclesLeft != 0) || mBlockDirty ||
+       (cyclesSincePowerOn >= mRunUntil) || (mPages.read[nextPC >> PAGE_SHIFT] != mBlockPage))
     {
-        opcode = readMemory(pc);
-        pc++;
-        decode();
-        switch(XX)
+        return false;
+    }
+
+    beginInstruction();
+    return true;
+}
+
+bool CPU::runDecodedBlock()
+{
+    if(!mBlockCacheEnabled)
+    {
+        return false;
+    }
+    const uint8_t* page{getCodePage()};
+    if(page == nullptr)
+    {
+        return false;
+    }
+
+    // work RAM code that keeps being written over is interpreted, it would only be decoded again
+    bool workRAM{pc >= WRAM_0};
+    if(workRAM && isCodeUncached(pc))
+    {
+        return false;
+    }
+
+    const uint8_t* code{page + (pc & PAGE_MASK)};
+    std::shared_ptr<const DecodedBlock> block{mBlockCache.find(code)};
+    if(block == nullptr)
+    {
+        block = decodeBlock(page);
+        if(block == nullptr)
         {
-            case 0:
-                opROT();
-                break;
-            case 1:
-                opBIT();
-                break;
-            case 2:
-                opRES();
-                break;
-            case 3:
-                opSET();
-                break;
+            return false;
         }
 
-        return;
+        uint16_t length{0};
+        for(const DecodedOp& op : *block)
+        {
+            length += op.length;
+        }
+        mBlockCache.insert(code, page, length, block);
+        if(workRAM)
+        {
+            protectCode(pc, length);
+        }
     }
 
-    if(XX == 0)
+    // the block is held here so it outlives a write that drops it from the cache
+    mBlockPage = page;
+    mBlockDirty = false;
+    for(const DecodedOp& op : *block)
     {
-        switch(ZZZ)
+        uint32_t nextPC{pc + op.length};
+        if(op.fused != nullptr)
         {
-            case 0:
-                x0z0Decode();
-                break;
-            case 1:
-                switch(Q)
-                {
-                    case 0:
-                        opLDrpnn();
-                        break;
-                    case 1:
-                        opADDHLrp();
-                        break;
-                }
-                break;
-            case 2:
-                x0z2Decode();
-                break;
-            case 3:
-                opINCDECrp();
-                break;
-            case 4:
-            case 5:
-                opINCDECr();
-                break;
-            case 6:
-                opLDrn();
-                break;
-            case 7:
-                x0z7Decode();
+            mFusionHits[op.fusedIndex]++;
+            if(!(this->*op.fused)(op))
+            {
                 break;
+            }
         }
+        else
+        {
+            opcode = op.opcode;
+            XX = op.XX;
+            YYY = op.YYY;
+            ZZZ = op.ZZZ;
+            P = op.P;
+            Q = op.Q;
+
+            pc += op.opcodeLength;
+            mAccessCycles = op.opcodeLength;
+            mOperands = op.operands;
+            if(op.handler != nullptr)
+            {
+                (this->*op.handler)();
+            }
+            mOperands = nullptr;
+        }
+        endInstruction();
+
+        if((&op == &block->back()) || !continueBlock(nextPC))
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<const DecodedBlock> CPU::decodeBlock(const uint8_t* page)
+{
+    // same block boundaries as the recompiler, the last instruction has to fit in the page
+    uint16_t offset{pc & PAGE_MASK};
+    if(offset + BlockCache::getLength(page[offset]) > PAGE_SIZE)
+    {
+        return nullptr;
     }
-    else if(XX == 1)
+
+    std::shared_ptr<DecodedBlock> block{std::make_shared<DecodedBlock>()};
+    bool lastInstruction{false};
+    while(!lastInstruction)
     {
-        if(ZZZ == 6 && YYY == 6)
+        DecodedOp op{};
+        op.fusedIndex = NOT_FUSED;
+        bool endsBlock{false};
+        if(matchFusedSequence(page + offset, PAGE_SIZE - offset, op))
         {
-            opHALT();
+            // only the last instruction of a sequence can end the block
+            for(uint8_t i{0}; i < op.length; i += BlockCache::getLength(page[offset + i]))
+            {
+                endsBlock = BlockCache::endsBlock(page[offset + i]);
+            }
         }
         else
         {
-            opLDrr();
-        } 
-        
+            op.length = BlockCache::getLength(page[offset]);
+            op.opcodeLength = 1;
+            opcode = page[offset];
+            if(opcode == 0xCB)
+            {
+                op.opcodeLength = 2;
+                opcode = page[offset + 1];
+            }
+            for(uint8_t i{op.opcodeLength}; i < op.length; i++)
+            {
+                op.operands[i - 1] = page[offset + i];
+            }
+
+            decode();
+            op.handler = (op.opcodeLength == 2) ? selectPrefixedOp() : selectOp();
+            op.opcode = opcode;
+            op.XX = XX;
+            op.YYY = YYY;
+            op.ZZZ = ZZZ;
+            op.P = P;
+            op.Q = Q;
+            endsBlock = BlockCache::endsBlock(page[offset]);
+        }
+
+        uint16_t nextOffset{offset + op.length};
+        lastInstruction = endsBlock || (block->size() + 1 == BLOCK_MAX_INSTRUCTIONS) ||
+                          (nextOffset >= PAGE_SIZE) || (nextOffset + BlockCache::getLength(page[nextOffset]) > PAGE_SIZE);
+        block->push_back(op);
+        offset = nextOffset;
+    }
+    return block;
+}
+
+void CPU::runLoopInBulk(const LoopShape& loop)
+{
+    // the instruction log needs every instruction, and the bus is not the CPU's during DMA
+    if(DEBUG || (mDMACyclesLeft != 0))
+    {
+        return;
+    }
+    syncPPU();
+
+    // nothing may be able to interrupt the loop, the interrupt would have to be taken at the right instruction
+    bool lycMatch{Helper::getBit(memMap[LCD_STATUS], 6) && (memMap[SCANLINE_REGISTER] == memMap[LYC_REG])};
+    uint8_t requests{memMap[INTERRUPT_FLAG] | (lycMatch ? 0b10 : 0)};
+    if(IMEflag && ((memMap[INTERRUPT_ENABLE] & requests & INTERRUPT_MASK) != 0))
+    {
+        return;
+    }
+
+    // the last iteration is always left to run normally, so the loop ends the way it always does
+    uint32_t remaining{0};
+    if(loop.counter == LOOP_COUNTER_BC)
+    {
+        remaining = (registers.pair(RP_BC) == 0) ? 0x10000 : registers.pair(RP_BC);
+    }
+    else
+    {
+        remaining = (registers[loop.counter] == 0) ? 0x100 : registers[loop.counter];
+    }
+
+    // only as long as the PPU and timers do nothing but count, so one tick for all of it does exactly the same,
+    // and the run has to go on after it
+    uint64_t stopAt{std::min(mRunUntil, mNextInputEvent)};
+    uint64_t runLeft{(stopAt > cyclesSincePowerOn) ? (stopAt - cyclesSincePowerOn - 1) / 4 : 0};
+    uint32_t cycles{std::min<uint32_t>({mPPU.getCyclesUntilModeChange(memMap), mTimerControl.getCyclesUntilOverflow(cyclesSincePowerOn),
+                                        static_cast<uint32_t>(std::min<uint64_t>(runLeft, LOOP_BULK_MAX_CYCLES))})};
+    uint32_t iterations{std::min(remaining - 1, cycles / loop.cycles)};
+
+    // plain memory only (VRAM has no page but nothing happens when it is written), and no further than the page goes
+    auto hostAddress{[this](uint16_t addr, bool write, int8_t step, uint32_t& iterations) -> uint8_t*
+    {
+        uint8_t* page{write ? mPages.write[addr >> PAGE_SHIFT] : const_cast<uint8_t*>(mPages.read[addr >> PAGE_SHIFT])};
+        if((page == nullptr) && (addr >= VRAM) && (addr < EXT_RAM))
+        {
+            page = memMap.data() + (addr & ~PAGE_MASK);
+        }
+        if(page == nullptr)
+        {
+            iterations = 0;
+            return nullptr;
+        }
+
+        if(step > 0)
+        {
+            iterations = std::min<uint32_t>(iterations, PAGE_SIZE - (addr & PAGE_MASK));
+        }
+        else if(step < 0)
+        {
+            iterations = std::min<uint32_t>(iterations, (addr & PAGE_MASK) + 1);
+        }
+        return page + (addr & PAGE_MASK);
+    }};
+
+    uint16_t& destPair{registers.pair(loop.dest)};
+    uint8_t* dest{hostAddress(destPair, true, loop.destStep, iterations)};
+    const uint8_t* source{nullptr};
+    if(loop.source != LOOP_FILL)
+    {
+        source = hostAddress(registers.pair(loop.source), false, loop.sourceStep, iterations);
     }
-    else if(XX == 2)
+    if(iterations == 0)
+    {
+        return;
+    }
+
+    // byte by byte like the loop, unless the ranges can't overlap
+    if(source == nullptr)
     {
-        switch(YYY)
+        uint8_t value{registers[R_A]};
+        if(loop.destStep == 0)
         {
-            case 0:
-            case 1:
-                opADDAr();
-                break;
-            case 2:
-                opSUBAr();
-                break;
-            case 3:
-                opSBCAr();
-                break;
-            case 4:
-                opANDAr();
-                break;
-            case 5:
-                opXORAr();
-                break;
-            case 6:
-                opORAr();
-                break;
-            case 7:
-                opCPAr();
-                break;
-        }     
+            *dest = value;
+        }
+        else
+        {
+            std::memset((loop.destStep > 0) ? dest : dest - (iterations - 1), value, iterations);
+        }
+    }
+    else if((loop.sourceStep == 1) && (loop.destStep == 1) && ((dest + iterations <= source) || (source + iterations <= dest)))
+    {
+        std::memcpy(dest, source, iterations);
+        registers[R_A] = dest[iterations - 1];
     }
     else
     {
-        switch(ZZZ)
+        for(uint32_t i{0}; i < iterations; i++)
         {
-            case 0:
-                x3z0Decode();
-                break;
-            case 1:
-                x3z1Decode();
-                break;
-            case 2:
-                x3z2Decode();
-                break;
-            case 3:
-                switch(YYY)
-                {
-                    case 0:
-                        opJPnn();
-                        break;
-                    case 6:
-                        opDI();
-                        break;
-                    case 7:
-                        opEI();
-                        break;
-                }
-                break;
-            case 4:
-                switch(YYY)
-                {
-                    case 0:
-                    case 1:
-                    case 2:
-                    case 3:
-                        opCALLccnn();
-                        break;
-                }
-                break;
-            case 5:
-                switch(Q)
-                {
-                    case 0:
-                        opPUSHrp2();
-                        break;
-                    case 1:
-                        if(P == 0){opCALLnn();}
-                        break;
-                }
-                break;
-            case 6:
-                switch(YYY)
-                {
-                    case 0:
-                    case 1:
-                        opADDAn();
-                        break;
-                    case 2:
-                        opSUBAn();
-                        break;
-                    case 3:
-                        opSBCAn();
-                        break;
-                    case 4:
-                        opANDAn();
-                        break;
-                    case 5:
-                        opXORAn();
-                        break;
-                    case 6:
-                        opORAn();
-                        break;
-                    case 7:
-                        opCPAn();
-                        break;
-                }
-                break;
-            case 7:
-                opRST();
-                break;
+            registers[R_A] = *source;
+            *dest = registers[R_A];
+            source += loop.sourceStep;
+            dest += loop.destStep;
         }
-        
     }
-}
 
-void CPU::x0z0Decode()
-{
-    switch(YYY)
+    if(source != nullptr)
     {
-        case 0:
-            opNOP();
-            break;
-        case 1:
-            opLDnnSP();
-            break;
-        case 2:
-            opSTOP();
-            break;
-        case 3:
-            opJRd();
-            break;
-        case 4:
-        case 5:
-        case 6:
-        case 7:
-            opJRccd();
-            break;
+        registers.pair(loop.source) += iterations * loop.sourceStep;
+    }
+    destPair += iterations * loop.destStep;
+
+    // the flags are whatever the last iteration's counter test left
+    if(loop.counter == LOOP_COUNTER_BC)
+    {
+        registers.pair(RP_BC) -= iterations;
+        registers[R_A] = registers[R_B] | registers[R_C];
+        logic8Bit(registers[R_A], false);
+    }
+    else
+    {
+        uint8_t lastCount{registers[loop.counter] - (iterations - 1)};
+        registers[loop.counter] -= iterations;
+        dec8Bit(lastCount);
     }
+
+    cycleCount = iterations * loop.cycles;
+    mBulkIterations += iterations;
+    mBulkCycles += cycleCount;
+    endInstruction();
+    beginInstruction();
 }
-void CPU::x0z2Decode()
+
+/* True if a fused sequence starts at any instruction in the first length bytes of code */
+bool CPU::hasFusedSequence(const uint8_t* code, uint16_t bytesLeft, uint16_t length)
 {
-    if(Q == 0)
+    for(uint16_t offset{0}; offset < length; offset += BlockCache::getLength(code[offset]))
     {
-        switch(P)
+        DecodedOp op{};
+        if(matchFusedSequence(code + offset, bytesLeft - offset, op))
         {
-            case 0:
-            case 1:
-                opLDrrA();
-                break;
-            case 2:
-            case 3:
-                opLDHLIDA();
-                break;  
+            return true;
         }
     }
-    else
+    return false;
+}
+
+bool CPU::runJitBlock()
+{
+    if(!mJitEnabled)
+    {
+        return false;
+    }
+    const uint8_t* page{getCodePage()};
+    if(page == nullptr)
+    {
+        return false;
+    }
+
+    bool workRAM{pc >= WRAM_0};
+    if(workRAM && isCodeUncached(pc))
+    {
+        return false;
+    }
+
+    const uint8_t* code{page + (pc & PAGE_MASK)};
+    JitBlock block{nullptr};
+    uint16_t length{0};
+    if(!mJit.findBlock(code, block, length))
     {
-        switch(P)
+        if(mJit.isFull())
         {
-            case 0:
-            case 1:
-                opLDArr();
-                break;
-            case 2:
-            case 3:
-                opLDAHLID();
-                break;
+            flushBlocks();
         }
+        block = mJit.getBlock(code, pc, page, length);
+        if((block != nullptr) && mBlockCacheEnabled && hasFusedSequence(code, PAGE_SIZE - (pc & PAGE_MASK), length))
+        {
+            // the decoded block runs these as one op (loops in bulk), which beats the native code one instruction at a time
+            mJit.skipBlock(code, page, length);
+            block = nullptr;
+        }
+    }
+    if(block == nullptr)
+    {
+        return false;
     }
+
+    if(workRAM)
+    {
+        protectCode(pc, length);
+    }
+
+    // native code reads and writes F directly
+    materializeFlags();
+    updateRunHorizon();
+    mBlockPage = page;
+    mBlockDirty = false;
+    block(this);
+    return true;
 }
-void CPU::x0z7Decode()
+
+/* The first thing the interpreter would stop for between instructions: the run ending, TIMA overflowing, queued input, the PPU having to
+   catch up (its deadline, or OAM DMA). Compiled and generated code runs its own instructions without ending each one while cyclesSincePowerOn
+   stays below it */
+void CPU::updateRunHorizon()
 {
-    switch(YYY)
+    uint64_t ppuDue{cyclesSincePowerOn};
+    if(mPPUPendingCycles < mPPUDeadline)
     {
-        case 0:
-            opRLCA();
-            break;
-        case 1:
-            opRRCA();
-            break;
-        case 2:
-            opRLA();
-            break;
-        case 3:
-            opRRA();
-            break;
-        case 4:
-            opDAA();
-            break;
-        case 5:
-            opCPL();
-            break;
-        case 6:
-            opSCF();
-            break;
-        case 7:
-            opCCF();
-            break;
+        ppuDue += 4 * static_cast<uint64_t>(mPPUDeadline - mPPUPendingCycles);
     }
+    mRunHorizon = (mDMACyclesLeft != 0) ? 0 : std::min({mRunUntil, mTimerControl.getNextEvent(), mNextInputEvent, ppuDue});
 }
-void CPU::x3z0Decode()
+
+bool CPU::jitEndInstruction(CPU* cpu, uint32_t nextPC)
 {
-    switch(YYY)
+    cpu->endInstruction();
+    if(!cpu->continueBlock(nextPC))
     {
-        case 0:
-        case 1:
-        case 2:
-        case 3:
-            opRETcc();
-            break;
-        case 4:
-            opLDHnA();
-            break;
-        case 5:
-            opADDSPd();
-            break;
-        case 6:
-            opLDHAn();
-            break;
-        case 7:
-            opLDHLSPId();
-            break;
+        return false;
     }
+    cpu->updateRunHorizon();
+    return true;
 }
-void CPU::x3z1Decode()
+
+bool CPU::jitInterpret(CPU* cpu, uint32_t opcode, uint32_t nextPC)
 {
-    if(Q == 0)
+    cpu->opcode = opcode;
+    cpu->decode();
+    cpu->executeOp();
+    cpu->materializeFlags();
+    return jitEndInstruction(cpu, nextPC);
+}
+
+/* Compiled code comes here when a run of native instructions can't go on, something is due before the run is over or an access
+   needs the slow path. That instruction is interpreted, and so is each one after it until what is left of the run fits under the
+   horizon again, then compiled code picks up where this leaves off */
+const uint8_t* CPU::jitSlowPath(CPU* cpu, const JitStep* steps, uint32_t index)
+{
+    // what the run had charged from this instruction on is taken back first
+    if((index & JIT_SLOW_CHARGED) != 0)
     {
-        opPOPrp2();
+        index &= ~JIT_SLOW_CHARGED;
+        cpu->cyclesSincePowerOn -= 4 * steps[index].runCycles;
+        cpu->mPPUPendingCycles -= steps[index].runCycles;
     }
-    else
-    {  
-        switch(P)
+
+    while(true)
+    {
+        const JitStep& step{steps[index]};
+        cpu->pc = step.pc + 1;
+        if(!jitInterpret(cpu, step.opcode, step.nextPC))
         {
-            case 0:
-                opRET();
-                break;
-            case 1:
-                opRETI();
-                break;
-            case 2:
-                opJPHL();
-                break;
-            case 3:
-                opLDSPHL();
-                break;
+            return nullptr;
+        }
+
+        // the next one isn't native, or the rest of its run is clear
+        const JitStep& next{steps[index + 1]};
+        if(next.runCycles == 0)
+        {
+            return next.resume;
         }
+        uint64_t runEnd{cpu->cyclesSincePowerOn + 4 * next.runCycles};
+        if(runEnd < cpu->mRunHorizon)
+        {
+            cpu->cyclesSincePowerOn = runEnd;
+            cpu->mPPUPendingCycles += next.runCycles;
+            return next.resume;
+        }
+        index++;
+    }
+}
+
+// lowest set bit first, VBlank has the highest priority
+static const std::array<uint8_t, INTERRUPT_MASK + 1> interruptPriority{[]
+{
+    std::array<uint8_t, INTERRUPT_MASK + 1> priority{};
+    for(uint8_t pending{1}; pending <= INTERRUPT_MASK; pending++)
+    {
+        uint8_t bit{0};
+        while(!Helper::getBit(pending, bit))
+        {
+            bit++;
+        }
+        priority[pending] = bit;
+    }
+    return priority;
+}()};
+
+/* The accurate core takes the 5 m-cycles a dispatch does: two waiting, the two pushes and one to jump. The fast core takes none */
+template<class Accuracy>
+void CPU::handleInterrupt()
+{
+    // anything pending ends HALT, IME or not
+    if(mPendingInterrupts == 0)
+    {
+        return;
+    }
+    isHalted = false;
+    if(!IMEflag)
+    {
+        return;
+    }
+
+    uint8_t bit{interruptPriority[mPendingInterrupts]};
+    Helper::resetBit(memMap[INTERRUPT_FLAG], bit);
+    updatePendingInterrupts();
+    IMEflag = false;
+    if constexpr(Accuracy::TIMED_ACCESSES)
+    {
+        stepComponents<Accuracy>(2);
+    }
+    sp--;
+    writeMemory<Accuracy>(sp, Helper::hiBits(pc));
+    sp--;
+    writeMemory<Accuracy>(sp, Helper::loBits(pc));
+    pc = INTERRUPT_VECTOR + (bit * 8);
+    if constexpr(Accuracy::TIMED_ACCESSES)
+    {
+        stepComponents<Accuracy>(1);
     }
 }
-void CPU::x3z2Decode()
+
+void CPU::requestInterrupt(uint8_t bit)
 {
-    switch(YYY)
+    Helper::setBit(memMap[INTERRUPT_FLAG], bit);
+    updatePendingInterrupts();
+}
+
+/* Components leave their requests in a flag, these are taken right after a call that can raise one */
+void CPU::takeInterruptRequests()
+{
+    if(mPPU.reqVBInterrupt)
     {
-        case 0:
-        case 1:
-        case 2:
-        case 3:
-            opJPccnn();
+        mPPU.reqVBInterrupt = false;
+        requestInterrupt(INT_VBLANK);
+
+        // runFrame is done once this instruction is
+        if(mStopAtVBlank)
+        {
+            mRunUntil = cyclesSincePowerOn;
+        }
+    }
+    if(mPPU.reqLCDInterrupt)
+    {
+        mPPU.reqLCDInterrupt = false;
+        requestInterrupt(INT_LCD);
+    }
+    if(mTimerControl.reqInterrupt)
+    {
+        mTimerControl.reqInterrupt = false;
+        requestInterrupt(INT_TIMER);
+    }
+    if(mJoypad.reqInterrupt)
+    {
+        mJoypad.reqInterrupt = false;
+        requestInterrupt(INT_JOYPAD);
+    }
+}
+
+void CPU::updatePendingInterrupts()
+{
+    mPendingInterrupts = memMap[INTERRUPT_FLAG] & memMap[INTERRUPT_ENABLE] & INTERRUPT_MASK;
+}
+
+void CPU::handleJoypadInput(SDL_Scancode inputIndex, bool pressed)
+{
+    uint8_t i{0};
+    bool dPad{false};
+    switch(inputIndex)
+    {
+        case SDL_SCANCODE_D:
+            dPad = true;
+            i = 0;
             break;
-        case 4: 
-            opLDHCA();
+        case SDL_SCANCODE_A:
+            dPad = true;
+            i = 1;
             break;
-        case 5:
-            opLDnnA();
+        case SDL_SCANCODE_W:
+            dPad = true;
+            i = 2;
             break;
-        case 6:
-            opLDHAC();
+        case SDL_SCANCODE_S:
+            dPad = true;
+            i = 3;
             break;
-        case 7:
-            opLDAnn();
+        case SDL_SCANCODE_G:
+            i = 0;
             break;
+        case SDL_SCANCODE_F:
+            i = 1;
+            break;
+        case SDL_SCANCODE_SPACE:
+            i = 2;
+            break;
+        case SDL_SCANCODE_RETURN:
+            i = 3;
+            break;
+        default:
+            break;
+    }
+    if (pressed)
+    {
+        mJoypad.setJoypadState(dPad, i, memMap);
+    }
+    else
+    {
+        mJoypad.resetJoypadState(dPad, i);
+    }
+    takeInterruptRequests();
+
+}
+
+void CPU::queueInput(uint64_t timestamp, SDL_Scancode inputIndex, bool pressed)
+{
+    // after anything stamped with the same cycle, so presses and releases stay in the order they came in
+    auto position{std::upper_bound(mInputQueue.begin(), mInputQueue.end(), timestamp,
+                                   [](uint64_t time, const InputEvent& event) { return time < event.timestamp; })};
+    mInputQueue.insert(position, InputEvent{timestamp, inputIndex, pressed});
+    mNextInputEvent = mInputQueue.front().timestamp;
+}
+
+void CPU::applyInputEvents()
+{
+    while(!mInputQueue.empty() && (mInputQueue.front().timestamp <= cyclesSincePowerOn))
+    {
+        InputEvent event{mInputQueue.front()};
+        mInputQueue.pop_front();
+        handleJoypadInput(event.key, event.pressed);
     }
+    mNextInputEvent = mInputQueue.empty() ? NO_INPUT_EVENT : mInputQueue.front().timestamp;
 }
+
+template<class Accuracy>
+void CPU::executeOp()
+{
+    // do CB prefix instead
+    if(opcode == 0xCB)
+    {
+        opcode = readMemory<Accuracy>(pc);
+        pc++;
+        decode();
+        (this->*selectPrefixedOp<Accuracy>())();
+        return;
+    }
+
+    OpHandler handler{selectOp<Accuracy>()};
+    if(handler != nullptr)
+    {
+        (this->*handler)();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,317 @@
+#include "CPU.hpp"
+
+/*
+    Sequences that show up all over guest code, done by one fused op when a block is decoded.
+    Every instruction in a sequence still ends like it does in the interpreter (PPU, timers, interrupts),
+    a fused op only saves dispatching and decoding them one at a time, so cycle counts and the places
+    an interrupt can be taken are exactly the same. Longer sequences come first, the first match wins.
+    pattern is every byte of the sequence, mask picks the bits that have to match (0 for operands).
+    Whole copy and fill loops also do as many iterations as they can in one go (see runLoopInBulk).
+*/
+const std::array<CPU::FusedSequence, FUSED_SEQUENCE_COUNT> CPU::fusedSequences
+{{
+    // LD A,(HL+) / LD (DE),A / INC DE / DEC BC / LD A,B / OR C / JR NZ,loop
+    {"copy loop on BC", 8, {0x2A, 0x12, 0x13, 0x0B, 0x78, 0xB1, 0x20, 0xF8}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+     &CPU::fusedLoop, {RP_HL, 1, RP_DE, 1, LOOP_COUNTER_BC, 13}},
+    // LD A,(HL+) / LD (DE),A / INC DE / DEC B or DEC C / JR NZ,loop
+    {"copy loop on B", 6, {0x2A, 0x12, 0x13, 0x05, 0x20, 0xFA}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, &CPU::fusedLoop, {RP_HL, 1, RP_DE, 1, R_B, 10}},
+    {"copy loop on C", 6, {0x2A, 0x12, 0x13, 0x0D, 0x20, 0xFA}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, &CPU::fusedLoop, {RP_HL, 1, RP_DE, 1, R_C, 10}},
+    // LD (HL+),A or LD (HL-),A / DEC B or DEC C / JR NZ,loop
+    {"fill loop on B", 4, {0x22, 0x05, 0x20, 0xFC}, {0xFF, 0xFF, 0xFF, 0xFF}, &CPU::fusedLoop, {LOOP_FILL, 0, RP_HL, 1, R_B, 6}},
+    {"fill loop on C", 4, {0x22, 0x0D, 0x20, 0xFC}, {0xFF, 0xFF, 0xFF, 0xFF}, &CPU::fusedLoop, {LOOP_FILL, 0, RP_HL, 1, R_C, 6}},
+    {"fill down loop on B", 4, {0x32, 0x05, 0x20, 0xFC}, {0xFF, 0xFF, 0xFF, 0xFF}, &CPU::fusedLoop, {LOOP_FILL, 0, RP_HL, -1, R_B, 6}},
+
+    // LD A,(HL+) / LD (DE),A / INC DE / DEC BC
+    {"copy and count", 4, {0x2A, 0x12, 0x13, 0x0B}, {0xFF, 0xFF, 0xFF, 0xFF}, &CPU::fusedCopyCount, {}},
+    // LD A,(HL+) / LD (DE),A / INC DE
+    {"copy", 3, {0x2A, 0x12, 0x13}, {0xFF, 0xFF, 0xFF}, &CPU::fusedCopy, {}},
+    // DEC BC / LD A,B / OR C / JR NZ,d
+    {"loop on BC", 5, {0x0B, 0x78, 0xB1, 0x20}, {0xFF, 0xFF, 0xFF, 0xFF, 0x00}, &CPU::fusedLoopBC, {}},
+    // LDH A,(n) / CP n / JR cc,d
+    {"poll compare", 6, {0xF0, 0x00, 0xFE, 0x00, 0x20}, {0xFF, 0x00, 0xFF, 0x00, 0xE7, 0x00}, &CPU::fusedPoll, {}},
+    // LDH A,(n) / AND n / JR cc,d
+    {"poll mask", 6, {0xF0, 0x00, 0xE6, 0x00, 0x20}, {0xFF, 0x00, 0xFF, 0x00, 0xE7, 0x00}, &CPU::fusedPoll, {}},
+    // DEC B or DEC C / JR cc,d
+    {"count down", 3, {0x05, 0x20}, {0xF7, 0xE7, 0x00}, &CPU::fusedCountDown, {}},
+}};
+
+/*
+    Loops found by profiling particular games, for when a game copies or clears memory in a way the
+    patterns above don't match (other registers, other counters). Each entry has the game's
+    Cartridge::getROMHash, where the loop starts, its bytes and what one iteration does.
+    A hint is only used when the bytes in the ROM are the ones given.
+*/
+const std::vector<CPU::LoopHint> CPU::loopHints
+{
+    // Pokemon Red (UE) CopyData, LD A,(HL+) / LD (DE),A / INC DE / DEC BC / LD A,C / OR B / JR NZ (C before B, unlike "copy loop on BC")
+    {0x2091E6, 0, 0x00B5, 8, {0x2A, 0x12, 0x13, 0x0B, 0x79, 0xB0, 0x20, 0xF8}, {RP_HL, 1, RP_DE, 1, LOOP_COUNTER_BC, 13}},
+    // Pokemon Blue (UE), the same home bank
+    {0xD39D0A, 0, 0x00B5, 8, {0x2A, 0x12, 0x13, 0x0B, 0x79, 0xB0, 0x20, 0xF8}, {RP_HL, 1, RP_DE, 1, LOOP_COUNTER_BC, 13}},
+};
+
+static const char* loopHintName{"loop hints"};
+
+bool CPU::setFusionEnabled(const std::string& name, bool enabled)
+{
+    for(uint8_t i{0}; i <= LOOP_HINT_INDEX; i++)
+    {
+        if(name == ((i == LOOP_HINT_INDEX) ? loopHintName : fusedSequences[i].name))
+        {
+            // blocks already decoded keep what they were decoded with
+            mFusionEnabled[i] = enabled;
+            flushBlocks();
+            return true;
+        }
+    }
+    std::cout << "No fused sequence called " << name << std::endl;
+    return false;
+}
+
+void CPU::printFusionStats(std::ostream& out)
+{
+    for(uint8_t i{0}; i <= LOOP_HINT_INDEX; i++)
+    {
+        out << ((i == LOOP_HINT_INDEX) ? loopHintName : fusedSequences[i].name) << ": " << mFusionHits[i]
+            << (mFusionEnabled[i] ? "" : " (disabled)") << std::endl;
+    }
+    out << "loop iterations done in bulk: " << mBulkIterations << " (" << mBulkCycles << " m-cycles not stepped through)" << std::endl;
+}
+
+void CPU::findLoopHints()
+{
+    mLoopHints.clear();
+    uint32_t romHash{mCartridge->getROMHash()};
+    for(const LoopHint& hint : loopHints)
+    {
+        if((hint.romHash == romHash) && (hint.bank < mCartridge->getROMBankCount()))
+        {
+            const uint8_t* code{mCartridge->getROM() + (hint.bank * ROM_BANK_SIZE) + (hint.address % ROM_BANK_SIZE)};
+            if(std::memcmp(code, hint.code, hint.length) == 0)
+            {
+                mLoopHints.push_back({code, &hint});
+            }
+        }
+    }
+}
+
+bool CPU::matchFusedSequence(const uint8_t* code, uint16_t bytesLeft, DecodedOp& op)
+{
+    // a hint only counts if the code there still jumps back to where the hint says the loop starts
+    for(const auto& [hintCode, hint] : mLoopHints)
+    {
+        if(mFusionEnabled[LOOP_HINT_INDEX] && (hintCode == code) && (hint->length <= std::min<uint16_t>(bytesLeft, FUSED_MAX_BYTES)) &&
+           (code[hint->length - 2] == 0x20) && (static_cast<int8_t>(code[hint->length - 1]) == -hint->length))
+        {
+            op.fused = &CPU::fusedLoop;
+            op.fusedIndex = LOOP_HINT_INDEX;
+            op.loop = &hint->loop;
+            op.length = hint->length;
+            std::memcpy(op.operands, code, hint->length);
+            return true;
+        }
+    }
+
+    for(uint8_t i{0}; i < FUSED_SEQUENCE_COUNT; i++)
+    {
+        const FusedSequence& sequence{fusedSequences[i]};
+        if(!mFusionEnabled[i] || (sequence.length > bytesLeft))
+        {
+            continue;
+        }
+
+        bool matched{true};
+        for(uint8_t j{0}; j < sequence.length; j++)
+        {
+            if((code[j] & sequence.mask[j]) != sequence.pattern[j])
+            {
+                matched = false;
+                break;
+            }
+        }
+        if(matched)
+        {
+            op.fused = sequence.handler;
+            op.fusedIndex = i;
+            op.loop = (sequence.loop.cycles != 0) ? &sequence.loop : nullptr;
+            op.length = sequence.length;
+            std::memcpy(op.operands, code, sequence.length);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Everything the interpreter does between two instructions, false if the block has to stop here */
+bool CPU::endFusedInstruction()
+{
+    uint16_t nextPC{pc};
+    endInstruction();
+    return continueBlock(nextPC);
+}
+
+/* Runs the instructions kept in the op one at a time, for sequences without a handler of their own */
+bool CPU::runFusedBytes(const DecodedOp& op)
+{
+    uint8_t offset{0};
+    while(true)
+    {
+        offset += executeBytes(op.operands + offset);
+        if(offset >= op.length)
+        {
+            return true;
+        }
+        if(!endFusedInstruction())
+        {
+            return false;
+        }
+    }
+}
+
+/* A loop that jumps back to itself, as much of it as possible is done at once and the rest one iteration at a time */
+bool CPU::fusedLoop(const DecodedOp& op)
+{
+    runLoopInBulk(*op.loop);
+    return runFusedBytes(op);
+}
+
+bool CPU::fusedCopy(const DecodedOp&)
+{
+    // LD A,(HL+)
+    uint16_t& combinedHL{registers.pair(RP_HL)};
+    registers[R_A] = readMemory(combinedHL);
+    combinedHL++;
+    pc++;
+    cycleCount += 2;
+    if(!endFusedInstruction())
+    {
+        return false;
+    }
+
+    // LD (DE),A
+    writeMemory(registers.pair(RP_DE), registers[R_A]);
+    pc++;
+    cycleCount += 2;
+    if(!endFusedInstruction())
+    {
+        return false;
+    }
+
+    // INC DE
+    registers.pair(RP_DE)++;
+    pc++;
+    cycleCount += 2;
+    return true;
+}
+
+bool CPU::fusedCopyCount(const DecodedOp& op)
+{
+    if(!fusedCopy(op) || !endFusedInstruction())
+    {
+        return false;
+    }
+
+    // DEC BC
+    registers.pair(RP_BC)--;
+    pc++;
+    cycleCount += 2;
+    return true;
+}
+
+bool CPU::fusedLoopBC(const DecodedOp& op)
+{
+    // DEC BC
+    registers.pair(RP_BC)--;
+    pc++;
+    cycleCount += 2;
+    if(!endFusedInstruction())
+    {
+        return false;
+    }
+
+    // LD A,B
+    registers[R_A] = registers[R_B];
+    pc++;
+    cycleCount += 1;
+    if(!endFusedInstruction())
+    {
+        return false;
+    }
+
+    // OR C
+    registers[R_A] |= registers[R_C];
+    logic8Bit(registers[R_A], false);
+    pc++;
+    cycleCount += 1;
+    if(!endFusedInstruction())
+    {
+        return false;
+    }
+
+    fusedJumpRelative(op.operands[3], op.operands[4]);
+    return true;
+}
+
+bool CPU::fusedPoll(const DecodedOp& op)
+{
+    // LDH A,(n)
+    registers[R_A] = readMemory(0xFF00 + op.operands[1]);
+    pc += 2;
+    cycleCount += 3;
+    if(!endFusedInstruction())
+    {
+        return false;
+    }
+
+    // CP n or AND n
+    if(op.operands[2] == 0xFE)
+    {
+        sub8Bit(registers[R_A], op.operands[3], false);
+    }
+    else
+    {
+        registers[R_A] &= op.operands[3];
+        logic8Bit(registers[R_A], true);
+    }
+    pc += 2;
+    cycleCount += 2;
+    if(!endFusedInstruction())
+    {
+        return false;
+    }
+
+    fusedJumpRelative(op.operands[4], op.operands[5]);
+    return true;
+}
+
+bool CPU::fusedCountDown(const DecodedOp& op)
+{
+    // DEC B or DEC C
+    uint8_t regIndex{(op.operands[0] >> 3) & 0b111};
+    uint8_t originalVal{registers[regIndex]};
+    registers[regIndex]--;
+    dec8Bit(originalVal);
+    pc++;
+    cycleCount += 1;
+    if(!endFusedInstruction())
+    {
+        return false;
+    }
+
+    fusedJumpRelative(op.operands[1], op.operands[2]);
+    return true;
+}
+
+/* JR cc,d as the last instruction of a sequence, same as opJRccd */
+void CPU::fusedJumpRelative(uint8_t jumpOpcode, int8_t offset)
+{
+    pc += 2;
+    if(passedCondition(((jumpOpcode >> 3) & 0b111) - 4))
+    {
+        pc = pc + offset;
+        cycleCount += 3;
+    }
+    else
+    {
+        cycleCount += 2;
+    }
+}
\ No newline at end of file
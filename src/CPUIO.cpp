@@ -0,0 +1,106 @@
+#include "CPU.hpp"
+
+/*
+    Registers in the high page (0xFF00-0xFFFF) that do more than store a byte.
+    Every other address has no handler and is read or written straight from memMap,
+    so adding a register here never slows down the ones that are already there.
+*/
+const std::array<CPU::IOReadHandler, 256> CPU::ioReadHandlers{CPU::makeIOReadHandlers()};
+const std::array<CPU::IOWriteHandler, 256> CPU::ioWriteHandlers{CPU::makeIOWriteHandlers()};
+
+std::array<CPU::IOReadHandler, 256> CPU::makeIOReadHandlers()
+{
+    std::array<IOReadHandler, 256> handlers{};
+    handlers[JOYPAD_REG & 0xFF] = &CPU::readJoypad;
+    handlers[DIV_LOC & 0xFF] = &CPU::readTimer;
+    handlers[TIMA_LOC & 0xFF] = &CPU::readTimer;
+    return handlers;
+}
+
+std::array<CPU::IOWriteHandler, 256> CPU::makeIOWriteHandlers()
+{
+    std::array<IOWriteHandler, 256> handlers{};
+    handlers[JOYPAD_REG & 0xFF] = &CPU::writeJoypad;
+    handlers[SERIAL_CONTROL & 0xFF] = &CPU::writeSerialControl;
+    handlers[DIV_LOC & 0xFF] = &CPU::writeTimer;
+    handlers[TIMA_LOC & 0xFF] = &CPU::writeTimer;
+    handlers[TMA_LOC & 0xFF] = &CPU::writeTimer;
+    handlers[TAC_LOC & 0xFF] = &CPU::writeTimer;
+    handlers[SCANLINE_REGISTER & 0xFF] = &CPU::writeResetRegister;
+    handlers[DMA_REG & 0xFF] = &CPU::writeDMA;
+    handlers[INTERRUPT_FLAG & 0xFF] = &CPU::writeInterruptRegister;
+    handlers[INTERRUPT_ENABLE & 0xFF] = &CPU::writeInterruptRegister;
+    return handlers;
+}
+
+uint8_t CPU::readJoypad(uint16_t addr)
+{
+    return mJoypad.getJoypadState(memMap);
+}
+
+void CPU::writeJoypad(uint16_t addr, uint8_t data)
+{
+    // only the select bits can be written
+    memMap[addr] = data & 0xF0;
+}
+
+void CPU::writeSerialControl(uint16_t addr, uint8_t data)
+{
+    memMap[addr] = data;
+
+    // no link cable, but test ROMs print their results through it
+    if(data == 0x81)
+    {
+        std::cout << memMap[SERIAL_DATA];
+    }
+}
+
+void CPU::writeResetRegister(uint16_t addr, uint8_t data)
+{
+    // LY goes back to 0 whatever is written
+    memMap[addr] = 0;
+}
+
+void CPU::writeDMA(uint16_t addr, uint8_t data)
+{
+    memMap[addr] = data;
+    DMATransfer(data);
+}
+
+void CPU::writeInterruptRegister(uint16_t addr, uint8_t data)
+{
+    memMap[addr] = data;
+    updatePendingInterrupts();
+}
+
+// the timers work out where they are from the time of the access
+uint8_t CPU::readTimer(uint16_t addr)
+{
+    if(addr == DIV_LOC)
+    {
+        return mTimerControl.readDIV(cyclesSincePowerOn);
+    }
+    uint8_t tima{mTimerControl.readTIMA(cyclesSincePowerOn, memMap)};
+    takeInterruptRequests();
+    return tima;
+}
+
+void CPU::writeTimer(uint16_t addr, uint8_t data)
+{
+    switch(addr)
+    {
+        case DIV_LOC:
+            mTimerControl.writeDIV(cyclesSincePowerOn, memMap);
+            break;
+        case TIMA_LOC:
+            mTimerControl.writeTIMA(cyclesSincePowerOn, data, memMap);
+            break;
+        case TMA_LOC:
+            mTimerControl.writeTMA(cyclesSincePowerOn, data, memMap);
+            break;
+        case TAC_LOC:
+            mTimerControl.writeTAC(cyclesSincePowerOn, data, memMap);
+            break;
+    }
+    takeInterruptRequests();
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 void CPU::debugLog(std::ostream& logFile)
 {
+    materializeFlags();
     logFile << "A:"; 
             if(registers[R_A] == 0)
             {
@@ -96,13 +97,13 @@ void CPU::debugLog(std::ostream& logFile)
             logFile << " PCMEM:";
             for(int i{0}; i < 4; i++)
             {
-                if(memMap[pc + i] == 0)
+                if(readMemory(pc + i) == 0)
                 {
                     logFile << "00";
                 }
                 else
                 {
-                    logFile << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << (int)memMap[pc + i];
+                    logFile << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << (int)readMemory(pc + i);
                 }
                 if(i != 3)
                 {
@@ -111,5 +112,5 @@ void CPU::debugLog(std::ostream& logFile)
             }
             logFile << ")\n";
             //logFile << " IME: " << IMEflag << " IE: " << (int)memMap[0xFFFF] << " IF: " << (int)memMap[0xFF0F];
-            //logFile << " TIMA: " << (int)memMap[TIMA_LOC] << " TAC: " << (int)memMap[TAC_LOC] << " TIMA Cyc: " << mTimerControl.getTimeCycles() << "\n";
+            //logFile << " TIMA: " << (int)memMap[TIMA_LOC] << " TAC: " << (int)memMap[TAC_LOC] << "\n";
 }
\ No newline at end of file
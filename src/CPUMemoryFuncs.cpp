@@ -1,148 +1,127 @@
 #include "CPU.hpp"
+#include <algorithm>
 
 void CPU::loadROM(const std::string fileName)
 {
-    std::ifstream inputFile(fileName, std::ios::binary);
-    if(!inputFile.is_open())
-    {
-        std::cout << "Failed to open file" << std::endl;
-        return;
-    }
-
-    uint32_t fileSize{std::filesystem::file_size(fileName)};
+    // saves go next to the ROM, game.gb -> game.sav
+    loadROM(fileName, std::filesystem::path(fileName).replace_extension(".sav").string());
+}
 
-    // No larger than 8 MB
-    if(fileSize > (8*pow(10, 6)))
+void CPU::loadROM(const std::string fileName, const std::string& savePath)
+{
+    std::shared_ptr<const Cartridge> cartridge{Cartridge::load(fileName)};
+    if(cartridge)
     {
-        std::cout << "No ROMs greater than 8 MB allowed";
-        return;
+        loadCartridge(cartridge, savePath);
     }
+}
+
+void CPU::loadCartridge(std::shared_ptr<const Cartridge> cartridge, const std::string& savePath)
+{
+    mCartridge = cartridge;
 
-    std::vector<char> fBuffer = std::vector<char>(std::istreambuf_iterator<char>(inputFile), std::istreambuf_iterator<char>());
-    inputFile.close();
+    // decoded and compiled code points into the old ROM
+    flushBlocks();
+    findLoopHints();
+    findAotProgram();
 
     // setup banks first
-    getBankMode(fBuffer[CART_TYPE]);
-    getROMSize(fBuffer[ROM_HEADER]);
-    getRAMSize(fBuffer[RAM_HEADER]);
-    generateBanks();
-
-    for(uint32_t i{0}; i < fileSize; i++)
+    generateBanks(savePath);
+    mMapper = Mapper::create(*mCartridge, mExtRAM, mExtRAMSize, mPages, cyclesSincePowerOn);
+    if(mSaveExtra != nullptr)
     {
-        // only do if i has not exceeded 0x7FFF
-        if(i < 0x8000)
-        {
-            memMap[i] = fBuffer[i];
-        }
+        mMapper->loadBattery(mSaveExtra);
+    }
+}
 
-        // we have exceeded space available in ROM banks 0 to 1 so check if banks exist
-        // this also checks if the banks will even be enough
-        else if((maxROMBanks != 2) && (ROMBanks.size() >= (fileSize - 0x8000)))
-        {
-            ROMBanks[i - 0x8000] = fBuffer[i];
-        }
-        
-        // Banks don't exist and we ran out of space so the ROM has some issue
-        else
-        {
-            std::cout << "ERROR: Check ROM header and see if enough ROM banks are allocated " << std::endl; 
-            return;
-        }   
+void CPU::flushSaveRAM()
+{
+    // the clock is only worked out when needed, so write it into the .sav now
+    if(mSaveExtra != nullptr)
+    {
+        mMapper->saveBattery(mSaveExtra);
     }
+    mSaveFile.flush();
 }
 
+template<class Accuracy>
 uint8_t CPU::readMemory(uint16_t addr)
 {
-    uint8_t returnVal{0};
-    // between 0x4000 and 0x7FFF we need to use ROM banks
-    if(addr < ROM_NN)
+    if constexpr(Accuracy::TIMED_ACCESSES)
     {
-        returnVal = memMap[addr];
+        timeAccess();
     }
-
-    // between 0x4000 and 0x7FFF we need to use ROM banks
-    else if((addr >= ROM_NN) && (addr < VRAM))
+    else
     {
-        if(curROMBank == 1)
-        {
-            // read directly from ROM
-            returnVal = memMap[addr];
-        }
-        else
-        {
-            // subtract by 0x4000
-            addr -= 0x4000;
-
-            // add an offset depending on bank number
-            addr += 0x4000*(curROMBank - 2);
-
-            returnVal = ROMBanks[addr];
-        }
+        mAccessCycles++;
     }
 
-    else if((addr >= VRAM) && (addr < EXT_RAM))
+    // ROM and enabled RAM banks are read straight from wherever the mapper last pointed them
+    const uint8_t* page{mPages.read[addr >> PAGE_SHIFT]};
+    if(page != nullptr)
     {
-        returnVal = memMap[addr];
+        return page[addr & PAGE_MASK];
     }
 
-    // between 0xA000 and 0xBFFF we need to use RAM banks
-    else if((addr >= EXT_RAM) && (addr < WRAM_0))
+    // IO registers, HRAM and IE: one table lookup, plain registers have no handler
+    if(addr >= IO_REGISTERS)
     {
-        if(curRAMBank == 0)
+        // LY and STAT are exact when read
+        if constexpr(Accuracy::LAZY_PPU)
         {
-            // read directly
-            returnVal = memMap[addr];
+            if(((addr >= LCDC) && (addr <= GBWINDOW_X)) || (addr == INTERRUPT_FLAG) || (addr == INTERRUPT_ENABLE))
+            {
+                syncPPU();
+            }
         }
-        else
-        {
-
-            // add an offset depending on bank number
-            addr += 0x2000*(curRAMBank - 1);
 
-            returnVal = RAMBanks[addr];
+        IOReadHandler handler{ioReadHandlers[addr & 0xFF]};
+        if(handler != nullptr)
+        {
+            return (this->*handler)(addr);
         }
+        return memMap[addr];
     }
 
-    else if((addr >= WRAM_0) && (addr < WRAM_N))
+    // only the 0xF000 page is left to check while OAM DMA has the bus, the rest read from dmaBlockedPage
+    if(mDMACyclesLeft != 0)
     {
-        returnVal = memMap[addr];
-    }
-
-    else if((addr >= WRAM_N) && (addr < ECHO_RAM))
-    {
-        returnVal = memMap[addr];
-
-        // need to add a cgb wram bank handler here
+        return 0xFF;
     }
 
-    else if((addr >= ECHO_RAM) && (addr < SPRITE_TABLE))
+    // VRAM and OAM have no pages, so the PPU can be caught up before they are read
+    if constexpr(Accuracy::LAZY_PPU)
     {
-        returnVal = memMap[addr];
+        if(((addr >= VRAM) && (addr < EXT_RAM)) || ((addr >= SPRITE_TABLE) && (addr < UNUSABLE_AREA)))
+        {
+            syncPPU();
+        }
     }
 
-    else if((addr >= SPRITE_TABLE) && (addr < UNUSABLE_AREA))
+    uint8_t returnVal{0};
+    if((addr >= VRAM) && (addr < EXT_RAM))
     {
         returnVal = memMap[addr];
     }
 
-    else if((addr >= UNUSABLE_AREA) && (addr < IO_REGISTERS))
+    // only gets here when RAM is disabled or is not plain memory
+    else if((addr >= EXT_RAM) && (addr < WRAM_0))
     {
-        returnVal = memMap[addr];
+        returnVal = mMapper->readRAM(addr);
     }
 
-    else if((addr >= IO_REGISTERS) && (addr < HRAM_LOC))
+    // 0xC000-0xEFFF is always paged, only the end of echo RAM that shares a page with OAM gets here
+    else if((addr >= ECHO_RAM) && (addr < SPRITE_TABLE))
     {
-        if(addr == 0xFF00){ returnVal = mJoypad.getJoypadState(memMap); }
-        //else if(addr == SCANLINE_REGISTER){ returnVal = 0x90;}
-        else{returnVal = memMap[addr];}
+        returnVal = memMap[addr - ECHO_OFFSET];
     }
 
-    else if((addr >= HRAM_LOC) && (addr < INTERRUPT_ENABLE))
+    else if((addr >= SPRITE_TABLE) && (addr < UNUSABLE_AREA))
     {
         returnVal = memMap[addr];
     }
 
-    else if(addr == 0xFFFF)
+    else if((addr >= UNUSABLE_AREA) && (addr < IO_REGISTERS))
     {
         returnVal = memMap[addr];
     }
@@ -150,61 +129,104 @@ uint8_t CPU::readMemory(uint16_t addr)
     return returnVal;
 }
 
+template<class Accuracy>
 void CPU::writeMemory(uint16_t addr, uint8_t data)
 {
-    // writes to ROM are blocked
-    if(addr < VRAM)
+    if constexpr(Accuracy::TIMED_ACCESSES)
+    {
+        timeAccess();
+    }
+    else
     {
-        doBanking(addr, data);
+        mAccessCycles++;
     }
 
-    else if((addr >= VRAM) && (addr < EXT_RAM))
+    // enabled RAM banks are written straight to wherever the mapper last pointed them
+    uint8_t* page{mPages.write[addr >> PAGE_SHIFT]};
+    if(page != nullptr)
     {
-        memMap[addr] = data;
+        page[addr & PAGE_MASK] = data;
+        return;
     }
 
-    // between 0xA000 and 0xBFFF we need to use RAM banks
-    else if((addr >= EXT_RAM) && (addr < WRAM_0))
+    // IO registers, HRAM and IE: one table lookup, plain registers have no handler
+    if(addr >= IO_REGISTERS)
     {
-        if(enableRAM)
+        // LCD registers written during mode 3: the pixel FIFO draws what it has not drawn yet of this line with the old value
+        if constexpr(Accuracy::PIXEL_FIFO)
         {
-            if(curRAMBank == 0)
+            if((addr >= LCDC) && (addr <= GBWINDOW_X))
             {
-                
-                memMap[addr] = data;
+                mPPU.catchUpLine(memMap);
             }
-            else
-            {
-
-                // add an offset depending on bank number
-                addr += 0x2000*(curROMBank - 1);
+        }
 
-                RAMBanks[addr] = data;
+        // the line renderer splits the line there instead, the fast core's PPU catches up first and
+        // checks again when it next has to (LCDC, STAT and LYC decide that)
+        else
+        {
+            if((addr >= LCDC) && (addr <= GBWINDOW_X))
+            {
+                syncPPU();
+                mPPUDeadline = 0;
+                mPPU.logRegisterWrite(addr, data, mAccessCycles, memMap);
+            }
+            else if((addr == INTERRUPT_FLAG) || (addr == INTERRUPT_ENABLE))
+            {
+                syncPPU();
             }
         }
+
+        IOWriteHandler handler{ioWriteHandlers[addr & 0xFF]};
+        if(handler != nullptr)
+        {
+            (this->*handler)(addr, data);
+        }
+        else
+        {
+            memMap[addr] = data;
+        }
+        return;
     }
 
-    else if((addr >= WRAM_0) && (addr < WRAM_N))
+    // OAM DMA has the bus, nothing below the IO registers can be written
+    if(mDMACyclesLeft != 0)
     {
-        memMap[addr] = data;
-        memMap[addr + 0x2000] = data;
+        return;
     }
 
-    else if((addr >= WRAM_N) && (addr < ECHO_RAM))
+    if constexpr(Accuracy::LAZY_PPU)
     {
-        memMap[addr] = data;
-        if(addr <= 0xDDFF)
+        if(((addr >= VRAM) && (addr < EXT_RAM)) || ((addr >= SPRITE_TABLE) && (addr < UNUSABLE_AREA)))
         {
-            memMap[addr + 0x2000] = data;
+            syncPPU();
         }
+    }
 
-        // need to add a cgb wram bank handler here
+    // writes to ROM go to the mapper's registers
+    if(addr < VRAM)
+    {
+        mMapper->writeRegister(addr, data);
     }
 
-    // direct write to echo should be blocked I think
-    else if((addr >= ECHO_RAM) && (addr < SPRITE_TABLE))
+    else if((addr >= VRAM) && (addr < EXT_RAM))
     {
-        //memMap[addr];
+        memMap[addr] = data;
+    }
+
+    // between 0xA000 and 0xBFFF we need to use RAM banks
+    else if((addr >= EXT_RAM) && (addr < WRAM_0))
+    {
+        // only gets here when RAM is disabled or is not plain memory
+        mMapper->writeRAM(addr, data);
+    }
+
+    // work RAM pages only get here when code was decoded or compiled from them (or for the end of echo RAM)
+    else if((addr >= WRAM_0) && (addr < SPRITE_TABLE))
+    {
+        uint16_t workAddr{(addr >= ECHO_RAM) ? addr - ECHO_OFFSET : addr};
+        releaseCodeChunk(workAddr);
+        memMap[workAddr] = data;
     }
 
     else if((addr >= SPRITE_TABLE) && (addr < UNUSABLE_AREA))
@@ -216,252 +238,259 @@ void CPU::writeMemory(uint16_t addr, uint8_t data)
     {
         //memMap[addr];
     }
+}
+
+template uint8_t CPU::readMemory<FastAccuracy>(uint16_t addr);
+template uint8_t CPU::readMemory<CycleAccuracy>(uint16_t addr);
+template void CPU::writeMemory<FastAccuracy>(uint16_t addr, uint8_t data);
+template void CPU::writeMemory<CycleAccuracy>(uint16_t addr, uint8_t data);
 
-    else if((addr >= IO_REGISTERS) && (addr < HRAM_LOC))
+void CPU::generateBanks(const std::string& savePath)
+{
+    // ROM banks are not generated, they are read straight out of the mapped ROM file
+    // all RAM banks sit one after another, the mapper picks the one seen at 0xA000
+    mSaveFile.close();
+    mExtRAMCopy.clear();
+    mExtRAM = nullptr;
+    mSaveExtra = nullptr;
+    mExtRAMSize = mCartridge->getExtRAMSize();
+
+    // the MBC3 clock is kept after the RAM (there might not be any RAM)
+    uint32_t saveSize{mExtRAMSize + (mCartridge->hasRTC() ? RTC_SAVE_SIZE : 0)};
+    if(saveSize == 0)
     {
-        if(addr == 0xFF00)
-        {
-            data &= 0xF0;
-            memMap[addr] = data;
-        }
-        else if(addr == 0xFF46)
-        {
-            DMATransfer(data);
-        }
-        else if(addr == DIV_LOC)
+        return;
+    }
+
+    if(DEBUG_MODE){std::cout << "Generating " << mExtRAMSize << " bytes of RAM" << std::endl; std::getchar();}
+
+    // battery backed RAM is the .sav file itself, the OS writes it back on its own so writes never do I/O
+    bool battery{!savePath.empty() && mCartridge->hasBattery()};
+    if(battery && mSaveFile.openWritable(savePath, saveSize))
+    {
+        mExtRAM = mSaveFile.getWritableData();
+    }
+    else if(battery && std::filesystem::exists(savePath))
+    {
+        // another instance has the save, this one plays from a private copy of it that is never written back
+        mExtRAMCopy = std::vector<uint8_t>(saveSize, 0);
+        MappedFile saveFile;
+        if(saveFile.open(savePath))
         {
-            memMap[addr] = 0;
+            std::memcpy(mExtRAMCopy.data(), saveFile.getData(), std::min(saveFile.getSize(), saveSize));
         }
-        else if(addr == SCANLINE_REGISTER)
+        mExtRAM = mExtRAMCopy.data();
+    }
+    else
+    {
+        if(mExtRAMSize != 0)
         {
-            memMap[addr] = 0;
+            mExtRAMCopy = std::vector<uint8_t>(mExtRAMSize, 0);
+            mExtRAM = mExtRAMCopy.data();
         }
-        else{memMap[addr] = data;}
+        return;
     }
 
-    else if((addr >= HRAM_LOC) && (addr < INTERRUPT_ENABLE))
+    if(mCartridge->hasRTC())
     {
-        memMap[addr] = data;
+        mSaveExtra = mExtRAM + mExtRAMSize;
     }
+}
+
+void CPU::mapWorkRAM()
+{
+    // work RAM is plain memory in memMap, echo RAM is the same memory again so there is only ever one copy
+    // need to add a cgb wram bank handler here
+    uint8_t* workRAM{memMap.data() + WRAM_0};
+    mPages.read[WRAM_0 >> PAGE_SHIFT] = workRAM;
+    mPages.write[WRAM_0 >> PAGE_SHIFT] = workRAM;
+    mPages.read[WRAM_N >> PAGE_SHIFT] = workRAM + PAGE_SIZE;
+    mPages.write[WRAM_N >> PAGE_SHIFT] = workRAM + PAGE_SIZE;
+    mPages.read[ECHO_RAM >> PAGE_SHIFT] = workRAM;
+    mPages.write[ECHO_RAM >> PAGE_SHIFT] = workRAM;
+}
 
-    else if(addr == 0xFFFF)
+void CPU::protectCode(uint16_t addr, uint16_t length)
+{
+    // echo RAM code is work RAM code
+    if(addr >= ECHO_RAM)
     {
-        memMap[addr] = data;
+        addr -= ECHO_OFFSET;
+    }
+    for(uint16_t chunk{addr >> CODE_CHUNK_SHIFT}; chunk <= ((addr + length - 1) >> CODE_CHUNK_SHIFT); chunk++)
+    {
+        mCodeChunks[chunk] = true;
     }
 
-    if (addr == 0xFF02 && data == 0x81) 
+    uint8_t pageIndex{addr >> PAGE_SHIFT};
+    if(mCodePages[pageIndex])
     {
-		std::cout << memMap[0xFF01];
+        return;
     }
 
-     
+    // writes to the page go through the slow path, which checks the chunk
+    mCodePages[pageIndex] = true;
+    mPages.write[pageIndex] = nullptr;
+    if(pageIndex == (WRAM_0 >> PAGE_SHIFT))
+    {
+        mPages.write[ECHO_RAM >> PAGE_SHIFT] = nullptr;
+    }
 }
 
-void CPU::getBankMode(const uint8_t type)
+bool CPU::isCodeUncached(uint16_t addr) const
 {
-    switch(type)
-    {
-
-        // No MBC
-        case 0x0:
-            mbcType = NO_MBC;
-            break;
-
-        // MBC1
-        case 0x1:
-        case 0x2:
-        case 0x3:
-            mbcType = MBC1;
-            break;
-
-        // MBC2
-        case 0x5:
-        case 0x6:
-            mbcType = MBC2;
-            break;
-        
-        // MBC3
-        case 0x0F:
-        case 0x10:
-        case 0x11:
-        case 0x12:
-        case 0x13:
-            mbcType = MBC3;
-            break;
-        
-        // MBC5
-        case 0x19:
-        case 0x1A:
-        case 0x1B:
-        case 0x1C:
-        case 0x1D:
-        case 0x1E:
-            mbcType = MBC5;
-            break;
-
-        default:
-            mbcType = NO_MBC;
+    if(addr >= ECHO_RAM)
+    {
+        addr -= ECHO_OFFSET;
+    }
+    return mChunkInvalidations[addr >> CODE_CHUNK_SHIFT] >= CODE_CHUNK_MAX_INVALIDATIONS;
+}
 
+void CPU::releaseCodeChunk(uint16_t addr)
+{
+    uint8_t chunk{addr >> CODE_CHUNK_SHIFT};
+    if(mCodeChunks[chunk])
+    {
+        const uint8_t* chunkCode{memMap.data() + (chunk << CODE_CHUNK_SHIFT)};
+        mBlockCache.invalidateChunk(chunkCode);
+        mJit.invalidateChunk(chunkCode);
+        if(memMap.data() + (addr & ~PAGE_MASK) == mBlockPage)
+        {
+            mBlockDirty = true;
+        }
+        mCodeChunks[chunk] = false;
+        if(mChunkInvalidations[chunk] < CODE_CHUNK_MAX_INVALIDATIONS)
+        {
+            mChunkInvalidations[chunk]++;
+        }
     }
+
+    // the page can be written straight again once none of it has code
+    uint8_t pageIndex{addr >> PAGE_SHIFT};
+    for(uint8_t i{0}; i < CODE_CHUNKS_PER_PAGE; i++)
+    {
+        if(mCodeChunks[(pageIndex * CODE_CHUNKS_PER_PAGE) + i])
+        {
+            return;
+        }
+    }
+    releaseCodePage(pageIndex);
 }
 
-void CPU::getROMSize(const uint8_t type)
+void CPU::releaseCodePage(uint8_t pageIndex)
 {
-    switch(type)
-    {
-        case 0:
-            maxROMBanks = 2;
-            break;
-        case 1:
-            maxROMBanks = 4;
-            break;
-        case 2:
-            maxROMBanks = 8;
-            break;
-        case 3:
-            maxROMBanks = 16;
-            break;
-        case 4:
-            maxROMBanks = 32;
-            break;
-        case 5:
-            maxROMBanks = 64;
-            break;
-        case 6:
-            maxROMBanks = 128;
-            break;
-        case 7:
-            maxROMBanks = 256;
-            break;
-        case 8:
-            maxROMBanks = 512;
-            break;
-        case 0x52:
-            maxROMBanks = 72;
-            break;
-        case 0x53:
-            maxROMBanks = 80;
-            break;
-        case 0x54:
-            maxROMBanks = 96;
-            break;
-        default:
-            maxROMBanks = 2;
+    if(!mCodePages[pageIndex])
+    {
+        return;
+    }
+
+    uint8_t* page{memMap.data() + (pageIndex << PAGE_SHIFT)};
+    mBlockCache.invalidatePage(page);
+    mJit.invalidatePage(page);
+    if(page == mBlockPage)
+    {
+        mBlockDirty = true;
+    }
+    std::memset(mCodeChunks + (pageIndex * CODE_CHUNKS_PER_PAGE), 0, CODE_CHUNKS_PER_PAGE * sizeof(bool));
+
+    mCodePages[pageIndex] = false;
+    mPages.write[pageIndex] = page;
+    if(pageIndex == (WRAM_0 >> PAGE_SHIFT))
+    {
+        mPages.write[ECHO_RAM >> PAGE_SHIFT] = page;
     }
 }
 
-void CPU::getRAMSize(const uint8_t type)
+void CPU::flushBlocks()
 {
-    switch(type)
-    {
-        case 0x00:
-        case 0x01:
-            maxRAMBanks = 0;
-            break;
-        case 0x02:
-            maxRAMBanks = 1;
-            break;
-        case 0x03:
-            maxRAMBanks = 4;
-            break;
-        case 0x04:
-            maxRAMBanks = 16;
-            break;
-        case 0x05:
-            maxRAMBanks = 8;
-            break;
-        default:
-            maxRAMBanks = 0;
+    mBlockCache.flush();
+    mJit.flush();
+    for(uint8_t i{0}; i < PAGE_COUNT; i++)
+    {
+        releaseCodePage(i);
     }
+    std::memset(mChunkInvalidations, 0, sizeof(mChunkInvalidations));
 }
 
-void CPU::generateBanks()
+// reads while the bus is taken by OAM DMA
+static const std::array<uint8_t, PAGE_SIZE> dmaBlockedPage{[]
 {
-    /*  we need 2 less than maxROMBanks number of banks
-        each bank has 0x4000 addressable locations
-        Banks 00 and 01 are located in the memory map
-        Banks 02 and onwards are located contiguously
-        in the ROMBanks vector (so index 0 is bank 02, index 0x4000 is bank 03)
-    */
-    if(DEBUG_MODE){std::cout << "Generating " << (int)maxROMBanks-2 << " ROM banks" << std::endl; std::getchar();}
-    if(maxROMBanks > 2){ROMBanks = std::vector<uint8_t>((maxROMBanks - 2)*0x4000, 0);}
-    /*  because of how RAM banking works, 
-        banks = 0 means the allocated RAM section in memMap wont be used
-        so, if ram banks = 1, we don't actually need to create any new memory, 
-        so we create maxRAMBanks - 1 banks, only doing so if banks != 0 or 1
-    */
-    if(DEBUG_MODE){std::cout << "Generating " << (int)maxRAMBanks-1 << " RAM banks" << std::endl; std::getchar();}
-    if(maxRAMBanks > 1){RAMBanks = std::vector<uint8_t>((maxRAMBanks - 1)*0x2000, 0);}
+    std::array<uint8_t, PAGE_SIZE> page;
+    page.fill(0xFF);
+    return page;
+}()};
 
+void CPU::DMATransfer(uint8_t data)
+{
+    // starting again while a transfer is running just restarts it, the pages are already blocked
+    if(mDMACyclesLeft == 0)
+    {
+        mDMASavedPages = mPages;
+        blockPagesForDMA();
+    }
+    mDMASource = data * 0x100;
+    mDMACyclesLeft = DMA_CYCLES;
 }
 
-void CPU::DMATransfer(uint8_t data)
+void CPU::tickDMA(uint16_t mCycles)
 {
-    uint16_t addr{data * 0x100};
-    for(uint16_t i{0}; i < 0xA0; i++)
+    if(mCycles < mDMACyclesLeft)
     {
-        writeMemory(0xFE00 + i, readMemory(addr + i));
+        mDMACyclesLeft -= mCycles;
+        return;
     }
+    mDMACyclesLeft = 0;
+    finishDMA();
 }
 
-void CPU::doBanking(const uint16_t addr, const uint8_t data)
+void CPU::finishDMA()
 {
-    if (addr < 0x2000)
+    mPages = mDMASavedPages;
+
+    // the DMA bus sees work RAM again from 0xE000 up
+    uint16_t source{mDMASource};
+    if(source >= ECHO_RAM)
     {
-        if(mbcType == MBC1)
-        {
-            if((data & 0xF) == 0xA)
-            {
-                enableRAM = true;
-            }
-            else
-            {
-                enableRAM = false;
-            }
-        }
+        source -= ECHO_OFFSET;
     }
-    else if(addr < 0x4000)
+
+    // all 160 bytes always sit in one page, so this is one copy from wherever the page points
+    const uint8_t* page{mPages.read[source >> PAGE_SHIFT]};
+    if(page != nullptr)
     {
-        uint8_t maskedData{data & 0b11111};
-        curROMBank &= 0b11100000;
-        curROMBank |= maskedData;
-        if(curROMBank == 0)
-        {
-            curROMBank++;
-        }
+        std::memcpy(&memMap[SPRITE_TABLE], page + (source & PAGE_MASK), DMA_LENGTH);
     }
-    else if(addr < 0x6000)
+    else if((source >= EXT_RAM) && (source < WRAM_0))
     {
-        if(doingROMBanking)
-        {
-            uint8_t maskedData{data & 0b11100000};
-            curROMBank &= 0b00011111;
-            curROMBank |= maskedData;
-            if(curROMBank == 0)
-            {
-                curROMBank++;
-            } 
-        }
-        else
+        for(uint16_t i{0}; i < DMA_LENGTH; i++)
         {
-            curRAMBank = data & 0b11;
+            memMap[SPRITE_TABLE + i] = mMapper->readRAM(source + i);
         }
     }
-    else if(addr < 0x8000)
+    else
     {
-        uint8_t maskedData{data & 0b1};
-        if(maskedData == 0)
-        {
-            doingROMBanking = true;
-        }
-        else
-        {
-            doingROMBanking = false;
-        }
-        if(doingROMBanking)
+        std::memcpy(&memMap[SPRITE_TABLE], &memMap[source], DMA_LENGTH);
+    }
+}
+
+bool CPU::pagesBlockedForDMA() const
+{
+    for(uint8_t i{0}; i < PAGE_COUNT - 1; i++)
+    {
+        if(mPages.read[i] == dmaBlockedPage.data())
         {
-            curRAMBank = 0;
+            return true;
         }
-        
+    }
+    return false;
+}
+
+void CPU::blockPagesForDMA()
+{
+    // everything below the high page reads 0xFF (straight from the fast path) and ignores writes (in the slow path)
+    for(uint8_t i{0}; i < PAGE_COUNT - 1; i++)
+    {
+        mPages.read[i] = dmaBlockedPage.data();
+        mPages.write[i] = nullptr;
     }
 }
\ No newline at end of file
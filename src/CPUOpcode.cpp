@@ -16,35 +16,700 @@ void CPU::decode()
     Q = YYY & 0b1;
 }
 
+/* Immediate data after the opcode, a decoded block already has it */
+template<class Accuracy>
+uint8_t CPU::fetchOperand()
+{
+    uint8_t data;
+    if(mOperands == nullptr)
+    {
+        data = readMemory<Accuracy>(pc);
+    }
+
+    // still an access as far as the m-cycle an LCD write lands in goes
+    else
+    {
+        data = *mOperands++;
+        mAccessCycles++;
+    }
+    pc++;
+    return data;
+}
+
+/* OPCODE SELECTION */
+
+/* The op function for the decoded opcode, decoded blocks keep these instead of decoding again */
+template<class Accuracy>
+CPU::OpHandler CPU::selectPrefixedOp()
+{
+    OpHandler handler{nullptr};
+    switch(XX)
+    {
+        case 0:
+            handler = &CPU::opROT<Accuracy>;
+            break;
+        case 1:
+            handler = &CPU::opBIT<Accuracy>;
+            break;
+        case 2:
+            handler = &CPU::opRES<Accuracy>;
+            break;
+        case 3:
+            handler = &CPU::opSET<Accuracy>;
+            break;
+    }
+    return handler;
+}
+
+/* nullptr for the unused opcodes */
+template<class Accuracy>
+CPU::OpHandler CPU::selectOp()
+{
+    OpHandler handler{nullptr};
+    if(XX == 0)
+    {
+        switch(ZZZ)
+        {
+            case 0:
+                handler = x0z0Decode<Accuracy>();
+                break;
+            case 1:
+                switch(Q)
+                {
+                    case 0:
+                        handler = &CPU::opLDrpnn<Accuracy>;
+                        break;
+                    case 1:
+                        handler = &CPU::opADDHLrp;
+                        break;
+                }
+                break;
+            case 2:
+                handler = x0z2Decode<Accuracy>();
+                break;
+            case 3:
+                handler = &CPU::opINCDECrp;
+                break;
+            case 4:
+            case 5:
+                handler = &CPU::opINCDECr<Accuracy>;
+                break;
+            case 6:
+                handler = &CPU::opLDrn<Accuracy>;
+                break;
+            case 7:
+                handler = x0z7Decode<Accuracy>();
+                break;
+        }
+    }
+    else if(XX == 1)
+    {
+        if(ZZZ == 6 && YYY == 6)
+        {
+            handler = &CPU::opHALT<Accuracy>;
+        }
+        else
+        {
+            handler = &CPU::opLDrr<Accuracy>;
+        } 
+        
+    }
+    else if(XX == 2)
+    {
+        switch(YYY)
+        {
+            case 0:
+            case 1:
+                handler = &CPU::opADDAr<Accuracy>;
+                break;
+            case 2:
+                handler = &CPU::opSUBAr<Accuracy>;
+                break;
+            case 3:
+                handler = &CPU::opSBCAr<Accuracy>;
+                break;
+            case 4:
+                handler = &CPU::opANDAr<Accuracy>;
+                break;
+            case 5:
+                handler = &CPU::opXORAr<Accuracy>;
+                break;
+            case 6:
+                handler = &CPU::opORAr<Accuracy>;
+                break;
+            case 7:
+                handler = &CPU::opCPAr<Accuracy>;
+                break;
+        }     
+    }
+    else
+    {
+        switch(ZZZ)
+        {
+            case 0:
+                handler = x3z0Decode<Accuracy>();
+                break;
+            case 1:
+                handler = x3z1Decode<Accuracy>();
+                break;
+            case 2:
+                handler = x3z2Decode<Accuracy>();
+                break;
+            case 3:
+                switch(YYY)
+                {
+                    case 0:
+                        handler = &CPU::opJPnn<Accuracy>;
+                        break;
+                    case 6:
+                        handler = &CPU::opDI;
+                        break;
+                    case 7:
+                        handler = &CPU::opEI;
+                        break;
+                }
+                break;
+            case 4:
+                switch(YYY)
+                {
+                    case 0:
+                    case 1:
+                    case 2:
+                    case 3:
+                        handler = &CPU::opCALLccnn<Accuracy>;
+                        break;
+                }
+                break;
+            case 5:
+                switch(Q)
+                {
+                    case 0:
+                        handler = &CPU::opPUSHrp2<Accuracy>;
+                        break;
+                    case 1:
+                        if(P == 0){handler = &CPU::opCALLnn<Accuracy>;}
+                        break;
+                }
+                break;
+            case 6:
+                switch(YYY)
+                {
+                    case 0:
+                    case 1:
+                        handler = &CPU::opADDAn<Accuracy>;
+                        break;
+                    case 2:
+                        handler = &CPU::opSUBAn<Accuracy>;
+                        break;
+                    case 3:
+                        handler = &CPU::opSBCAn<Accuracy>;
+                        break;
+                    case 4:
+                        handler = &CPU::opANDAn<Accuracy>;
+                        break;
+                    case 5:
+                        handler = &CPU::opXORAn<Accuracy>;
+                        break;
+                    case 6:
+                        handler = &CPU::opORAn<Accuracy>;
+                        break;
+                    case 7:
+                        handler = &CPU::opCPAn<Accuracy>;
+                        break;
+                }
+                break;
+            case 7:
+                handler = &CPU::opRST<Accuracy>;
+                break;
+        }
+        
+    }
+    return handler;
+}
+
+template<class Accuracy>
+CPU::OpHandler CPU::x0z0Decode()
+{
+    OpHandler handler{nullptr};
+    switch(YYY)
+    {
+        case 0:
+            handler = &CPU::opNOP;
+            break;
+        case 1:
+            handler = &CPU::opLDnnSP<Accuracy>;
+            break;
+        case 2:
+            handler = &CPU::opSTOP<Accuracy>;
+            break;
+        case 3:
+            handler = &CPU::opJRd<Accuracy>;
+            break;
+        case 4:
+        case 5:
+        case 6:
+        case 7:
+            handler = &CPU::opJRccd<Accuracy>;
+            break;
+    }
+    return handler;
+}
+template<class Accuracy>
+CPU::OpHandler CPU::x0z2Decode()
+{
+    OpHandler handler{nullptr};
+    if(Q == 0)
+    {
+        switch(P)
+        {
+            case 0:
+            case 1:
+                handler = &CPU::opLDrrA<Accuracy>;
+                break;
+            case 2:
+            case 3:
+                handler = &CPU::opLDHLIDA<Accuracy>;
+                break;  
+        }
+    }
+    else
+    {
+        switch(P)
+        {
+            case 0:
+            case 1:
+                handler = &CPU::opLDArr<Accuracy>;
+                break;
+            case 2:
+            case 3:
+                handler = &CPU::opLDAHLID<Accuracy>;
+                break;
+        }
+    }
+    return handler;
+}
+template<class Accuracy>
+CPU::OpHandler CPU::x0z7Decode()
+{
+    OpHandler handler{nullptr};
+    switch(YYY)
+    {
+        case 0:
+            handler = &CPU::opRLCA;
+            break;
+        case 1:
+            handler = &CPU::opRRCA;
+            break;
+        case 2:
+            handler = &CPU::opRLA;
+            break;
+        case 3:
+            handler = &CPU::opRRA;
+            break;
+        case 4:
+            handler = &CPU::opDAA;
+            break;
+        case 5:
+            handler = &CPU::opCPL;
+            break;
+        case 6:
+            handler = &CPU::opSCF;
+            break;
+        case 7:
+            handler = &CPU::opCCF;
+            break;
+    }
+    return handler;
+}
+template<class Accuracy>
+CPU::OpHandler CPU::x3z0Decode()
+{
+    OpHandler handler{nullptr};
+    switch(YYY)
+    {
+        case 0:
+        case 1:
+        case 2:
+        case 3:
+            handler = &CPU::opRETcc<Accuracy>;
+            break;
+        case 4:
+            handler = &CPU::opLDHnA<Accuracy>;
+            break;
+        case 5:
+            handler = &CPU::opADDSPd<Accuracy>;
+            break;
+        case 6:
+            handler = &CPU::opLDHAn<Accuracy>;
+            break;
+        case 7:
+            handler = &CPU::opLDHLSPId<Accuracy>;
+            break;
+    }
+    return handler;
+}
+template<class Accuracy>
+CPU::OpHandler CPU::x3z1Decode()
+{
+    OpHandler handler{nullptr};
+    if(Q == 0)
+    {
+        handler = &CPU::opPOPrp2<Accuracy>;
+    }
+    else
+    {  
+        switch(P)
+        {
+            case 0:
+                handler = &CPU::opRET<Accuracy>;
+                break;
+            case 1:
+                handler = &CPU::opRETI<Accuracy>;
+                break;
+            case 2:
+                handler = &CPU::opJPHL;
+                break;
+            case 3:
+                handler = &CPU::opLDSPHL;
+                break;
+        }
+    }
+    return handler;
+}
+template<class Accuracy>
+CPU::OpHandler CPU::x3z2Decode()
+{
+    OpHandler handler{nullptr};
+    switch(YYY)
+    {
+        case 0:
+        case 1:
+        case 2:
+        case 3:
+            handler = &CPU::opJPccnn<Accuracy>;
+            break;
+        case 4: 
+            handler = &CPU::opLDHCA<Accuracy>;
+            break;
+        case 5:
+            handler = &CPU::opLDnnA<Accuracy>;
+            break;
+        case 6:
+            handler = &CPU::opLDHAC<Accuracy>;
+            break;
+        case 7:
+            handler = &CPU::opLDAnn<Accuracy>;
+            break;
+    }
+    return handler;
+}
+
 /* OPCODE HELPERS */
 
 bool CPU::passedCondition(uint8_t condition)
 {
     bool passed{false};
-    
-    uint8_t zBit{Helper::getBit(registers[R_F], F_Z)};
-    uint8_t cBit{Helper::getBit(registers[R_F], F_C)};
-    
+
+    // only the flag asked for is worked out, the rest can stay lazy
     switch(condition)
     {
         
         case F_NO_Z:
-            passed = !zBit;
+            passed = !zeroFlag();
             break;
         case F_YES_Z:
-            passed = zBit;
+            passed = zeroFlag();
             break;
         case F_NO_C:
-            passed = !cBit;
+            passed = !carryFlag();
             break;
         case F_YES_C:
-            passed = cBit;
+            passed = carryFlag();
             break;
     }
 
     return passed;
 }
 
+/* FLAG HELPERS */
+/* With lazy flags an ALU op only records its operands, F is worked out when something reads it
+   (a condition, PUSH AF, DAA, ADC/SBC, or any op that only changes some of the flags) */
+
+void CPU::setLazyFlags(bool enabled)
+{
+    materializeFlags();
+    mLazyFlags = enabled;
+}
+
+/* Sets all flags for ADD/ADC */
+void CPU::add8Bit(uint8_t operand1, uint8_t operand2, bool carry)
+{
+    if(mLazyFlags)
+    {
+        mFlagOp = FLAG_OP_ADD;
+        mFlagOperand1 = operand1;
+        mFlagOperand2 = operand2;
+        mFlagCarry = carry;
+        return;
+    }
+
+    if((uint8_t)(operand1 + operand2 + carry) == 0)
+    {
+        Helper::setBit(registers[R_F], F_Z);
+    }
+    else
+    {
+        Helper::resetBit(registers[R_F], F_Z);
+    }
+
+    Helper::resetBit(registers[R_F], F_N);
+
+    if((operand1 & 0xF) + (operand2 & 0xF) + carry > 0x0F)
+    {
+        Helper::setBit(registers[R_F], F_H);
+    }
+    else
+    {
+        Helper::resetBit(registers[R_F], F_H);
+    }
+
+    if((uint16_t)operand1 + (uint16_t)operand2 + carry > 0xFF)
+    {
+        Helper::setBit(registers[R_F], F_C);
+    }
+    else
+    {
+        Helper::resetBit(registers[R_F], F_C);
+    }
+}
+
+/* Sets all flags for SUB/SBC/CP */
+void CPU::sub8Bit(uint8_t minuend, uint8_t subtrahend, bool carry)
+{
+    if(mLazyFlags)
+    {
+        mFlagOp = FLAG_OP_SUB;
+        mFlagOperand1 = minuend;
+        mFlagOperand2 = subtrahend;
+        mFlagCarry = carry;
+        return;
+    }
+
+    if((uint8_t)(minuend - subtrahend - carry) == 0)
+    {
+        Helper::setBit(registers[R_F], F_Z);
+    }
+    else
+    {
+        Helper::resetBit(registers[R_F], F_Z);
+    }
+
+    Helper::setBit(registers[R_F], F_N);
+
+    if((minuend & 0xF) - (subtrahend & 0xF) - carry < 0)
+    {
+        Helper::setBit(registers[R_F], F_H);
+    }
+    else
+    {
+        Helper::resetBit(registers[R_F], F_H);
+    }
+
+    if(minuend - subtrahend - carry < 0)
+    {
+        Helper::setBit(registers[R_F], F_C);
+    }
+    else
+    {
+        Helper::resetBit(registers[R_F], F_C);
+    }
+}
+
+/* Sets Z, N and H for INC, carry is left alone */
+void CPU::inc8Bit(uint8_t data)
+{
+    if(mLazyFlags)
+    {
+        mFlagCarry = carryFlag();
+        mFlagOp = FLAG_OP_INC;
+        mFlagOperand1 = data;
+        return;
+    }
+
+    if((uint8_t)(data + 1) == 0)
+    {
+        Helper::setBit(registers[R_F], F_Z);
+    }
+    else
+    {
+        Helper::resetBit(registers[R_F], F_Z);
+    }
+
+    Helper::resetBit(registers[R_F], F_N);
+
+    if((data & 0xF) == 0xF)
+    {
+        Helper::setBit(registers[R_F], F_H);
+    }
+    else
+    {
+        Helper::resetBit(registers[R_F], F_H);
+    }
+}
+
+/* Sets Z, N and H for DEC, carry is left alone */
+void CPU::dec8Bit(uint8_t data)
+{
+    if(mLazyFlags)
+    {
+        mFlagCarry = carryFlag();
+        mFlagOp = FLAG_OP_DEC;
+        mFlagOperand1 = data;
+        return;
+    }
+
+    if((uint8_t)(data - 1) == 0)
+    {
+        Helper::setBit(registers[R_F], F_Z);
+    }
+    else
+    {
+        Helper::resetBit(registers[R_F], F_Z);
+    }
+
+    Helper::setBit(registers[R_F], F_N);
+
+    if((data & 0xF) == 0x0)
+    {
+        Helper::setBit(registers[R_F], F_H);
+    }
+    else
+    {
+        Helper::resetBit(registers[R_F], F_H);
+    }
+}
+
+/* Sets all flags for AND (half carry set) and XOR/OR (half carry reset) */
+void CPU::logic8Bit(uint8_t result, bool halfCarry)
+{
+    if(mLazyFlags)
+    {
+        mFlagOp = halfCarry ? FLAG_OP_AND : FLAG_OP_OR;
+        mFlagOperand1 = result;
+        return;
+    }
+
+    if(result == 0)
+    {
+        Helper::setBit(registers[R_F], F_Z);
+    }
+    else
+    {
+        Helper::resetBit(registers[R_F], F_Z);
+    }
+
+    Helper::resetBit(registers[R_F], F_N);
+
+    if(halfCarry)
+    {
+        Helper::setBit(registers[R_F], F_H);
+    }
+    else
+    {
+        Helper::resetBit(registers[R_F], F_H);
+    }
+
+    Helper::resetBit(registers[R_F], F_C);
+}
+
+/* Write the recorded op's flags into F, using the same code as the eager core */
+void CPU::materializeFlags()
+{
+    if(mFlagOp == FLAG_OP_NONE)
+    {
+        return;
+    }
+
+    uint8_t flagOp{mFlagOp};
+    bool lazyFlags{mLazyFlags};
+    mFlagOp = FLAG_OP_NONE;
+    mLazyFlags = false;
+
+    switch(flagOp)
+    {
+        case FLAG_OP_ADD:
+            add8Bit(mFlagOperand1, mFlagOperand2, mFlagCarry);
+            break;
+        case FLAG_OP_SUB:
+            sub8Bit(mFlagOperand1, mFlagOperand2, mFlagCarry);
+            break;
+        case FLAG_OP_INC:
+        case FLAG_OP_DEC:
+            // F still holds whatever was there before the op that set the carry kept here
+            if(mFlagCarry)
+            {
+                Helper::setBit(registers[R_F], F_C);
+            }
+            else
+            {
+                Helper::resetBit(registers[R_F], F_C);
+            }
+
+            if(flagOp == FLAG_OP_INC)
+            {
+                inc8Bit(mFlagOperand1);
+            }
+            else
+            {
+                dec8Bit(mFlagOperand1);
+            }
+            break;
+        case FLAG_OP_AND:
+        case FLAG_OP_OR:
+            logic8Bit(mFlagOperand1, flagOp == FLAG_OP_AND);
+            break;
+    }
+
+    mLazyFlags = lazyFlags;
+}
+
+bool CPU::zeroFlag()
+{
+    switch(mFlagOp)
+    {
+        case FLAG_OP_ADD:
+            return (uint8_t)(mFlagOperand1 + mFlagOperand2 + mFlagCarry) == 0;
+        case FLAG_OP_SUB:
+            return (uint8_t)(mFlagOperand1 - mFlagOperand2 - mFlagCarry) == 0;
+        case FLAG_OP_INC:
+            return (uint8_t)(mFlagOperand1 + 1) == 0;
+        case FLAG_OP_DEC:
+            return (uint8_t)(mFlagOperand1 - 1) == 0;
+        case FLAG_OP_AND:
+        case FLAG_OP_OR:
+            return mFlagOperand1 == 0;
+    }
+    return Helper::getBit(registers[R_F], F_Z);
+}
+
+bool CPU::carryFlag()
+{
+    switch(mFlagOp)
+    {
+        case FLAG_OP_ADD:
+            return (uint16_t)mFlagOperand1 + (uint16_t)mFlagOperand2 + mFlagCarry > 0xFF;
+        case FLAG_OP_SUB:
+            return mFlagOperand1 - mFlagOperand2 - mFlagCarry < 0;
+        case FLAG_OP_INC:
+        case FLAG_OP_DEC:
+            return mFlagCarry;
+        case FLAG_OP_AND:
+        case FLAG_OP_OR:
+            return false;
+    }
+    return Helper::getBit(registers[R_F], F_C);
+}
+
 /* OPCODES BEGIN */
 /* Does nothing */
 void CPU::opNOP()
@@ -54,36 +719,36 @@ void CPU::opNOP()
 
 /* Store value in SP at address pointed to by immediate data
    Use little endian format (LSB at earlier address)*/
+template<class Accuracy>
 void CPU::opLDnnSP()
 {
     uint8_t upperBits{(sp & 0xFF00) >> 8};
     uint8_t lowerBits{sp & 0xFF};
-    uint8_t addressLSB{readMemory(pc)};
-    pc++;
-    uint8_t addressMSB{readMemory(pc)};
-    pc++;
+    uint8_t addressLSB{fetchOperand<Accuracy>()};
+    uint8_t addressMSB{fetchOperand<Accuracy>()};
     uint16_t fullAddress{Helper::concatChar(addressMSB, addressLSB)};
 
-    writeMemory(fullAddress, lowerBits);
+    writeMemory<Accuracy>(fullAddress, lowerBits);
     fullAddress++;
-    writeMemory(fullAddress, upperBits);
+    writeMemory<Accuracy>(fullAddress, upperBits);
 
     cycleCount += 5;
 }
 
 /* Enter low power mode, I found conflicting docs on whether this takes 1 or 0 m cycles
    Also double speed switch in GBC*/
+template<class Accuracy>
 void CPU::opSTOP()
 {
     // UNIMPLEMENTED
-    opHALT();
+    opHALT<Accuracy>();
 }
 
 /* Relative jump to 16 bit address, using signed 8 bit immediate */
+template<class Accuracy>
 void CPU::opJRd()
 {
-    int8_t offset{readMemory(pc)};
-    pc++;
+    int8_t offset{fetchOperand<Accuracy>()};
 
     pc = pc + offset;
 
@@ -91,11 +756,12 @@ void CPU::opJRd()
 }
 
 /* Same as above but only conditionally jumps */
+template<class Accuracy>
 void CPU::opJRccd()
 {
     if(passedCondition(YYY - 4))
     {
-        opJRd();
+        opJRd<Accuracy>();
     }
     else
     {
@@ -105,30 +771,20 @@ void CPU::opJRccd()
 }
 
 /* Loads immediate 16 bit data into 16 bit register */
+template<class Accuracy>
 void CPU::opLDrpnn()
 {
-    uint8_t immLSB{readMemory(pc)};
-    pc++;
-    uint8_t immMSB{readMemory(pc)};
-    pc++;
+    uint8_t immLSB{fetchOperand<Accuracy>()};
+    uint8_t immMSB{fetchOperand<Accuracy>()};
 
-    switch(P)
+    uint16_t immediate{Helper::concatChar(immMSB, immLSB)};
+    if(P == 3)
     {
-        case 0:
-            registers[1] = immLSB;
-            registers[0] = immMSB;
-            break;
-        case 1:
-            registers[3] = immLSB;
-            registers[2] = immMSB;
-            break;
-        case 2:
-            registers[5] = immLSB;
-            registers[4] = immMSB;
-            break;
-        case 3:
-            sp = Helper::concatChar(immMSB, immLSB);
-            break;
+        sp = immediate;
+    }
+    else
+    {
+        registers.pair(P) = immediate;
     }
 
     cycleCount += 3;
@@ -137,27 +793,12 @@ void CPU::opLDrpnn()
 /* Adds HL with some 16 bit register and store in HL */
 void CPU::opADDHLrp()
 {
-    uint16_t originalHL{Helper::concatChar(registers[R_H], registers[R_L])};
-    uint16_t fullShort{0};
-    switch(P)
-    {
-        case 0:
-            fullShort = Helper::concatChar(registers[R_B], registers[R_C]);
-            break;
-        case 1:
-            fullShort = Helper::concatChar(registers[R_D], registers[R_E]);
-            break;
-        case 2:
-            fullShort = Helper::concatChar(registers[R_H], registers[R_L]);
-            break;
-        case 3:
-            fullShort = sp;
-            break;
-    }
+    materializeFlags();
+    uint16_t originalHL{registers.pair(RP_HL)};
+    uint16_t fullShort{(P == 3) ? sp : registers.pair(P)};
     
     uint16_t sum{originalHL + fullShort};
-    registers[R_H] = Helper::hiBits(sum);
-    registers[R_L] = Helper::loBits(sum);
+    registers.pair(RP_HL) = sum;
 
     Helper::resetBit(registers[R_F], F_N);
 
@@ -186,33 +827,22 @@ void CPU::opADDHLrp()
 }
 
 /* Load value of register A into address stored in 16 bit register */
+template<class Accuracy>
 void CPU::opLDrrA()
 {
-    uint8_t MSB{0};
-    uint8_t LSB{0};
-    switch(P)
-    {
-        case 0:
-            MSB = registers[R_B];
-            LSB = registers[R_C];
-            break;
-        case 1:
-            MSB = registers[R_D];
-            LSB = registers[R_E];
-            break;
-    }
-    uint16_t addr{Helper::concatChar(MSB, LSB)};
-    writeMemory(addr, registers[R_A]);
+    // P is only ever 0 (BC) or 1 (DE) here
+    writeMemory<Accuracy>(registers.pair(P), registers[R_A]);
 
     cycleCount += 2;
 
 }
 
 /* Load value in register A into address pointed to by HL then increment/decrement HL */
+template<class Accuracy>
 void CPU::opLDHLIDA()
 {
-    uint16_t combinedHL{Helper::concatChar(registers[R_H], registers[R_L])};
-    writeMemory(combinedHL, registers[R_A]);
+    uint16_t& combinedHL{registers.pair(RP_HL)};
+    writeMemory<Accuracy>(combinedHL, registers[R_A]);
 
     switch(P)
     {
@@ -224,39 +854,24 @@ void CPU::opLDHLIDA()
             break;
     }
 
-    registers[R_H] = Helper::hiBits(combinedHL);
-    registers[R_L] = Helper::loBits(combinedHL);
     cycleCount += 2;
 }
 
 /* Load value from memory at address given by register value into A*/
+template<class Accuracy>
 void CPU::opLDArr()
 {
-    uint8_t MSB{0};
-    uint8_t LSB{0};
-    switch(P)
-    {
-        case 0:
-            MSB = registers[R_B];
-            LSB = registers[R_C];
-            break;
-        case 1:
-            MSB = registers[R_D];
-            LSB = registers[R_E];
-            break;
-    }
-
-    uint16_t addr{Helper::concatChar(MSB, LSB)};
-
-    registers[R_A] = readMemory(addr);
+    // P is only ever 0 (BC) or 1 (DE) here
+    registers[R_A] = readMemory<Accuracy>(registers.pair(P));
     cycleCount += 2;
 }
 
 /* Load value at address HL into register A then increment or decrement HL */
+template<class Accuracy>
 void CPU::opLDAHLID()
 {
-    uint16_t combinedHL{Helper::concatChar(registers[R_H], registers[R_L])}; 
-    registers[R_A] = readMemory(combinedHL);
+    uint16_t& combinedHL{registers.pair(RP_HL)};
+    registers[R_A] = readMemory<Accuracy>(combinedHL);
 
     switch(P)
     {
@@ -268,64 +883,26 @@ void CPU::opLDAHLID()
             break;
     }
 
-    registers[R_H] = Helper::hiBits(combinedHL);
-    registers[R_L] = Helper::loBits(combinedHL);
     cycleCount += 2;  
 }
 
 /* Increments or decrements 16 bit register, no flags set */
 void CPU::opINCDECrp()
 {
-    uint16_t concatenated{0};
-    bool onSP{false};
-
-    uint8_t hiReg{0};
-    uint8_t loReg{0};
-    int8_t operand{0};
-
-    switch(P)
-    {
-        case 0:
-            hiReg = R_B;
-            loReg = R_C;
-            break;
-        case 1:
-            hiReg = R_D;
-            loReg = R_E;
-            break;
-        case 2:
-            hiReg = R_H;
-            loReg = R_L;
-            break;
-        case 3:
-            onSP = true;
-            break;
-    }
+    uint16_t& regPair{(P == 3) ? sp : registers.pair(P)};
     switch(Q)
     {
         case 0: // incrementing
-            operand = 1;
+            regPair++;
             break;
         case 1: // decrementing
-            operand = -1;
+            regPair--;
             break;
     }
-    
-    if(!onSP)
-    {
-        concatenated = Helper::concatChar(registers[hiReg], registers[loReg]);
-        concatenated += operand;
-
-        registers[hiReg] = Helper::hiBits(concatenated);
-        registers[loReg] = Helper::loBits(concatenated);
-    }
-    else
-    {
-        sp += operand;
-    }
     cycleCount += 2;
 }
 
+template<class Accuracy>
 void CPU::opINCDECr()
 {
     int8_t operand{0};
@@ -344,10 +921,10 @@ void CPU::opINCDECr()
     if(YYY == R_HL)
     {
         cycleCount += 2;
-        uint16_t addr{Helper::concatChar(registers[R_H], registers[R_L])};
-        originalVal = readMemory(addr);
+        uint16_t addr{registers.pair(RP_HL)};
+        originalVal = readMemory<Accuracy>(addr);
         newVal = originalVal + operand;
-        writeMemory(addr, newVal);
+        writeMemory<Accuracy>(addr, newVal);
     }
     else
     {
@@ -359,74 +936,40 @@ void CPU::opINCDECr()
 
     if(operand > 0)
     {
-        if(newVal == 0)
-        {
-            Helper::setBit(registers[R_F], F_Z);
-        }
-        else
-        {
-            Helper::resetBit(registers[R_F], F_Z);
-        }
-
-	    Helper::resetBit(registers[R_F], F_N);
-
-        if((originalVal & 0xF) == 0xF)
-        {
-            Helper::setBit(registers[R_F], F_H);
-        }
-        else
-        {
-            Helper::resetBit(registers[R_F], F_H);
-        }
+        inc8Bit(originalVal);
     }
     else
-    {      
-        if(newVal == 0)
-        {
-            Helper::setBit(registers[R_F], F_Z);
-        }
-        else
-        {
-            Helper::resetBit(registers[R_F], F_Z);
-        }
-
-	    Helper::setBit(registers[R_F], F_N);
-
-        if((originalVal & 0xF) == 0x0)
-        {
-            Helper::setBit(registers[R_F], F_H);
-        }
-        else
-        {
-            Helper::resetBit(registers[R_F], F_H);
-        }
+    {
+        dec8Bit(originalVal);
     }
 
     cycleCount += 1;
 }
 
 /* Load immediate data into register */
+template<class Accuracy>
 void CPU::opLDrn()
 {
     uint8_t regIndex{YYY};
     if(YYY == R_HL)
     {
         cycleCount += 1;
-        uint16_t addr{Helper::concatChar(registers[R_H], registers[R_L])};
-        uint8_t newVal = readMemory(pc);
-        writeMemory(addr, newVal);
+        uint16_t addr{registers.pair(RP_HL)};
+        uint8_t newVal{fetchOperand<Accuracy>()};
+        writeMemory<Accuracy>(addr, newVal);
     }
     else
     {
-        registers[regIndex] = readMemory(pc);
+        registers[regIndex] = fetchOperand<Accuracy>();
     }
-    pc++;
 
     cycleCount += 2;
 }
 
 void CPU::opRLCA()
 {
+    materializeFlags();
+
     uint8_t MSB{Helper::getBit(registers[R_A], 7)};
 
     registers[R_A] = registers[R_A] << 1;
@@ -451,6 +994,8 @@ void CPU::opRLCA()
 
 void CPU::opRRCA()
 {
+    materializeFlags();
+
     uint8_t LSB{Helper::getBit(registers[R_A], 0)};
 
     registers[R_A] = registers[R_A] >> 1;
@@ -475,6 +1020,8 @@ void CPU::opRRCA()
 
 void CPU::opRLA()
 {
+    materializeFlags();
+
     uint8_t carryIn{Helper::getBit(registers[R_F], F_C)};
     uint8_t MSB{Helper::getBit(registers[R_A], 7)};
 
@@ -503,6 +1050,8 @@ void CPU::opRLA()
 
 void CPU::opRRA()
 {
+    materializeFlags();
+
     uint8_t carryIn{Helper::getBit(registers[R_F], F_C)};
     uint8_t LSB{Helper::getBit(registers[R_A], 0)};
 
@@ -532,6 +1081,8 @@ void CPU::opRRA()
 /* Convert accumulator to BCD equivalent */
 void CPU::opDAA()
 {
+    materializeFlags();
+
     // max value of BCD is 1001 1001 (99)
     // we use an "error" offset to account for how 1001 is the max (as opposed to 1111)
 
@@ -549,6 +1100,8 @@ void CPU::opDAA()
 /* Complements the accumulator */
 void CPU::opCPL()
 {
+    materializeFlags();
+
     registers[R_A] = ~registers[R_A];
 
     Helper::setBit(registers[R_F], F_N);
@@ -560,6 +1113,8 @@ void CPU::opCPL()
 /* Sets carry flag and resets some other ones */
 void CPU::opSCF()
 {
+    materializeFlags();
+
     Helper::resetBit(registers[R_F], F_N);
     Helper::resetBit(registers[R_F], F_H);
     Helper::setBit(registers[R_F], F_C);
@@ -569,6 +1124,8 @@ void CPU::opSCF()
 /* Complement the carry flag */
 void CPU::opCCF()
 {
+    materializeFlags();
+
     registers[R_F] ^= (0b1 << F_C);
 
     Helper::resetBit(registers[R_F], F_N);
@@ -578,11 +1135,12 @@ void CPU::opCCF()
 }
 
 // Conflicting docs on whether this is 0 or 1 cycle
-// Halt bug not implemented
+// The halt bug is only done by the accurate core
+template<class Accuracy>
 void CPU::opHALT()
 {
     isHalted = true;
-    if((memMap[0xFF0F] & memMap[0xFFFF]) != 0)
+    if(mPendingInterrupts != 0)
     {
         if(IMEflag)
         {
@@ -592,13 +1150,18 @@ void CPU::opHALT()
         else
         {
             isHalted = false;
-            // also halt bug happens but its not implemented
+            // also halt bug happens, the next fetch doesn't move pc (see executeInstruction)
+            if constexpr(Accuracy::HALT_BUG)
+            {
+                mHaltBug = true;
+            }
         }
     }
     //cycleCount += 1;
 }
 
 /* Load second registers into first register */
+template<class Accuracy>
 void CPU::opLDrr()
 {
     if((YYY != R_HL) && (ZZZ != R_HL))
@@ -612,13 +1175,13 @@ void CPU::opLDrr()
         // Load into memory location pointed to by HL
         if(YYY == R_HL) // YYY == R_HL and ZZZ == R_HL won't both be true ever in this opcode
         {
-            writeMemory(Helper::concatChar(registers[R_H], registers[R_L]), registers[ZZZ]);
+            writeMemory<Accuracy>(registers.pair(RP_HL), registers[ZZZ]);
         }
 
         // Load memory at HL into register
         else
         {
-            registers[YYY] = readMemory(Helper::concatChar(registers[R_H], registers[R_L]));
+            registers[YYY] = readMemory<Accuracy>(registers.pair(RP_HL));
         }
         
         cycleCount += 2;
@@ -627,6 +1190,7 @@ void CPU::opLDrr()
 }
 
 /* Add register into A (also covers ADC) */
+template<class Accuracy>
 void CPU::opADDAr()
 {
     uint8_t cycleTime{1};
@@ -636,7 +1200,7 @@ void CPU::opADDAr()
     if(ZZZ == 6)
     {
         cycleTime = 2;
-        operand = readMemory(Helper::concatChar(registers[R_H], registers[R_L]));
+        operand = readMemory<Accuracy>(registers.pair(RP_HL));
     }
     else
     {
@@ -645,46 +1209,16 @@ void CPU::opADDAr()
 
     if(YYY == 1) // add carry bit to operand
     {
-        if(Helper::getBit(registers[R_F], F_C) == 1)
-        {
-            carry = true;
-        }
+        carry = carryFlag();
     }
 
     registers[R_A] += operand + carry;
+    add8Bit(regVal, operand, carry);
 
-    Helper::resetBit(registers[R_F], F_N);
-
-    if((regVal & 0xF) + (operand & 0xF) + (uint8_t)carry > 0x0F)
-    {
-        Helper::setBit(registers[R_F], F_H);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_H);
-    }
-
-    if((uint16_t)regVal + (uint16_t)operand + (uint8_t)carry > 0xFF)
-    {
-        Helper::setBit(registers[R_F], F_C);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_C);
-    }
-
-    if((uint8_t)(regVal + operand + (uint8_t)carry) == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-
-    }
     cycleCount += cycleTime;
 }
 
+template<class Accuracy>
 void CPU::opSUBAr()
 {
     uint8_t cycleTime{1};
@@ -694,7 +1228,7 @@ void CPU::opSUBAr()
     if(ZZZ == 6)
     {
         cycleTime = 2;
-        operand = readMemory(Helper::concatChar(registers[R_H], registers[R_L]));
+        operand = readMemory<Accuracy>(registers.pair(RP_HL));
     }
     else
     {
@@ -702,109 +1236,42 @@ void CPU::opSUBAr()
     }
 
     registers[R_A] -= operand;
-
-    if (regVal - operand == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-    }
-
-    Helper::setBit(registers[R_F], F_N);
-
-    uint8_t minuNib{(regVal & 0b1111)};
-    uint8_t subtraNib{(operand & 0b1111)};
-
-    if(subtraNib > minuNib)
-    {
-        Helper::setBit(registers[R_F], F_H);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_H);
-    }
-
-    if((operand) > regVal)
-    {
-        Helper::setBit(registers[R_F], F_C);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_C);
-    }
+    sub8Bit(regVal, operand, false);
     
     cycleCount += cycleTime;
 }
 
+template<class Accuracy>
 void CPU::opSBCAr()
 {
     uint8_t regVal{0};
     if(ZZZ == 6)
     {
-        regVal = readMemory(Helper::concatChar(registers[R_H], registers[R_L]));
+        regVal = readMemory<Accuracy>(registers.pair(RP_HL));
         cycleCount += 1;
     }
     else
     {
-        regVal = registers[ZZZ];
-    }
-    int16_t operand = (int16_t)regVal & 0xFF;
-    int16_t aReg = (int16_t)registers[R_A] & 0xFF;
-    int aTemp = aReg;
-
-    aTemp -= operand;
-
-    if (Helper::getBit(registers[R_F], F_C))
-    {
-        aTemp -= 1;
-    }
-
-    Helper::setBit(registers[R_F], F_N);
-
-    if(aTemp < 0)
-    {
-        Helper::setBit(registers[R_F], F_C);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_C);
-    }
-
-    aTemp &= 0xFF;
-
-    if(aTemp == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-    }
-
-    if (((aTemp ^ operand ^ aReg) & 0x10) == 0x10)
-    {
-        Helper::setBit(registers[R_F], F_H);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_H);
+        regVal = registers[ZZZ];
     }
+    uint8_t aReg{registers[R_A]};
+    bool carry{carryFlag()};
+
+    registers[R_A] = aReg - regVal - carry;
+    sub8Bit(aReg, regVal, carry);
 
-    registers[R_A] = aTemp;
     cycleCount += 1;
 }
             
+template<class Accuracy>
 void CPU::opANDAr()
 {
     uint8_t cycleTime{1};
     uint8_t operand{0};
-
     if(ZZZ == 6)
     {
         cycleTime = 2;
-        operand = readMemory(Helper::concatChar(registers[R_H], registers[R_L]));
+        operand = readMemory<Accuracy>(registers.pair(RP_HL));
     }
     else
     {
@@ -812,23 +1279,12 @@ void CPU::opANDAr()
     }
 
     registers[R_A] &= operand;
-    if(registers[R_A] == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-    }
-
-    Helper::resetBit(registers[R_F], F_N);
-    Helper::setBit(registers[R_F], F_H);
-    Helper::resetBit(registers[R_F], F_C);
+    logic8Bit(registers[R_A], true);
 
     cycleCount += cycleTime;
-
 }
             
+template<class Accuracy>
 void CPU::opXORAr()
 {
     uint8_t cycleTime{1};
@@ -836,7 +1292,7 @@ void CPU::opXORAr()
     if(ZZZ == 6)
     {
         cycleTime = 2;
-        operand = readMemory(Helper::concatChar(registers[R_H], registers[R_L]));
+        operand = readMemory<Accuracy>(registers.pair(RP_HL));
     }
     else
     {
@@ -844,23 +1300,12 @@ void CPU::opXORAr()
     }
 
     registers[R_A] ^= operand;
-
-    if(registers[R_A] == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-    }
-
-    Helper::resetBit(registers[R_F], F_N);
-    Helper::resetBit(registers[R_F], F_H);
-    Helper::resetBit(registers[R_F], F_C);
+    logic8Bit(registers[R_A], false);
 
     cycleCount += cycleTime;
 }
             
+template<class Accuracy>
 void CPU::opORAr()
 {
     uint8_t cycleTime{1};
@@ -868,7 +1313,7 @@ void CPU::opORAr()
     if(ZZZ == 6)
     {
         cycleTime = 2;
-        operand = readMemory(Helper::concatChar(registers[R_H], registers[R_L]));
+        operand = readMemory<Accuracy>(registers.pair(RP_HL));
     }
     else
     {
@@ -876,23 +1321,12 @@ void CPU::opORAr()
     }
 
     registers[R_A] |= operand;
-
-    if(registers[R_A] == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-    }
-
-    Helper::resetBit(registers[R_F], F_N);
-    Helper::resetBit(registers[R_F], F_H);
-    Helper::resetBit(registers[R_F], F_C);
+    logic8Bit(registers[R_A], false);
 
     cycleCount += cycleTime;
 }
             
+template<class Accuracy>
 void CPU::opCPAr()
 {
     uint8_t cycleTime{1};
@@ -900,53 +1334,25 @@ void CPU::opCPAr()
     if(ZZZ == 6)
     {
         cycleTime = 2;
-        operand = readMemory(Helper::concatChar(registers[R_H], registers[R_L]));
+        operand = readMemory<Accuracy>(registers.pair(RP_HL));
     }
     else
     {
         operand = registers[ZZZ];
     }
 
-    if ((registers[R_A] - operand) == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-    }
-
-    Helper::setBit(registers[R_F], F_N);
-
-    uint8_t minuNib{(registers[R_A] & 0b1111)};
-    uint8_t subtraNib{(operand & 0b1111)};
-
-    if(subtraNib > minuNib)
-    {
-        Helper::setBit(registers[R_F], F_H);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_H);
-    }
-
-    if(operand > registers[R_A])
-    {
-        Helper::setBit(registers[R_F], F_C);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_C);
-    }
+    // same as SUB but A is left alone
+    sub8Bit(registers[R_A], operand, false);
 
     cycleCount += cycleTime;
 }
 
+template<class Accuracy>
 void CPU::opRETcc()
 {
     if(passedCondition(YYY))
     {
-        opRET();
+        opRET<Accuracy>();
         cycleCount += 1;
     }
     else
@@ -955,19 +1361,21 @@ void CPU::opRETcc()
     }
 }
 
+template<class Accuracy>
 void CPU::opLDHnA()
 {
-    uint16_t addr{Helper::concatChar(0xFF, readMemory(pc))};
-    pc++;
+    uint16_t addr{Helper::concatChar(0xFF, fetchOperand<Accuracy>())};
 
-    writeMemory(addr, registers[R_A]);
+    writeMemory<Accuracy>(addr, registers[R_A]);
     cycleCount += 3;
 }
 
+template<class Accuracy>
 void CPU::opADDSPd()
 {
-    int8_t operand{0xFF & readMemory(pc)};
-    pc++;
+    materializeFlags();
+
+    int8_t operand{0xFF & fetchOperand<Accuracy>()};
     uint8_t originalSP{sp & 0xFF};
 
     sp += operand;
@@ -994,23 +1402,23 @@ void CPU::opADDSPd()
     cycleCount += 4;
 }
 
+template<class Accuracy>
 void CPU::opLDHAn()
 {
-    uint16_t addr{0xFF00 + readMemory(pc)};
-    pc++;
-    registers[R_A] = readMemory(addr);
+    uint16_t addr{0xFF00 + fetchOperand<Accuracy>()};
+    registers[R_A] = readMemory<Accuracy>(addr);
 
     cycleCount += 3;
 }
 
+template<class Accuracy>
 void CPU::opLDHLSPId()
 {
-    int8_t operand{readMemory(pc)};
-    pc++;
+    materializeFlags();
+    int8_t operand{fetchOperand<Accuracy>()};
     uint16_t sum{sp + operand};
     
-    registers[R_H] = Helper::hiBits(sum);
-    registers[R_L] = Helper::loBits(sum);
+    registers.pair(RP_HL) = sum;
 
     if((sum & 0xFF) < (sp & 0xFF))
     {
@@ -1037,52 +1445,38 @@ void CPU::opLDHLSPId()
     cycleCount += 3;
 }
 
+template<class Accuracy>
 void CPU::opPOPrp2()
 {
-    uint8_t hiReg{0};
-    uint8_t loReg{0};
-    switch(P)
-    {
-        case 0: // BC
-            hiReg = R_B;
-            loReg = R_C;
-            break;
-        case 1: // DE
-            hiReg = R_D;
-            loReg = R_E;
-            break;
-        case 2: // HL
-            hiReg = R_H;
-            loReg = R_L;
-            break;
-        case 3: // AF
-            hiReg = R_A;
-            loReg = R_F;
-            break;
-    }
-
-    registers[loReg] = readMemory(sp);
+    uint8_t lower{readMemory<Accuracy>(sp)};
     sp++;
-    registers[hiReg] = readMemory(sp);
+    uint8_t upper{readMemory<Accuracy>(sp)};
     sp++;
 
-    if(P == 3)
+    if(P == 3) // AF
+    {
+        registers[R_F] = lower & 0xF0;
+        registers[R_A] = upper;
+        mFlagOp = FLAG_OP_NONE;
+    }
+    else
     {
-        registers[loReg] &= 0xF0;
+        registers.pair(P) = Helper::concatChar(upper, lower);
     }
 
     cycleCount += 3;
 }
 
+template<class Accuracy>
 void CPU::opRET()
 {
     uint8_t lower{0};
     uint8_t upper{0};
 
-    lower = readMemory(sp);
+    lower = readMemory<Accuracy>(sp);
     sp++;
 
-    upper = readMemory(sp);
+    upper = readMemory<Accuracy>(sp);
     sp++;
 
     pc = Helper::concatChar(upper, lower);
@@ -1090,32 +1484,34 @@ void CPU::opRET()
     cycleCount += 4;
 }
 
+template<class Accuracy>
 void CPU::opRETI()
 {
     opEI();
     cycleCount--;
-    opRET();
+    opRET<Accuracy>();
 }
 
 void CPU::opJPHL()
 {
-    pc = Helper::concatChar(registers[R_H], registers[R_L]);
+    pc = registers.pair(RP_HL);
     cycleCount += 1;
 }
 
 void CPU::opLDSPHL()
 {
 
-    sp = Helper::concatChar(registers[R_H], registers[R_L]);
+    sp = registers.pair(RP_HL);
     cycleCount += 2;
 }
 
+template<class Accuracy>
 void CPU::opJPccnn()
 {
 
     if(passedCondition(YYY))
     {
-        opJPnn();
+        opJPnn<Accuracy>();
     }
     else
     {
@@ -1124,51 +1520,50 @@ void CPU::opJPccnn()
     }
 }
 
+template<class Accuracy>
 void CPU::opLDHCA()
 {
-    writeMemory(Helper::concatChar(0xFF, registers[R_C]), registers[R_A]);
+    writeMemory<Accuracy>(Helper::concatChar(0xFF, registers[R_C]), registers[R_A]);
     cycleCount += 2;
 }
 
+template<class Accuracy>
 void CPU::opLDnnA()
 {
-    uint8_t lower{readMemory(pc)};
-    pc++;
-    uint8_t upper{readMemory(pc)};
-    pc++;
+    uint8_t lower{fetchOperand<Accuracy>()};
+    uint8_t upper{fetchOperand<Accuracy>()};
 
-    writeMemory(Helper::concatChar(upper, lower), registers[R_A]);
+    writeMemory<Accuracy>(Helper::concatChar(upper, lower), registers[R_A]);
     cycleCount += 4;
 }
 
+template<class Accuracy>
 void CPU::opLDHAC()
 {
     uint16_t addr{Helper::concatChar(0xFF, registers[R_C])};
 
-    registers[R_A] = readMemory(addr);
+    registers[R_A] = readMemory<Accuracy>(addr);
 
     cycleCount += 2;
 }
 
+template<class Accuracy>
 void CPU::opLDAnn()
 {
-    uint8_t lower{readMemory(pc)};
-    pc++;
-    uint8_t upper{readMemory(pc)};
-    pc++;
+    uint8_t lower{fetchOperand<Accuracy>()};
+    uint8_t upper{fetchOperand<Accuracy>()};
     uint16_t addr{Helper::concatChar(upper, lower)};
 
-    registers[R_A] = readMemory(addr);
+    registers[R_A] = readMemory<Accuracy>(addr);
 
     cycleCount += 4;
 }
 
+template<class Accuracy>
 void CPU::opJPnn()
 {
-    uint8_t lower{readMemory(pc)};
-    pc++;
-    uint8_t upper{readMemory(pc)};
-    pc++;
+    uint8_t lower{fetchOperand<Accuracy>()};
+    uint8_t upper{fetchOperand<Accuracy>()};
 
     pc = Helper::concatChar(upper, lower);
     
@@ -1188,11 +1583,12 @@ void CPU::opEI()
     cycleCount += 1;
 }
 
+template<class Accuracy>
 void CPU::opCALLccnn()
 {
     if(passedCondition(YYY))
     {
-        opCALLnn();
+        opCALLnn<Accuracy>();
     }
     else
     {
@@ -1202,58 +1598,50 @@ void CPU::opCALLccnn()
 }
 
 /* Put value from register onto the stack */
+template<class Accuracy>
 void CPU::opPUSHrp2()
 {
-    uint8_t hiReg{0};
-    uint8_t loReg{0};
+    uint8_t upper{0};
+    uint8_t lower{0};
 
-    switch(P)
+    if(P == 3) // AF
     {
-        case 0: // BC
-            hiReg = R_B;
-            loReg = R_C;
-            break;
-        case 1: // DE
-            hiReg = R_D;
-            loReg = R_E;
-            break;
-        case 2: // HL
-            hiReg = R_H;
-            loReg = R_L;
-            break;
-        case 3: // AF
-            hiReg = R_A;
-            loReg = R_F;
-            break;
+        materializeFlags();
+        upper = registers[R_A];
+        lower = registers[R_F];
+    }
+    else
+    {
+        upper = Helper::hiBits(registers.pair(P));
+        lower = Helper::loBits(registers.pair(P));
     }
 
     sp--;
-    writeMemory(sp, registers[hiReg]);
+    writeMemory<Accuracy>(sp, upper);
 
     sp--;
-    writeMemory(sp, registers[loReg]);
+    writeMemory<Accuracy>(sp, lower);
 
     cycleCount += 4;
 }
 
 /* Put instruction after CALL onto stack, then jump to n16 (n16 value stored first)*/
+template<class Accuracy>
 void CPU::opCALLnn()
 {
 
-    uint8_t lowJP{readMemory(pc)};
-    pc++;
-    uint8_t highJP{readMemory(pc)};
-    pc++;
+    uint8_t lowJP{fetchOperand<Accuracy>()};
+    uint8_t highJP{fetchOperand<Accuracy>()};
 
     // move sp keeping little endianness in mind
     sp--;
     
     // write high to sp location
-    writeMemory(sp, Helper::hiBits(pc));
+    writeMemory<Accuracy>(sp, Helper::hiBits(pc));
 
     sp--;
     // write low
-    writeMemory(sp, Helper::loBits(pc));
+    writeMemory<Accuracy>(sp, Helper::loBits(pc));
 
     pc = Helper::concatChar(highJP, lowJP);
 
@@ -1262,255 +1650,94 @@ void CPU::opCALLnn()
 }
 
 /* Add immediate into A (also covers ADC) */
+template<class Accuracy>
 void CPU::opADDAn()
 {
-    uint8_t operand{readMemory(pc)};
-    pc++;
+    uint8_t operand{fetchOperand<Accuracy>()};
     uint8_t regVal{registers[R_A]};
     bool carry{false};
 
     if(YYY == 1) // add carry bit to operand
     {
-        if(Helper::getBit(registers[R_F], F_C) == 1)
-        {
-            carry = true;
-        }
+        carry = carryFlag();
     }
 
     registers[R_A] += operand + carry;
+    add8Bit(regVal, operand, carry);
 
-    if((regVal & 0xF) + (operand & 0xF) + (uint8_t)carry > 0x0F)
-    {
-        Helper::setBit(registers[R_F], F_H);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_H);
-    }
-
-    if((uint16_t)regVal + (uint16_t)operand + (uint8_t)carry > 0xFF)
-    {
-        Helper::setBit(registers[R_F], F_C);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_C);
-    }
-
-    if((uint8_t)(regVal + operand + (uint8_t)carry) == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-
-    }
-    Helper::resetBit(registers[R_F], F_N);
     cycleCount += 2;
 }
 
+template<class Accuracy>
 void CPU::opSUBAn()
 {
-    uint8_t operand{readMemory(pc)};
-    pc++;
+    uint8_t operand{fetchOperand<Accuracy>()};
     uint8_t regVal{registers[R_A]};
 
     registers[R_A] -= operand;
+    sub8Bit(regVal, operand, false);
 
-    if ((regVal - operand) == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-    }
-
-    Helper::setBit(registers[R_F], F_N);
-
-    uint8_t minuNib{(regVal & 0b1111)};
-    uint8_t subtraNib{(operand & 0b1111)};
-
-    if(subtraNib > minuNib)
-    {
-        Helper::setBit(registers[R_F], F_H);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_H);
-    }
-
-    if(operand > regVal)
-    {
-        Helper::setBit(registers[R_F], F_C);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_C);
-    }
     cycleCount += 2;
-    
 }
 
+template<class Accuracy>
 void CPU::opSBCAn()
 {
-    int16_t operand = (int16_t)readMemory(pc) & 0xFF;
-    pc++;
-    int16_t aReg = (int16_t)registers[R_A] & 0xFF;
-    int aTemp = aReg;
-
-    aTemp -= operand;
-
-    if (Helper::getBit(registers[R_F], F_C))
-    {
-        aTemp -= 1;
-    }
-
-    Helper::setBit(registers[R_F], F_N);
-
-    if(aTemp < 0)
-    {
-        Helper::setBit(registers[R_F], F_C);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_C);
-    }
-
-    aTemp &= 0xFF;
-
-    if(aTemp == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-    }
+    uint8_t operand{fetchOperand<Accuracy>()};
+    uint8_t aReg{registers[R_A]};
+    bool carry{carryFlag()};
 
-    if (((aTemp ^ operand ^ aReg) & 0x10) == 0x10)
-    {
-        Helper::setBit(registers[R_F], F_H);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_H);
-    }
+    registers[R_A] = aReg - operand - carry;
+    sub8Bit(aReg, operand, carry);
 
-    registers[R_A] = aTemp;
     cycleCount += 2;
 }
             
+template<class Accuracy>
 void CPU::opANDAn()
 {
-    uint8_t operand{readMemory(pc)};
-    pc++;
+    uint8_t operand{fetchOperand<Accuracy>()};
 
     registers[R_A] &= operand;
-    if(registers[R_A] == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-    }
-
-    Helper::resetBit(registers[R_F], F_N);
-    Helper::setBit(registers[R_F], F_H);
-    Helper::resetBit(registers[R_F], F_C);
+    logic8Bit(registers[R_A], true);
 
     cycleCount += 2;
-
 }
             
+template<class Accuracy>
 void CPU::opXORAn()
 {
-    uint8_t operand{readMemory(pc)};
-    pc++;
+    uint8_t operand{fetchOperand<Accuracy>()};
 
     registers[R_A] ^= operand;
-
-    if(registers[R_A] == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-    }
-
-    Helper::resetBit(registers[R_F], F_N);
-    Helper::resetBit(registers[R_F], F_H);
-    Helper::resetBit(registers[R_F], F_C);
+    logic8Bit(registers[R_A], false);
 
     cycleCount += 2;
 }
             
+template<class Accuracy>
 void CPU::opORAn()
 {
-    uint8_t operand{readMemory(pc)};
-    pc++;
+    uint8_t operand{fetchOperand<Accuracy>()};
 
     registers[R_A] |= operand;
-
-    if(registers[R_A] == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-    }
-
-    Helper::resetBit(registers[R_F], F_N);
-    Helper::resetBit(registers[R_F], F_H);
-    Helper::resetBit(registers[R_F], F_C);
+    logic8Bit(registers[R_A], false);
 
     cycleCount += 2;
 }
             
+template<class Accuracy>
 void CPU::opCPAn()
 {
-    uint8_t operand{readMemory(pc)};
-    pc++;
-
-    if((registers[R_A] - operand) == 0)
-    {
-        Helper::setBit(registers[R_F], F_Z);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_Z);
-    }
-
-    Helper::setBit(registers[R_F], F_N);
-
-    uint8_t minuNib{(registers[R_A] & 0b1111)};
-    uint8_t subtraNib{(operand & 0b1111)};
-
-    if(subtraNib > minuNib)
-    {
-        Helper::setBit(registers[R_F], F_H);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_H);
-    }
+    uint8_t operand{fetchOperand<Accuracy>()};
 
-    if(operand > registers[R_A])
-    {
-        Helper::setBit(registers[R_F], F_C);
-    }
-    else
-    {
-        Helper::resetBit(registers[R_F], F_C);
-    }
+    // same as SUB but A is left alone
+    sub8Bit(registers[R_A], operand, false);
 
     cycleCount += 2;
 }
 
+template<class Accuracy>
 void CPU::opRST()
 {
 
@@ -1518,11 +1745,11 @@ void CPU::opRST()
     sp--;
     
     // write high to sp location
-    writeMemory(sp, Helper::hiBits(pc));
+    writeMemory<Accuracy>(sp, Helper::hiBits(pc));
 
     sp--;
     // write low
-    writeMemory(sp, Helper::loBits(pc));
+    writeMemory<Accuracy>(sp, Helper::loBits(pc));
 
     pc = Helper::concatChar(0x00, YYY*8);
 
@@ -1532,8 +1759,11 @@ void CPU::opRST()
 
 /* BEGIN CB PREFIX OPCODES */
 
+template<class Accuracy>
 void CPU::opROT()
 {
+    materializeFlags();
+
     uint8_t cycleTime{2};
     uint8_t regIndex{ZZZ};
     uint8_t data{0};
@@ -1544,7 +1774,7 @@ void CPU::opROT()
         // All rotational opcodes take an additional 2 m-cycles
         cycleTime += 2;
 
-        data = readMemory(Helper::concatChar(registers[R_H], registers[R_L]));
+        data = readMemory<Accuracy>(registers.pair(RP_HL));
     }
     else
     {
@@ -1582,7 +1812,7 @@ void CPU::opROT()
 
     if(regIndex == R_HL)
     {
-        writeMemory(Helper::concatChar(registers[R_H], registers[R_L]), returnValue);
+        writeMemory<Accuracy>(registers.pair(RP_HL), returnValue);
     }
     else
     {
@@ -1752,8 +1982,11 @@ uint8_t CPU::opSRLr(uint8_t data)
     return data;
 }
 
+template<class Accuracy>
 void CPU::opBIT()
 {
+    materializeFlags();
+
     uint8_t bitPosition{YYY};
     uint8_t regIndex{ZZZ};
     uint8_t data{0};
@@ -1761,7 +1994,7 @@ void CPU::opBIT()
 
     if(regIndex == 6)
     {
-        data = readMemory(Helper::concatChar(registers[R_H], registers[R_L]));
+        data = readMemory<Accuracy>(registers.pair(RP_HL));
         cycleTime += 1;
     }
     else
@@ -1784,6 +2017,7 @@ void CPU::opBIT()
     cycleCount += cycleTime;
 }
 
+template<class Accuracy>
 void CPU::opRES()
 {
     uint8_t bitPosition{YYY};
@@ -1793,9 +2027,9 @@ void CPU::opRES()
 
     if(regIndex == 6)
     {
-        data = readMemory(Helper::concatChar(registers[R_H], registers[R_L]));
+        data = readMemory<Accuracy>(registers.pair(RP_HL));
         Helper::resetBit(data, bitPosition);
-        writeMemory(Helper::concatChar(registers[R_H], registers[R_L]), data);
+        writeMemory<Accuracy>(registers.pair(RP_HL), data);
         cycleTime += 2;
     }
     else
@@ -1807,6 +2041,7 @@ void CPU::opRES()
     cycleCount = cycleTime;
 }
 
+template<class Accuracy>
 void CPU::opSET()
 {
     uint8_t bitPosition{YYY};
@@ -1816,9 +2051,9 @@ void CPU::opSET()
 
     if(regIndex == 6)
     {
-        data = readMemory(Helper::concatChar(registers[R_H], registers[R_L]));
+        data = readMemory<Accuracy>(registers.pair(RP_HL));
         Helper::setBit(data, bitPosition);
-        writeMemory(Helper::concatChar(registers[R_H], registers[R_L]), data);
+        writeMemory<Accuracy>(registers.pair(RP_HL), data);
         cycleTime += 2;
     }
     else
@@ -1830,3 +2065,11 @@ void CPU::opSET()
 
     cycleCount += cycleTime;
 }
+
+/* ACCURACY POLICIES */
+// everything above that touches memory is built once for each policy, the rest of the CPU gets to it through these
+template CPU::OpHandler CPU::selectOp<FastAccuracy>();
+template CPU::OpHandler CPU::selectOp<CycleAccuracy>();
+template CPU::OpHandler CPU::selectPrefixedOp<FastAccuracy>();
+template CPU::OpHandler CPU::selectPrefixedOp<CycleAccuracy>();
+template uint8_t CPU::fetchOperand<FastAccuracy>();
\ No newline at end of file
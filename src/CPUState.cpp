@@ -0,0 +1,172 @@
+#include "CPU.hpp"
+
+/*
+    A save state is a flat copy of everything that changes while a game runs.
+    The layout only depends on the loaded cartridge, so every state of one game
+    has the same size and can be XORed against another (the rewind buffer relies on this).
+    ROM is never written so only 0x8000 onwards of the memory map is stored.
+*/
+void CPU::saveState(std::vector<uint8_t>& buffer)
+{
+    syncPPU();
+
+    // clear keeps the capacity, so saving into the same buffer every frame does not allocate
+    buffer.clear();
+
+    Helper::writeState(buffer, SAVE_STATE_MAGIC, sizeof(SAVE_STATE_MAGIC));
+    Helper::writeState(buffer, &SAVE_STATE_VERSION, sizeof(SAVE_STATE_VERSION));
+
+    // total size gets filled in once everything has been written
+    uint32_t stateSize{0};
+    Helper::writeState(buffer, &stateSize, sizeof(stateSize));
+
+    uint32_t ramBankSize{mExtRAMSize};
+    Helper::writeState(buffer, &ramBankSize, sizeof(ramBankSize));
+
+    // CPU
+    materializeFlags();
+    Helper::writeState(buffer, &cycleCount, sizeof(cycleCount));
+    Helper::writeState(buffer, &cyclesSincePowerOn, sizeof(cyclesSincePowerOn));
+    Helper::writeState(buffer, &IMEflag, sizeof(IMEflag));
+    Helper::writeState(buffer, &prepareIME, sizeof(prepareIME));
+    Helper::writeState(buffer, &nextInstrExecuted, sizeof(nextInstrExecuted));
+    Helper::writeState(buffer, &isHalted, sizeof(isHalted));
+    Helper::writeState(buffer, &lastIReqs, sizeof(lastIReqs));
+    Helper::writeState(buffer, &mHaltBug, sizeof(mHaltBug));
+    // by index so the layout does not depend on the host
+    for(uint8_t i{0}; i < 8; i++)
+    {
+        Helper::writeState(buffer, &registers[i], sizeof(uint8_t));
+    }
+    Helper::writeState(buffer, &sp, sizeof(sp));
+    Helper::writeState(buffer, &pc, sizeof(pc));
+
+    // Banking
+    mMapper->saveState(buffer);
+
+    // OAM DMA
+    Helper::writeState(buffer, &mDMACyclesLeft, sizeof(mDMACyclesLeft));
+    Helper::writeState(buffer, &mDMASource, sizeof(mDMASource));
+
+    // Components
+    mPPU.saveState(buffer);
+    mTimerControl.saveState(buffer);
+    mJoypad.saveState(buffer);
+
+    // Memory
+    Helper::writeState(buffer, memMap.data() + VRAM, memMap.size() - VRAM);
+    Helper::writeState(buffer, mExtRAM, mExtRAMSize);
+
+    stateSize = buffer.size();
+    std::memcpy(buffer.data() + sizeof(SAVE_STATE_MAGIC) + sizeof(SAVE_STATE_VERSION), &stateSize, sizeof(stateSize));
+}
+
+bool CPU::loadState(const std::vector<uint8_t>& buffer)
+{
+    const uint8_t* data{buffer.data()};
+    uint32_t headerSize{sizeof(SAVE_STATE_MAGIC) + sizeof(SAVE_STATE_VERSION) + 2*sizeof(uint32_t)};
+    if(buffer.size() < headerSize)
+    {
+        std::cout << "Save state is too small" << std::endl;
+        return false;
+    }
+
+    uint8_t magic[sizeof(SAVE_STATE_MAGIC)];
+    uint8_t version{0};
+    uint32_t stateSize{0};
+    uint32_t ramBankSize{0};
+    Helper::readState(data, magic, sizeof(magic));
+    Helper::readState(data, &version, sizeof(version));
+    Helper::readState(data, &stateSize, sizeof(stateSize));
+    Helper::readState(data, &ramBankSize, sizeof(ramBankSize));
+
+    if((std::memcmp(magic, SAVE_STATE_MAGIC, sizeof(magic)) != 0) || (version != SAVE_STATE_VERSION))
+    {
+        std::cout << "Save state was made by a different version of GBMoo" << std::endl;
+        return false;
+    }
+    if((stateSize != buffer.size()) || (ramBankSize != mExtRAMSize))
+    {
+        std::cout << "Save state does not match the loaded ROM" << std::endl;
+        return false;
+    }
+
+    // CPU
+    uint64_t clockBefore{cyclesSincePowerOn};
+    Helper::readState(data, &cycleCount, sizeof(cycleCount));
+    Helper::readState(data, &cyclesSincePowerOn, sizeof(cyclesSincePowerOn));
+    Helper::readState(data, &IMEflag, sizeof(IMEflag));
+    Helper::readState(data, &prepareIME, sizeof(prepareIME));
+    Helper::readState(data, &nextInstrExecuted, sizeof(nextInstrExecuted));
+    Helper::readState(data, &isHalted, sizeof(isHalted));
+    Helper::readState(data, &lastIReqs, sizeof(lastIReqs));
+    Helper::readState(data, &mHaltBug, sizeof(mHaltBug));
+    for(uint8_t i{0}; i < 8; i++)
+    {
+        Helper::readState(data, &registers[i], sizeof(uint8_t));
+    }
+    mFlagOp = FLAG_OP_NONE;
+    Helper::readState(data, &sp, sizeof(sp));
+    Helper::readState(data, &pc, sizeof(pc));
+
+    // a transfer running now has every page blocked, VRAM too which nothing below remaps, so they go back first
+    if(mDMACyclesLeft != 0)
+    {
+        mPages = mDMASavedPages;
+    }
+
+    // Work RAM is about to be replaced, so code compiled from it goes
+    releaseCodePage(WRAM_0 >> PAGE_SHIFT);
+    releaseCodePage(WRAM_N >> PAGE_SHIFT);
+    mapWorkRAM();
+
+    // Banking (this also points the pages back at the right banks)
+    mMapper->loadState(data);
+
+    // OAM DMA, a transfer still running needs the pages blocked again
+    Helper::readState(data, &mDMACyclesLeft, sizeof(mDMACyclesLeft));
+    Helper::readState(data, &mDMASource, sizeof(mDMASource));
+    if(mDMACyclesLeft != 0)
+    {
+        mDMASavedPages = mPages;
+        blockPagesForDMA();
+    }
+
+    // Components, the PPU is never behind in a state
+    mPPU.loadState(data);
+    mPPUPendingCycles = 0;
+    mPPUDeadline = 0;
+    mTimerControl.loadState(data);
+    mJoypad.loadState(data);
+    if(DEBUG_MODE && (mDMACyclesLeft == 0) && pagesBlockedForDMA())
+    {
+        std::cout << "Pages are still blocked for OAM DMA after loading a state" << std::endl;
+    }
+
+    // queued input is the host's, it stays as far ahead of the clock as it was (rewind and run-ahead move the clock)
+    for(InputEvent& event : mInputQueue)
+    {
+        event.timestamp = cyclesSincePowerOn + ((event.timestamp > clockBefore) ? event.timestamp - clockBefore : 0);
+    }
+    mNextInputEvent = mInputQueue.empty() ? NO_INPUT_EVENT : mInputQueue.front().timestamp;
+
+    // Memory
+    Helper::readState(data, memMap.data() + VRAM, memMap.size() - VRAM);
+    Helper::readState(data, mExtRAM, mExtRAMSize);
+    updatePendingInterrupts();
+
+    return true;
+}
+
+void CPU::saveInput(HostInput& input) const
+{
+    input.queue = mInputQueue;
+    input.heldButtons = mJoypad.getHeldButtons();
+}
+
+void CPU::loadInput(const HostInput& input)
+{
+    mInputQueue = input.queue;
+    mNextInputEvent = mInputQueue.empty() ? NO_INPUT_EVENT : mInputQueue.front().timestamp;
+    mJoypad.setHeldButtons(input.heldButtons);
+}
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include "Cartridge.hpp"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <mutex>
+
+// Every cartridge that is still in use by someone, keyed by the full path of its file
+static std::map<std::string, std::weak_ptr<const Cartridge>> loadedCartridges;
+static std::mutex loadedCartridgesLock;
+
+Cartridge::Cartridge()
+{
+    mROM = nullptr;
+    mROMBankCount = 0;
+    mMBCType = NO_MBC;
+    mHeaderROMBanks = 2;
+    mHeaderRAMBanks = 0;
+    mHasBattery = false;
+    mHasRTC = false;
+    mMulticart = false;
+}
+
+Cartridge::~Cartridge()
+{
+
+}
+
+std::shared_ptr<const Cartridge> Cartridge::load(const std::string& fileName)
+{
+    std::error_code error;
+    std::string key{std::filesystem::weakly_canonical(fileName, error).string()};
+    if(error)
+    {
+        key = fileName;
+    }
+
+    std::lock_guard<std::mutex> lock(loadedCartridgesLock);
+    std::shared_ptr<const Cartridge> cartridge{loadedCartridges[key].lock()};
+    if(cartridge)
+    {
+        return cartridge;
+    }
+
+    // the constructor is private, so make_shared can not be used
+    std::shared_ptr<Cartridge> newCartridge(new Cartridge());
+    if(!newCartridge->open(fileName))
+    {
+        loadedCartridges.erase(key);
+        return nullptr;
+    }
+
+    loadedCartridges[key] = newCartridge;
+    return newCartridge;
+}
+
+bool Cartridge::open(const std::string& fileName)
+{
+    // map the file rather than reading it, so loading costs the same no matter how big the ROM is
+    if(!mFile.open(fileName))
+    {
+        return false;
+    }
+
+    uint32_t fileSize{mFile.getSize()};
+    const uint8_t* fileData{mFile.getData()};
+    if(fileSize < CART_HEADER_END)
+    {
+        std::cout << "ROM is too small to have a cartridge header" << std::endl;
+        mFile.close();
+        return false;
+    }
+
+    mMBCType = getBankMode(fileData[CART_TYPE]);
+    mHeaderROMBanks = getROMSize(fileData[ROM_HEADER]);
+    mHeaderRAMBanks = getRAMSize(fileData[RAM_HEADER]);
+    mHasBattery = getBattery(fileData[CART_TYPE]);
+    mHasRTC = (fileData[CART_TYPE] == 0x0F) || (fileData[CART_TYPE] == 0x10); // MBC3+TIMER
+
+    if((fileSize % ROM_BANK_SIZE == 0) && (fileSize >= 2*ROM_BANK_SIZE))
+    {
+        mROM = fileData;
+        mROMBankCount = fileSize / ROM_BANK_SIZE;
+    }
+    else
+    {
+        // trimmed dumps and some homebrew are not a whole number of banks, pad a copy with 0xFF instead
+        mROMBankCount = std::max<uint32_t>(2, (fileSize + ROM_BANK_SIZE - 1) / ROM_BANK_SIZE);
+        mCopy.assign(mROMBankCount * ROM_BANK_SIZE, 0xFF);
+        std::memcpy(mCopy.data(), fileData, fileSize);
+        mFile.close();
+        mROM = mCopy.data();
+    }
+
+    // a multicart is 1 MB with the Nintendo logo repeated at the start of its second game (bank 0x10)
+    constexpr uint16_t LOGO_START = 0x104;
+    constexpr uint16_t LOGO_SIZE = 48;
+    mMulticart = (mMBCType == MBC1) && (mROMBankCount == 64) &&
+                 (std::memcmp(mROM + LOGO_START, mROM + (0x10 * ROM_BANK_SIZE) + LOGO_START, LOGO_SIZE) == 0);
+
+    if(mROMBankCount < mHeaderROMBanks)
+    {
+        std::cout << "WARNING: ROM has fewer banks than its header says, missing banks will mirror existing ones" << std::endl;
+    }
+    return true;
+}
+
+const uint8_t* Cartridge::getROM() const
+{
+    return mROM;
+}
+
+uint16_t Cartridge::getROMBankCount() const
+{
+    return mROMBankCount;
+}
+
+uint8_t Cartridge::getMBCType() const
+{
+    return mMBCType;
+}
+
+uint16_t Cartridge::getHeaderROMBanks() const
+{
+    return mHeaderROMBanks;
+}
+
+uint8_t Cartridge::getHeaderRAMBanks() const
+{
+    return mHeaderRAMBanks;
+}
+
+bool Cartridge::hasBattery() const
+{
+    return mHasBattery;
+}
+
+bool Cartridge::hasRTC() const
+{
+    return mHasRTC;
+}
+
+uint32_t Cartridge::getExtRAMSize() const
+{
+    if(mMBCType == MBC2)
+    {
+        return MBC2_RAM_SIZE;
+    }
+    return mHeaderRAMBanks * RAM_BANK_SIZE;
+}
+
+bool Cartridge::isMulticart() const
+{
+    return mMulticart;
+}
+
+uint32_t Cartridge::getROMHash() const
+{
+    // reading the header is free, hashing the whole ROM would mean reading every bank of the file
+    return (mROM[HEADER_CHECKSUM] << 16) | (mROM[GLOBAL_CHECKSUM] << 8) | mROM[GLOBAL_CHECKSUM + 1];
+}
+
+uint8_t Cartridge::getBankMode(const uint8_t type)
+{
+    switch(type)
+    {
+
+        // No MBC
+        case 0x0:
+            return NO_MBC;
+
+        // MBC1
+        case 0x1:
+        case 0x2:
+        case 0x3:
+            return MBC1;
+
+        // MBC2
+        case 0x5:
+        case 0x6:
+            return MBC2;
+        
+        // MBC3
+        case 0x0F:
+        case 0x10:
+        case 0x11:
+        case 0x12:
+        case 0x13:
+            return MBC3;
+        
+        // MBC5
+        case 0x19:
+        case 0x1A:
+        case 0x1B:
+        case 0x1C:
+        case 0x1D:
+        case 0x1E:
+            return MBC5;
+
+        default:
+            return NO_MBC;
+
+    }
+}
+
+uint16_t Cartridge::getROMSize(const uint8_t type)
+{
+    switch(type)
+    {
+        case 0:
+            return 2;
+        case 1:
+            return 4;
+        case 2:
+            return 8;
+        case 3:
+            return 16;
+        case 4:
+            return 32;
+        case 5:
+            return 64;
+        case 6:
+            return 128;
+        case 7:
+            return 256;
+        case 8:
+            return 512;
+        case 0x52:
+            return 72;
+        case 0x53:
+            return 80;
+        case 0x54:
+            return 96;
+        default:
+            return 2;
+    }
+}
+
+uint8_t Cartridge::getRAMSize(const uint8_t type)
+{
+    switch(type)
+    {
+        case 0x00:
+        case 0x01:
+            return 0;
+        case 0x02:
+            return 1;
+        case 0x03:
+            return 4;
+        case 0x04:
+            return 16;
+        case 0x05:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+bool Cartridge::getBattery(const uint8_t type)
+{
+    switch(type)
+    {
+        case 0x03: // MBC1+RAM+BATTERY
+        case 0x06: // MBC2+BATTERY
+        case 0x09: // ROM+RAM+BATTERY
+        case 0x0D: // MMM01+RAM+BATTERY
+        case 0x0F: // MBC3+TIMER+BATTERY
+        case 0x10: // MBC3+TIMER+RAM+BATTERY
+        case 0x13: // MBC3+RAM+BATTERY
+        case 0x1B: // MBC5+RAM+BATTERY
+        case 0x1E: // MBC5+RUMBLE+RAM+BATTERY
+        case 0x22: // MBC7+SENSOR+RUMBLE+RAM+BATTERY
+        case 0xFF: // HuC1+RAM+BATTERY
+            return true;
+        default:
+            return false;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef CARTRIDGE_H
+#define CARTRIDGE_H
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "MappedFile.hpp"
+
+/* CARTRIDGE HEADER */
+constexpr uint16_t CART_TYPE = 0x147;
+constexpr uint16_t ROM_HEADER = 0x148;
+constexpr uint16_t RAM_HEADER = 0x149;
+constexpr uint16_t HEADER_CHECKSUM = 0x14D;
+constexpr uint16_t GLOBAL_CHECKSUM = 0x14E;
+constexpr uint16_t CART_HEADER_END = 0x150;
+constexpr uint32_t ROM_BANK_SIZE = 0x4000;
+constexpr uint32_t RAM_BANK_SIZE = 0x2000;
+constexpr uint32_t MBC2_RAM_SIZE = 0x200; // 512 half bytes built into the MBC
+
+/* MBC CLASSIFICATIONS */
+constexpr uint8_t NO_MBC = 0;
+constexpr uint8_t MBC1 = 1;
+constexpr uint8_t MBC2 = 2;
+constexpr uint8_t MBC3 = 3;
+constexpr uint8_t MBC5 = 5;
+
+/*
+    The parts of a cartridge that never change while a game runs: the ROM and its header.
+    A cartridge is loaded once per file and shared (read only) by every CPU running it,
+    so each emulator instance only owns its RAM, registers and banking registers.
+*/
+class Cartridge
+{
+    public:
+        ~Cartridge();
+
+        // Returns the already loaded cartridge if another instance is still using this file
+        // nullptr if the file could not be loaded
+        static std::shared_ptr<const Cartridge> load(const std::string& fileName);
+
+        const uint8_t* getROM() const;
+        uint16_t getROMBankCount() const;
+
+        // What the header says
+        uint8_t getMBCType() const;
+        uint16_t getHeaderROMBanks() const;
+        uint8_t getHeaderRAMBanks() const;
+        bool hasBattery() const;
+        bool hasRTC() const;
+
+        // Bytes of RAM on the cartridge, MBC2 has RAM built in that the header does not mention
+        uint32_t getExtRAMSize() const;
+        // MBC1 multicarts hold several 256 KB games, each with its own header
+        bool isMulticart() const;
+        // The header and global checksums from the header, enough to tell games (and revisions) apart
+        uint32_t getROMHash() const;
+
+    private:
+        Cartridge();
+        bool open(const std::string& fileName);
+
+        MappedFile mFile;
+        std::vector<uint8_t> mCopy; // only used when the file can not be mapped as whole banks
+        const uint8_t* mROM;
+        uint16_t mROMBankCount;
+
+        uint8_t mMBCType;
+        uint16_t mHeaderROMBanks;
+        uint8_t mHeaderRAMBanks;
+        bool mHasBattery;
+        bool mHasRTC;
+        bool mMulticart;
+
+        static uint8_t getBankMode(const uint8_t type);
+        static uint16_t getROMSize(const uint8_t type);
+        static uint8_t getRAMSize(const uint8_t type);
+        static bool getBattery(const uint8_t type);
+};
+
+#endif
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "FrontendSystem.hpp"
+#include <algorithm>
 
 const std::string vertexShaderSrc{
     "version 330 core\n"
@@ -28,6 +29,16 @@ FrontendSystem::FrontendSystem(const char *winTitle, int windowWidth, int window
     mCPU = new CPU();
 
     quit = false;
+    mRewinding = false;
+
+    mRunAheadFrames = 0;
+    mRunAheadTime = 0;
+    mFrameTime = 0;
+    mReportFrames = 0;
+
+    mFrameEndCycle = 0;
+    mFrameEndTicks = 0;
+    mFrameCycles = CYCLES_PER_FRAME;
 
     SDL_InitSubSystem(SDL_INIT_VIDEO);
 
@@ -71,6 +82,13 @@ FrontendSystem::FrontendSystem(const char *winTitle, int windowWidth, int window
 
 FrontendSystem::~FrontendSystem()
 {
+    // what the fused sequences and bulk loops did for this game, to tune the sequence and hint tables with
+    mCPU->printFusionStats(std::cout);
+
+    // unmapping the save file flushes it one last time
+    delete mCPU;
+
+
     SDL_GL_DeleteContext(glContext);
     SDL_DestroyWindow(windowObj);
     SDL_Quit();
@@ -81,6 +99,7 @@ void FrontendSystem::run()
     uint64_t lastCycle{SDL_GetPerformanceCounter()};
     uint64_t curTime{SDL_GetPerformanceCounter()};
     double elapsedTime{0};
+    uint32_t lastSaveFlush{SDL_GetTicks()};
     while(!quit)
     {
         curTime = SDL_GetPerformanceCounter();
@@ -90,13 +109,105 @@ void FrontendSystem::run()
 
         if(elapsedTime >= 0.01675)
         {
-            mCPU->runCPU(); 
+            if(mRewinding)
+            {
+                // step back one snapshot, then run a frame from it so there is a picture to show
+                if(mRewind.rewind(mStateBuffer))
+                {
+                    mCPU->loadState(mStateBuffer);
+                }
+                mCPU->runFrame();
+            }
+            else
+            {
+                runFrame();
+                if(mRewind.shouldCapture())
+                {
+                    mCPU->saveState(mStateBuffer);
+                    mRewind.capture(mStateBuffer);
+                }
+            }
             lastCycle = SDL_GetPerformanceCounter();
+            mFrameEndCycle = mCPU->cyclesSincePowerOn;
+            mFrameEndTicks = SDL_GetTicks();
+        }
+
+        if(SDL_GetTicks() - lastSaveFlush >= SAVE_FLUSH_INTERVAL)
+        {
+            mCPU->flushSaveRAM();
+            lastSaveFlush = SDL_GetTicks();
         }
         
     }
 }
 
+void FrontendSystem::runFrame()
+{
+    uint64_t startCycle{mCPU->cyclesSincePowerOn};
+    if(mRunAheadFrames == 0)
+    {
+        mCPU->runFrame();
+        mFrameCycles = mCPU->cyclesSincePowerOn - startCycle;
+        return;
+    }
+
+    uint64_t frameStart{SDL_GetPerformanceCounter()};
+
+    // the real frame, it is never shown so there is no point drawing it
+    mCPU->setRenderEnabled(false);
+    mCPU->runFrame();
+    mFrameCycles = mCPU->cyclesSincePowerOn - startCycle;
+
+    runAheadFrame();
+    mCPU->setRenderEnabled(true);
+
+    reportRunAhead(frameStart);
+}
+
+void FrontendSystem::runAheadFrame()
+{
+    uint64_t start{SDL_GetPerformanceCounter()};
+
+    /*
+        Run into the future with the input we have right now and show where the game ends up,
+        then go back so the real state only ever moves forward one frame at a time.
+        Saving after the real frame (rather than before) means the frame on screen is
+        mRunAheadFrames ahead of what would have been shown without run-ahead.
+        Input queued for later than the real frame got to is applied on the way, so it is put back too.
+    */
+    mCPU->saveState(mRunAheadState);
+    mCPU->saveInput(mRunAheadInput);
+    for(uint8_t i{1}; i <= mRunAheadFrames; i++)
+    {
+        mCPU->setRenderEnabled(i == mRunAheadFrames);
+        mCPU->runFrame();
+    }
+    mCPU->loadState(mRunAheadState);
+    mCPU->loadInput(mRunAheadInput);
+
+    mRunAheadTime += SDL_GetPerformanceCounter() - start;
+}
+
+void FrontendSystem::reportRunAhead(uint64_t frameStart)
+{
+    mFrameTime += SDL_GetPerformanceCounter() - frameStart;
+    mReportFrames++;
+    if(mReportFrames < RUN_AHEAD_REPORT_FRAMES)
+    {
+        return;
+    }
+
+    double frequency{static_cast<double>(SDL_GetPerformanceFrequency())};
+    double extraMs{(static_cast<double>(mRunAheadTime) * 1000.0) / (frequency * mReportFrames)};
+    double percent{(static_cast<double>(mRunAheadTime) * 100.0) / static_cast<double>(mFrameTime)};
+    std::cout << "Run-ahead " << (int)mRunAheadFrames << " frames: " << extraMs << " ms extra per frame ("
+              << percent << "% of emulation time)" << std::endl;
+
+    mRunAheadTime = 0;
+    mFrameTime = 0;
+    mReportFrames = 0;
+}
+
 void FrontendSystem::pollInput()
 {
     SDL_Event event{0};
@@ -113,10 +224,10 @@ void FrontendSystem::pollInput()
                 resizeFrame();
                 break;
             case SDL_KEYDOWN:
-                parseKeyboard(event.key.keysym.scancode, true);
+                parseKeyboard(event.key.keysym.scancode, true, event.key.timestamp);
                 break;
             case SDL_KEYUP:
-                parseKeyboard(event.key.keysym.scancode, false);
+                parseKeyboard(event.key.keysym.scancode, false, event.key.timestamp);
                 break;
             default:
                 break;
@@ -219,7 +330,19 @@ void FrontendSystem::resizeFrame()
     glViewport(0, 0, width, height);
 }
 
-void FrontendSystem::parseKeyboard(SDL_Scancode input, bool pressed)
+/*
+    Where a key event happened in emulated time. Events come in while the last frame is on screen, each one is
+    put in the next frame as far in as it came after the last one was done, so input is always a frame late rather
+    than whenever the host got round to polling, and a recording of the events plays back the same at any speed.
+    The real frame can end a few cycles sooner than the last one did, run-ahead puts back anything it ran past.
+*/
+uint64_t FrontendSystem::inputCycle(uint32_t timestamp)
+{
+    uint64_t offset{(timestamp > mFrameEndTicks) ? (static_cast<uint64_t>(timestamp - mFrameEndTicks) * DMG_HZ) / 1000 : 0};
+    return mFrameEndCycle + std::min<uint64_t>(offset, (mFrameCycles > 0) ? mFrameCycles - 1 : 0);
+}
+
+void FrontendSystem::parseKeyboard(SDL_Scancode input, bool pressed, uint32_t timestamp)
 {
     switch(input)
     {
@@ -234,7 +357,24 @@ void FrontendSystem::parseKeyboard(SDL_Scancode input, bool pressed)
         case SDL_SCANCODE_F:
         case SDL_SCANCODE_SPACE:
         case SDL_SCANCODE_RETURN:
-            mCPU->handleJoypadInput(input, pressed);
+            mCPU->queueInput(inputCycle(timestamp), input, pressed);
+            break;
+        case SDL_SCANCODE_BACKSPACE:
+            mRewinding = pressed;
+            break;
+        case SDL_SCANCODE_LEFTBRACKET:
+            if(pressed && (mRunAheadFrames > 0))
+            {
+                mRunAheadFrames--;
+                std::cout << "Run-ahead: " << (int)mRunAheadFrames << " frames" << std::endl;
+            }
+            break;
+        case SDL_SCANCODE_RIGHTBRACKET:
+            if(pressed && (mRunAheadFrames < MAX_RUN_AHEAD_FRAMES))
+            {
+                mRunAheadFrames++;
+                std::cout << "Run-ahead: " << (int)mRunAheadFrames << " frames" << std::endl;
+            }
             break;
         default:
             break;
@@ -284,4 +424,11 @@ void FrontendSystem::refreshScreen()
 void FrontendSystem::loadCPURom(const std::string fileName)
 {
     mCPU->loadROM(fileName);
+    mRewind.clear();
+    mFrameEndCycle = mCPU->cyclesSincePowerOn;
 }
+
+void FrontendSystem::setAccuracy(AccuracyMode mode)
+{
+    mCPU->setAccuracy(mode);
+}
\ No newline at end of file
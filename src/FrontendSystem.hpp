@@ -4,6 +4,14 @@
 #include <SDL.h>
 #include <glad.h>
 #include "CPU.hpp"
+#include "Rewind.hpp"
+
+/* BATTERY SAVES */
+constexpr uint32_t SAVE_FLUSH_INTERVAL = 5000; // ms between forcing save RAM out to disk
+
+/* RUN AHEAD */
+constexpr uint8_t MAX_RUN_AHEAD_FRAMES = 6;
+constexpr uint16_t RUN_AHEAD_REPORT_FRAMES = 600; // print the cost of run-ahead every 10 seconds or so
 
 /*
     A class to hold the SDL+OpenGL context as well as handle user input
@@ -20,6 +28,7 @@ class FrontendSystem
         void pollInput();
         void refreshScreen();
         void loadCPURom(const std::string fileName);
+        void setAccuracy(AccuracyMode mode);
     
     private:
         bool quit;
@@ -41,6 +50,24 @@ class FrontendSystem
         // Gameboy cpu
         CPU* mCPU;
 
+        // Rewind history, held down with backspace
+        Rewind mRewind;
+        std::vector<uint8_t> mStateBuffer;
+        bool mRewinding;
+
+        // Run-ahead, number of frames shown ahead of the real game state, changed with [ and ]
+        uint8_t mRunAheadFrames;
+        std::vector<uint8_t> mRunAheadState;
+        HostInput mRunAheadInput;
+        uint64_t mRunAheadTime;
+        uint64_t mFrameTime;
+        uint16_t mReportFrames;
+
+        // Input, key events are stamped with an emulated cycle in the frame after the one they came in during
+        uint64_t mFrameEndCycle;   // cyclesSincePowerOn when the last frame was done
+        uint32_t mFrameEndTicks;   // and SDL_GetTicks then
+        uint64_t mFrameCycles;     // how long the last real frame ran for
+
         // To do: Consolidate the GL functions to their own class
         void vertexSpec();
         void genGraphicsPipeline();
@@ -48,8 +75,13 @@ class FrontendSystem
         GLuint compileShader(GLuint shaderType, const std::string &shaderSource);
 
 
+        void runFrame();
+        void runAheadFrame();
+        void reportRunAhead(uint64_t frameStart);
+
         void resizeFrame();
-        void parseKeyboard(SDL_Scancode input, bool pressed);
+        void parseKeyboard(SDL_Scancode input, bool pressed, uint32_t timestamp);
+        uint64_t inputCycle(uint32_t timestamp);
         void drawTex();
         void glDrawQuad();
 
@@ -1,4 +1,5 @@
 #include "Helper.hpp"
+#include <cstring>
 
 uint16_t Helper::concatChar(uint8_t MSB, uint8_t LSB)
 {
@@ -41,4 +42,16 @@ uint8_t Helper::hiBits(uint16_t data)
 uint8_t Helper::loBits(uint16_t data)
 {
     return (data & 0x00FF);
+}
+
+void Helper::writeState(std::vector<uint8_t> &buffer, const void* data, size_t size)
+{
+    const uint8_t* bytes{static_cast<const uint8_t*>(data)};
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void Helper::readState(const uint8_t* &buffer, void* data, size_t size)
+{
+    std::memcpy(data, buffer, size);
+    buffer += size;
 }
\ No newline at end of file
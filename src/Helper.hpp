@@ -2,6 +2,8 @@
 #define HELPER_H
 
 #include <cstdint>
+#include <cstddef>
+#include <vector>
 
 /* A bunch of helper functions */
 class Helper
@@ -26,6 +28,12 @@ class Helper
         // get lower 8 bits
         static uint8_t loBits(uint16_t data);
 
+        // append raw bytes to a save state buffer
+        static void writeState(std::vector<uint8_t> &buffer, const void* data, size_t size);
+
+        // read raw bytes out of a save state buffer, moves the read pointer forward
+        static void readState(const uint8_t* &buffer, void* data, size_t size);
+
 
 
 };
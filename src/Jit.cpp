@@ -0,0 +1,1013 @@
+#include "Jit.hpp"
+#include "CPU.hpp"
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+Jit::Jit()
+{
+    mBuffer = nullptr;
+    mBufferUsed = 0;
+    std::memset(&mLayout, 0, sizeof(mLayout));
+}
+
+Jit::~Jit()
+{
+    if(mBuffer == nullptr)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    VirtualFree(mBuffer, 0, MEM_RELEASE);
+#else
+    munmap(mBuffer, JIT_BUFFER_SIZE);
+#endif
+}
+
+bool Jit::init(const JitLayout& layout)
+{
+    mLayout = layout;
+    if(!JIT_SUPPORTED || (mBuffer != nullptr))
+    {
+        return isAvailable();
+    }
+
+#ifdef _WIN32
+    mBuffer = static_cast<uint8_t*>(VirtualAlloc(nullptr, JIT_BUFFER_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE));
+#else
+    void* buffer{mmap(nullptr, JIT_BUFFER_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+    mBuffer = (buffer == MAP_FAILED) ? nullptr : static_cast<uint8_t*>(buffer);
+#endif
+
+    mBufferUsed = 0;
+    return isAvailable();
+}
+
+bool Jit::isAvailable() const
+{
+    return mBuffer != nullptr;
+}
+
+JitBlock Jit::getBlock(const uint8_t* code, uint16_t pc, const uint8_t* page, uint16_t& length)
+{
+    auto block{mBlocks.find(code)};
+    if(block != mBlocks.end())
+    {
+        length = block->second.second;
+        return block->second.first;
+    }
+
+    // blocks that can't be compiled are remembered too so they are not tried every time
+    length = 1;
+    JitBlock compiled{compile(code, pc, page, length)};
+    addBlock(code, page, compiled, length);
+    return compiled;
+}
+
+bool Jit::findBlock(const uint8_t* code, JitBlock& block, uint16_t& length) const
+{
+    auto found{mBlocks.find(code)};
+    if(found == mBlocks.end())
+    {
+        return false;
+    }
+    block = found->second.first;
+    length = found->second.second;
+    return true;
+}
+
+void Jit::skipBlock(const uint8_t* code, const uint8_t* page, uint16_t length)
+{
+    addBlock(code, page, nullptr, length);
+}
+
+void Jit::addBlock(const uint8_t* code, const uint8_t* page, JitBlock block, uint16_t length)
+{
+    mBlocks[code] = {block, length};
+    forEachCodeChunk(code, page, length, [this, code](const uint8_t* chunk) { mChunkBlocks[chunk].push_back(code); });
+}
+
+void Jit::invalidateChunk(const uint8_t* chunk)
+{
+    // the code itself stays in the buffer until the next flush, a block that wrote to its own chunk is still running
+    auto chunkBlocks{mChunkBlocks.find(chunk)};
+    if(chunkBlocks == mChunkBlocks.end())
+    {
+        return;
+    }
+
+    for(const uint8_t* code : chunkBlocks->second)
+    {
+        mBlocks.erase(code);
+    }
+    mChunkBlocks.erase(chunkBlocks);
+}
+
+void Jit::invalidatePage(const uint8_t* page)
+{
+    for(uint8_t i{0}; i < CODE_CHUNKS_PER_PAGE; i++)
+    {
+        invalidateChunk(page + (i * CODE_CHUNK_SIZE));
+    }
+}
+
+bool Jit::isFull() const
+{
+    return (JIT_BUFFER_SIZE - mBufferUsed) < JIT_MAX_BLOCK_BYTES;
+}
+
+void Jit::flush()
+{
+    mBlocks.clear();
+    mChunkBlocks.clear();
+    mBufferUsed = 0;
+}
+
+/* x86 condition codes for emitJump */
+constexpr uint8_t X86_ALWAYS = 0xFF;
+constexpr uint8_t X86_ABOVE_EQUAL = 0x3;
+constexpr uint8_t X86_ZERO = 0x4;
+constexpr uint8_t X86_NOT_ZERO = 0x5;
+
+JitBlock Jit::compile(const uint8_t* code, uint16_t pc, const uint8_t* page, uint16_t& length)
+{
+    if(!isAvailable() || isFull())
+    {
+        return nullptr;
+    }
+
+    // the first instruction has to fit in the page, the rest are checked before the one before them is taken
+    uint32_t offset{static_cast<uint32_t>(code - page)};
+    if(offset + BlockCache::getLength(page[offset]) > PAGE_SIZE)
+    {
+        return nullptr;
+    }
+
+    mCode.clear();
+    mLabels.clear();
+    mLabelJumps.clear();
+    mLabelUsed.clear();
+    mInstructions.clear();
+    mExit = newLabel();
+
+    bool lastInstruction{false};
+    while(!lastInstruction)
+    {
+        uint8_t opcode{page[offset]};
+        uint8_t instructionLength{BlockCache::getLength(opcode)};
+        uint32_t nextOffset{offset + instructionLength};
+
+        lastInstruction = BlockCache::endsBlock(opcode) || (mInstructions.size() + 1 == JIT_MAX_BLOCK_INSTRUCTIONS) || (nextOffset >= PAGE_SIZE)
+                          || (nextOffset + BlockCache::getLength(page[nextOffset]) > PAGE_SIZE);
+
+        Instruction instruction{};
+        instruction.bytes = page + offset;
+        instruction.cycles = getNativeCycles(instruction.bytes);
+        instruction.step.nextPC = lastInstruction ? JIT_END_OF_BLOCK : pc + instructionLength;
+        instruction.step.pc = pc;
+        instruction.step.opcode = opcode;
+        instruction.native = newLabel();
+        instruction.slow = newLabel();
+        instruction.slowCharged = newLabel();
+        mInstructions.push_back(instruction);
+
+        pc += instructionLength;
+        offset = nextOffset;
+    }
+    length = offset - (code - page);
+
+    // a run of native instructions is charged up front, what is left of it when one of them needs the slow path is taken back
+    uint8_t runCycles{0};
+    for(auto instruction{mInstructions.rbegin()}; instruction != mInstructions.rend(); instruction++)
+    {
+        runCycles = (instruction->cycles == 0) ? 0 : runCycles + instruction->cycles;
+        instruction->step.runCycles = runCycles;
+    }
+
+    // push rbx, keep the CPU in rbx (callee saved), the stack is 16 byte aligned for calls after the push
+    emit8(0x53);
+#ifdef _WIN32
+    emit8(0x48); emit8(0x83); emit8(0xEC); emit8(0x20);  // sub rsp, 32 (shadow space)
+    emit8(0x48); emit8(0x89); emit8(0xCB);               // mov rbx, rcx
+#else
+    emit8(0x48); emit8(0x89); emit8(0xFB);               // mov rbx, rdi
+#endif
+
+    for(uint32_t i{0}; i < mInstructions.size(); i++)
+    {
+        const Instruction& instruction{mInstructions[i]};
+        const JitStep& step{instruction.step};
+        uint16_t nextPC{step.pc + BlockCache::getLength(step.opcode)};
+        if(instruction.cycles != 0)
+        {
+            if((i == 0) || (mInstructions[i - 1].cycles == 0))
+            {
+                emitChargeRun(step.runCycles, instruction.slow);
+            }
+            bindLabel(instruction.native);
+            emitNative(instruction.bytes, instruction.slowCharged);
+            if(step.nextPC == JIT_END_OF_BLOCK)
+            {
+                emitStorePC(nextPC);
+            }
+            continue;
+        }
+
+        bindLabel(instruction.native);
+        if(emitBranch(instruction.bytes, nextPC))
+        {
+            emitCall(reinterpret_cast<const void*>(mLayout.endInstruction), step.nextPC, 0);
+        }
+        else
+        {
+            emitStorePC(step.pc + 1);
+            emitCall(reinterpret_cast<const void*>(mLayout.interpret), step.opcode, step.nextPC);
+        }
+
+        // test al, al / jz exit
+        emit8(0x84); emit8(0xC0);
+        emitJump(X86_ZERO, mExit);
+    }
+    emitJump(X86_ALWAYS, mExit);
+
+    // the ways into the slow path that are used, out of the way of the native code
+    uint32_t slowPath{newLabel()};
+    for(uint32_t i{0}; i < mInstructions.size(); i++)
+    {
+        emitSlowPath(mInstructions[i].slow, i, slowPath);
+        emitSlowPath(mInstructions[i].slowCharged, i | JIT_SLOW_CHARGED, slowPath);
+    }
+
+    // slowPath(cpu, steps, index) returns where to go on, or nullptr to stop
+    bindLabel(slowPath);
+#ifdef _WIN32
+    emit8(0x48); emit8(0x89); emit8(0xD9);  // mov rcx, rbx
+    emit8(0x48); emit8(0xBA);               // mov rdx, imm64
+#else
+    emit8(0x48); emit8(0x89); emit8(0xDF);  // mov rdi, rbx
+    emit8(0x48); emit8(0xBE);               // mov rsi, imm64
+#endif
+    uint32_t stepsAddress{static_cast<uint32_t>(mCode.size())};
+    emit64(0);
+    emit8(0x48); emit8(0xB8);               // mov rax, imm64
+    emit64(reinterpret_cast<uint64_t>(mLayout.slowPath));
+    emit8(0xFF); emit8(0xD0);               // call rax
+    emit8(0x48); emit8(0x85); emit8(0xC0);  // test rax, rax
+    emitJump(X86_ZERO, mExit);
+    emit8(0xFF); emit8(0xE0);               // jmp rax
+
+    bindLabel(mExit);
+#ifdef _WIN32
+    emit8(0x48); emit8(0x83); emit8(0xC4); emit8(0x20);  // add rsp, 32
+#endif
+    emit8(0x5B);  // pop rbx
+    emit8(0xC3);  // ret
+
+    for(const std::pair<uint32_t, uint32_t>& jump : mLabelJumps)
+    {
+        uint32_t relative{mLabels[jump.second] - (jump.first + 4)};
+        std::memcpy(&mCode[jump.first], &relative, sizeof(relative));
+    }
+
+    // the steps go after the code, where the code is going to be is already known
+    uint8_t* block{mBuffer + mBufferUsed};
+    mCode.resize((mCode.size() + alignof(JitStep) - 1) & ~(alignof(JitStep) - 1), 0xCC);
+    uint64_t steps{reinterpret_cast<uint64_t>(block + mCode.size())};
+    std::memcpy(&mCode[stepsAddress], &steps, sizeof(steps));
+    for(Instruction& instruction : mInstructions)
+    {
+        instruction.step.resume = block + mLabels[instruction.native];
+        const uint8_t* step{reinterpret_cast<const uint8_t*>(&instruction.step)};
+        mCode.insert(mCode.end(), step, step + sizeof(JitStep));
+    }
+
+    if(mCode.size() > JIT_BUFFER_SIZE - mBufferUsed)
+    {
+        return nullptr;
+    }
+    std::memcpy(block, mCode.data(), mCode.size());
+    mBufferUsed += mCode.size();
+    return reinterpret_cast<JitBlock>(block);
+}
+
+/* m-cycles an instruction takes when emitNative does it, the same its op function counts, 0 when it is left to the interpreter
+   the 0xF000 page (OAM, IO, HRAM) is never paged so LDH and LD (C) are always left to it */
+uint8_t Jit::getNativeCycles(const uint8_t* bytes)
+{
+    uint8_t opcode{bytes[0]};
+    uint8_t x{opcode >> 6};
+    uint8_t y{(opcode >> 3) & 0b111};
+    uint8_t z{opcode & 0b111};
+    uint8_t q{y & 0b1};
+
+    if(opcode == 0xCB)
+    {
+        // BIT b, (HL) only reads it
+        if((bytes[1] & 0b111) != R_HL)
+        {
+            return 2;
+        }
+        return ((bytes[1] >> 6) == 1) ? 3 : 4;
+    }
+
+    switch(x)
+    {
+        case 0:
+            switch(z)
+            {
+                case 0:
+                    return (opcode == 0x00) ? 1 : 0;
+                case 1:
+                    return (q == 0) ? 3 : 2;
+                case 2:
+                case 3:
+                    return 2;
+                case 4:
+                case 5:
+                case 6:
+                    return (y == R_HL) ? 3 : (z == 6) ? 2 : 1;
+                case 7:
+                    return (opcode == 0x27) ? 0 : 1;  // DAA is left to its table
+            }
+            break;
+        case 1:
+            if(opcode == 0x76)
+            {
+                return 0;
+            }
+            return ((y == R_HL) || (z == R_HL)) ? 2 : 1;
+        case 2:
+            return (z == R_HL) ? 2 : 1;
+        case 3:
+            if(z == 6)
+            {
+                return 2;
+            }
+            if(opcode == 0xF9)
+            {
+                return 2;
+            }
+            if((z == 1) && (q == 0))
+            {
+                return 3;
+            }
+            if((z == 5) && (q == 0))
+            {
+                return 4;
+            }
+            if(((opcode == 0xEA) || (opcode == 0xFA)) && (bytes[2] < 0xF0))
+            {
+                return 4;
+            }
+            break;
+    }
+    return 0;
+}
+
+void Jit::emit8(uint8_t data)
+{
+    mCode.push_back(data);
+}
+
+void Jit::emit16(uint16_t data)
+{
+    emit8(data & 0xFF);
+    emit8(data >> 8);
+}
+
+void Jit::emit32(uint32_t data)
+{
+    emit16(data & 0xFFFF);
+    emit16(data >> 16);
+}
+
+void Jit::emit64(uint64_t data)
+{
+    emit32(data & 0xFFFFFFFF);
+    emit32(data >> 32);
+}
+
+void Jit::emitRBX(uint8_t reg, int32_t offset)
+{
+    // ModRM for [rbx + disp32]
+    emit8(0x83 | (reg << 3));
+    emit32(offset);
+}
+
+uint32_t Jit::newLabel()
+{
+    mLabels.push_back(0);
+    mLabelUsed.push_back(false);
+    return mLabels.size() - 1;
+}
+
+void Jit::bindLabel(uint32_t label)
+{
+    mLabels[label] = mCode.size();
+}
+
+void Jit::emitJump(uint8_t condition, uint32_t label)
+{
+    if(condition == X86_ALWAYS)
+    {
+        emit8(0xE9);                                // jmp rel32
+    }
+    else
+    {
+        emit8(0x0F); emit8(0x80 | condition);       // jcc rel32
+    }
+    mLabelJumps.push_back({mCode.size(), label});
+    mLabelUsed[label] = true;
+    emit32(0);
+}
+
+int32_t Jit::reg8(uint8_t r) const
+{
+    return mLayout.registers + (r ^ mLayout.registerSwap);
+}
+
+int32_t Jit::pair(uint8_t p) const
+{
+    return (p == 3) ? mLayout.sp : mLayout.registers + 2*p;
+}
+
+void Jit::emitStorePC(uint16_t pc)
+{
+    // mov word [rbx + pc], imm16
+    emit8(0x66); emit8(0xC7); emitRBX(0, mLayout.pc);
+    emit16(pc);
+}
+
+void Jit::emitAddCycles(uint8_t cycles)
+{
+    // add word [rbx + cycleCount], imm8
+    emit8(0x66); emit8(0x83); emitRBX(0, mLayout.cycleCount);
+    emit8(cycles);
+}
+
+void Jit::emitCall(const void* function, uint32_t argument, uint32_t argument2)
+{
+#ifdef _WIN32
+    emit8(0x48); emit8(0x89); emit8(0xD9);  // mov rcx, rbx
+    emit8(0xBA); emit32(argument);          // mov edx, imm32
+    emit8(0x41); emit8(0xB8);               // mov r8d, imm32
+#else
+    emit8(0x48); emit8(0x89); emit8(0xDF);  // mov rdi, rbx
+    emit8(0xBE); emit32(argument);          // mov esi, imm32
+    emit8(0xBA);                            // mov edx, imm32
+#endif
+    emit32(argument2);
+    emit8(0x48); emit8(0xB8);               // mov rax, imm64
+    emit64(reinterpret_cast<uint64_t>(function));
+    emit8(0xFF); emit8(0xD0);               // call rax
+}
+
+void Jit::emitChargeRun(uint16_t cycles, uint32_t slowPath)
+{
+    // the run's t-cycles are added only if that stays below the horizon, nothing the interpreter would stop for is due before then
+    emit8(0x48); emit8(0x8B); emitRBX(0, mLayout.cyclesSincePowerOn);  // mov rax, [rbx + cyclesSincePowerOn]
+    emit8(0x48); emit8(0x05); emit32(4 * cycles);                       // add rax, imm32
+    emit8(0x48); emit8(0x3B); emitRBX(0, mLayout.horizon);              // cmp rax, [rbx + horizon]
+    emitJump(X86_ABOVE_EQUAL, slowPath);
+    emit8(0x48); emit8(0x89); emitRBX(0, mLayout.cyclesSincePowerOn);  // mov [rbx + cyclesSincePowerOn], rax
+    emit8(0x81); emitRBX(0, mLayout.ppuPendingCycles); emit32(cycles);  // add dword [rbx + ppuPendingCycles], imm32
+}
+
+void Jit::emitSlowPath(uint32_t label, uint32_t index, uint32_t slowPath)
+{
+    if(!mLabelUsed[label])
+    {
+        return;
+    }
+
+    // the index goes in the third argument of slowPath, the rest is shared
+    bindLabel(label);
+#ifdef _WIN32
+    emit8(0x41); emit8(0xB8);               // mov r8d, imm32
+#else
+    emit8(0xBA);                            // mov edx, imm32
+#endif
+    emit32(index);
+    emitJump(X86_ALWAYS, slowPath);
+}
+
+void Jit::emitPage(bool read, bool write, uint32_t slowPath)
+{
+    // eax is a guest address, rdx is left pointing at it to read and r8 to write, a page that is not mapped takes the slow path
+    emit8(0x89); emit8(0xC2);                                   // mov edx, eax
+    emit8(0xC1); emit8(0xEA); emit8(PAGE_SHIFT);                // shr edx, 12
+    if(write)
+    {
+        emit8(0x4C); emit8(0x8B); emit8(0x84); emit8(0xD3);     // mov r8, [rbx + rdx*8 + writePages]
+        emit32(mLayout.writePages);
+        emit8(0x4D); emit8(0x85); emit8(0xC0);                  // test r8, r8
+        emitJump(X86_ZERO, slowPath);
+    }
+    if(read)
+    {
+        emit8(0x48); emit8(0x8B); emit8(0x94); emit8(0xD3);     // mov rdx, [rbx + rdx*8 + readPages]
+        emit32(mLayout.readPages);
+        emit8(0x48); emit8(0x85); emit8(0xD2);                  // test rdx, rdx
+        emitJump(X86_ZERO, slowPath);
+    }
+    emit8(0x25); emit32(PAGE_MASK);                             // and eax, 0xFFF
+    if(read)
+    {
+        emit8(0x48); emit8(0x01); emit8(0xC2);                  // add rdx, rax
+    }
+    if(write)
+    {
+        emit8(0x49); emit8(0x01); emit8(0xC0);                  // add r8, rax
+    }
+}
+
+void Jit::emitHostFlags()
+{
+    // cl = Z, H and C of F from the host's ZF, AF and CF after an 8 bit add or subtract (they mean the same)
+    emit8(0x9C);                                    // pushfq
+    emit8(0x59);                                    // pop rcx
+    emit8(0x41); emit8(0x89); emit8(0xCA);          // mov r10d, ecx
+    emit8(0x83); emit8(0xE1); emit8(0x50);          // and ecx, ZF | AF
+    emit8(0x01); emit8(0xC9);                       // add ecx, ecx (to Z and H)
+    emit8(0x41); emit8(0x83); emit8(0xE2); emit8(0x01);  // and r10d, CF
+    emit8(0x41); emit8(0xC1); emit8(0xE2); emit8(0x04);  // shl r10d, 4 (to C)
+    emit8(0x44); emit8(0x09); emit8(0xD1);          // or ecx, r10d
+}
+
+void Jit::emitKeepFlags(uint8_t mask)
+{
+    // the flags in mask keep their value from F
+    emit8(0x44); emit8(0x0F); emit8(0xB6); emitRBX(2, reg8(R_F));  // movzx r10d, byte [rbx + F]
+    emit8(0x41); emit8(0x83); emit8(0xE2); emit8(mask);           // and r10d, mask
+    emit8(0x44); emit8(0x09); emit8(0xD1);                        // or ecx, r10d
+}
+
+void Jit::emitStoreF()
+{
+    // mov [rbx + F], cl
+    emit8(0x88); emitRBX(1, reg8(R_F));
+}
+
+void Jit::emitAlu(uint8_t operation)
+{
+    // ADD ADC SUB SBC AND XOR OR CP as op al, cl, al is A and cl the operand
+    static const uint8_t hostOps[8]{0x00, 0x10, 0x28, 0x18, 0x20, 0x30, 0x08, 0x38};
+
+    if((operation == 1) || (operation == 3))
+    {
+        emit8(0x44); emit8(0x0F); emit8(0xB6); emitRBX(2, reg8(R_F));      // movzx r10d, byte [rbx + F]
+        emit8(0x41); emit8(0x0F); emit8(0xBA); emit8(0xE2); emit8(F_C);   // bt r10d, C (carry in)
+    }
+    emit8(hostOps[operation]); emit8(0xC8);
+
+    if((operation >= 4) && (operation <= 6))
+    {
+        // Z from the result, N and C reset, H set for AND
+        emit8(0x84); emit8(0xC0);                   // test al, al
+        emit8(0x0F); emit8(0x94); emit8(0xC1);      // setz cl
+        emit8(0xC0); emit8(0xE1); emit8(F_Z);       // shl cl, 7
+        if(operation == 4)
+        {
+            emit8(0x80); emit8(0xC9); emit8(1 << F_H);  // or cl, H
+        }
+    }
+    else
+    {
+        emitHostFlags();
+        if(operation >= 2)
+        {
+            emit8(0x80); emit8(0xC9); emit8(1 << F_N);  // or cl, N
+        }
+    }
+    emitStoreF();
+
+    if(operation != 7)
+    {
+        emit8(0x88); emitRBX(0, reg8(R_A));         // mov [rbx + A], al
+    }
+}
+
+void Jit::emitShift(uint8_t operation, bool zeroFlag)
+{
+    // RLC RRC RL RR SLA SRA SWAP SRL on al, the C from what was shifted out, Z from the result (or reset for RLCA and co.)
+    static const uint8_t hostOps[8]{0xC0, 0xC8, 0xD0, 0xD8, 0xE0, 0xF8, 0xC0, 0xE8};
+
+    if((operation == 2) || (operation == 3))
+    {
+        emit8(0x44); emit8(0x0F); emit8(0xB6); emitRBX(2, reg8(R_F));      // movzx r10d, byte [rbx + F]
+        emit8(0x41); emit8(0x0F); emit8(0xBA); emit8(0xE2); emit8(F_C);   // bt r10d, C (carry in)
+    }
+
+    if(operation == 6)
+    {
+        emit8(0xC0); emit8(0xC0); emit8(4);         // rol al, 4
+        emit8(0x31); emit8(0xC9);                   // xor ecx, ecx
+    }
+    else
+    {
+        emit8(0xD0); emit8(hostOps[operation]);     // rol/ror/rcl/rcr/shl/sar/shr al, 1
+        emit8(0x0F); emit8(0x92); emit8(0xC1);      // setc cl
+        emit8(0xC0); emit8(0xE1); emit8(F_C);       // shl cl, 4
+    }
+
+    if(zeroFlag)
+    {
+        emit8(0x84); emit8(0xC0);                           // test al, al
+        emit8(0x41); emit8(0x0F); emit8(0x94); emit8(0xC2); // setz r10b
+        emit8(0x41); emit8(0xC0); emit8(0xE2); emit8(F_Z);  // shl r10b, 7
+        emit8(0x44); emit8(0x08); emit8(0xD1);              // or cl, r10b
+    }
+    emitStoreF();
+}
+
+/* Instructions getNativeCycles counts, they leave pc and the cycles to the run they are in
+   F is always up to date in native code, the CPU works out any lazy flags before it gets there */
+void Jit::emitNative(const uint8_t* bytes, uint32_t slowPath)
+{
+    uint8_t opcode{bytes[0]};
+    uint8_t x{opcode >> 6};
+    uint8_t y{(opcode >> 3) & 0b111};
+    uint8_t z{opcode & 0b111};
+    uint8_t p{y >> 1};
+    uint8_t q{y & 0b1};
+
+    // movzx eax, word [rbx + HL]
+    auto loadHL{[this]() { emit8(0x0F); emit8(0xB7); emitRBX(0, pair(RP_HL)); }};
+
+    if(opcode == 0xCB)
+    {
+        uint8_t cbX{bytes[1] >> 6};
+        uint8_t bit{(bytes[1] >> 3) & 0b111};
+        uint8_t r{bytes[1] & 0b111};
+
+        // RES / SET b, r: and/or byte [rbx + r], imm8
+        if((r != R_HL) && (cbX >= 2))
+        {
+            emit8(0x80); emitRBX((cbX == 2) ? 4 : 1, reg8(r));
+            emit8((cbX == 2) ? ~(1 << bit) : (1 << bit));
+            return;
+        }
+
+        if(r == R_HL)
+        {
+            loadHL();
+            emitPage(true, cbX != 1, slowPath);
+            emit8(0x8A); emit8(0x02);                   // mov al, [rdx]
+        }
+        else
+        {
+            emit8(0x8A); emitRBX(0, reg8(r));           // mov al, [rbx + r]
+        }
+
+        switch(cbX)
+        {
+            case 0:
+                emitShift(bit, true);
+                break;
+            case 1:
+                // BIT: Z from the bit, N reset, H set, C kept
+                emit8(0xA8); emit8(1 << bit);           // test al, imm8
+                emit8(0x0F); emit8(0x94); emit8(0xC1);  // setz cl
+                emit8(0xC0); emit8(0xE1); emit8(F_Z);   // shl cl, 7
+                emit8(0x80); emit8(0xC9); emit8(1 << F_H);  // or cl, H
+                emitKeepFlags(1 << F_C);
+                emitStoreF();
+                return;
+            case 2:
+                emit8(0x24); emit8(~(1 << bit));        // and al, imm8
+                break;
+            case 3:
+                emit8(0x0C); emit8(1 << bit);           // or al, imm8
+                break;
+        }
+
+        if(r == R_HL)
+        {
+            emit8(0x41); emit8(0x88); emit8(0x00);      // mov [r8], al
+        }
+        else
+        {
+            emit8(0x88); emitRBX(0, reg8(r));           // mov [rbx + r], al
+        }
+        return;
+    }
+
+    switch(x)
+    {
+        case 0:
+            switch(z)
+            {
+                // NOP
+                case 0:
+                    return;
+
+                case 1:
+                    if(q == 0)
+                    {
+                        // LD rr, nn: mov word [rbx + rr], imm16
+                        emit8(0x66); emit8(0xC7); emitRBX(0, pair(p));
+                        emit16(bytes[1] | (bytes[2] << 8));
+                        return;
+                    }
+
+                    // ADD HL, rr: H is bit 12 and C bit 16 of HL ^ rr ^ the sum, Z kept
+                    loadHL();
+                    emit8(0x0F); emit8(0xB7); emitRBX(1, pair(p));  // movzx ecx, word [rbx + rr]
+                    emit8(0x8D); emit8(0x14); emit8(0x08);          // lea edx, [rax + rcx]
+                    emit8(0x66); emit8(0x89); emitRBX(2, pair(RP_HL));  // mov [rbx + HL], dx
+                    emit8(0x31); emit8(0xC8);                       // xor eax, ecx
+                    emit8(0x31); emit8(0xD0);                       // xor eax, edx
+                    emit8(0x89); emit8(0xC1);                       // mov ecx, eax
+                    emit8(0xC1); emit8(0xE8); emit8(12 - F_H);      // shr eax, 7
+                    emit8(0x83); emit8(0xE0); emit8(1 << F_H);      // and eax, H
+                    emit8(0xC1); emit8(0xE9); emit8(16 - F_C);      // shr ecx, 12
+                    emit8(0x83); emit8(0xE1); emit8(1 << F_C);      // and ecx, C
+                    emit8(0x09); emit8(0xC1);                       // or ecx, eax
+                    emitKeepFlags(1 << F_Z);
+                    emitStoreF();
+                    return;
+
+                case 2:
+                    // LD (BC)/(DE)/(HL+)/(HL-), A and LD A, (BC)/(DE)/(HL+)/(HL-)
+                    emit8(0x0F); emit8(0xB7); emitRBX(0, pair((p < 2) ? p : RP_HL));  // movzx eax, word [rbx + rr]
+                    emitPage(q == 1, q == 0, slowPath);
+                    if(q == 0)
+                    {
+                        emit8(0x8A); emitRBX(1, reg8(R_A));         // mov cl, [rbx + A]
+                        emit8(0x41); emit8(0x88); emit8(0x08);      // mov [r8], cl
+                    }
+                    else
+                    {
+                        emit8(0x8A); emit8(0x02);                   // mov al, [rdx]
+                        emit8(0x88); emitRBX(0, reg8(R_A));         // mov [rbx + A], al
+                    }
+                    if(p >= 2)
+                    {
+                        emit8(0x66); emit8(0x83); emitRBX(0, pair(RP_HL));  // add word [rbx + HL], +1/-1
+                        emit8((p == 2) ? 0x01 : 0xFF);
+                    }
+                    return;
+
+                case 3:
+                    // INC rr / DEC rr: add word [rbx + rr], +1/-1
+                    emit8(0x66); emit8(0x83); emitRBX(0, pair(p));
+                    emit8((q == 0) ? 0x01 : 0xFF);
+                    return;
+
+                case 4:
+                case 5:
+                    // INC r / DEC r: the host's AF is the half carry/borrow too, C kept
+                    if(y == R_HL)
+                    {
+                        loadHL();
+                        emitPage(true, true, slowPath);
+                        emit8(0x8A); emit8(0x02);                   // mov al, [rdx]
+                    }
+                    else
+                    {
+                        emit8(0x8A); emitRBX(0, reg8(y));           // mov al, [rbx + r]
+                    }
+                    emit8(0xFE); emit8((z == 4) ? 0xC0 : 0xC8);     // inc al / dec al
+                    emitHostFlags();
+                    emit8(0x80); emit8(0xE1); emit8((1 << F_Z) | (1 << F_H));  // and cl, Z | H
+                    if(z == 5)
+                    {
+                        emit8(0x80); emit8(0xC9); emit8(1 << F_N);  // or cl, N
+                    }
+                    emitKeepFlags(1 << F_C);
+                    emitStoreF();
+                    if(y == R_HL)
+                    {
+                        emit8(0x41); emit8(0x88); emit8(0x00);      // mov [r8], al
+                    }
+                    else
+                    {
+                        emit8(0x88); emitRBX(0, reg8(y));           // mov [rbx + r], al
+                    }
+                    return;
+
+                case 6:
+                    // LD r, n
+                    if(y == R_HL)
+                    {
+                        loadHL();
+                        emitPage(false, true, slowPath);
+                        emit8(0x41); emit8(0xC6); emit8(0x00);      // mov byte [r8], imm8
+                    }
+                    else
+                    {
+                        emit8(0xC6); emitRBX(0, reg8(y));           // mov byte [rbx + r], imm8
+                    }
+                    emit8(bytes[1]);
+                    return;
+
+                case 7:
+                    switch(y)
+                    {
+                        // RLCA RRCA RLA RRA reset Z
+                        case 0:
+                        case 1:
+                        case 2:
+                        case 3:
+                            emit8(0x8A); emitRBX(0, reg8(R_A));     // mov al, [rbx + A]
+                            emitShift(y, false);
+                            emit8(0x88); emitRBX(0, reg8(R_A));     // mov [rbx + A], al
+                            return;
+
+                        // CPL
+                        case 5:
+                            emit8(0x80); emitRBX(6, reg8(R_A)); emit8(0xFF);  // xor byte [rbx + A], 0xFF
+                            emit8(0x80); emitRBX(1, reg8(R_F)); emit8((1 << F_N) | (1 << F_H));  // or byte [rbx + F], N | H
+                            return;
+
+                        // SCF / CCF
+                        case 6:
+                        case 7:
+                            emit8(0x80); emitRBX(4, reg8(R_F)); emit8((1 << F_Z) | ((y == 7) ? (1 << F_C) : 0));  // and byte [rbx + F], imm8
+                            emit8(0x80); emitRBX((y == 7) ? 6 : 1, reg8(R_F)); emit8(1 << F_C);  // xor/or byte [rbx + F], C
+                            return;
+                    }
+                    break;
+            }
+            break;
+
+        case 1:
+            // LD r, r' (one of them can be (HL))
+            if(y == R_HL)
+            {
+                loadHL();
+                emitPage(false, true, slowPath);
+                emit8(0x8A); emitRBX(1, reg8(z));                   // mov cl, [rbx + r']
+                emit8(0x41); emit8(0x88); emit8(0x08);              // mov [r8], cl
+                return;
+            }
+            if(z == R_HL)
+            {
+                loadHL();
+                emitPage(true, false, slowPath);
+                emit8(0x8A); emit8(0x02);                           // mov al, [rdx]
+            }
+            else
+            {
+                emit8(0x8A); emitRBX(0, reg8(z));                   // mov al, [rbx + r']
+            }
+            emit8(0x88); emitRBX(0, reg8(y));                       // mov [rbx + r], al
+            return;
+
+        case 2:
+            // ALU A, r
+            if(z == R_HL)
+            {
+                loadHL();
+                emitPage(true, false, slowPath);
+                emit8(0x8A); emit8(0x0A);                           // mov cl, [rdx]
+            }
+            else
+            {
+                emit8(0x8A); emitRBX(1, reg8(z));                   // mov cl, [rbx + r]
+            }
+            emit8(0x8A); emitRBX(0, reg8(R_A));                     // mov al, [rbx + A]
+            emitAlu(y);
+            return;
+
+        case 3:
+            // ALU A, n
+            if(z == 6)
+            {
+                emit8(0xB1); emit8(bytes[1]);                       // mov cl, imm8
+                emit8(0x8A); emitRBX(0, reg8(R_A));                 // mov al, [rbx + A]
+                emitAlu(y);
+                return;
+            }
+
+            // LD SP, HL
+            if(opcode == 0xF9)
+            {
+                loadHL();
+                emit8(0x66); emit8(0x89); emitRBX(0, mLayout.sp);   // mov [rbx + sp], ax
+                return;
+            }
+
+            // LD (nn), A / LD A, (nn)
+            if((opcode == 0xEA) || (opcode == 0xFA))
+            {
+                emit8(0xB8); emit32(bytes[1] | (bytes[2] << 8));    // mov eax, imm32
+                emitPage(opcode == 0xFA, opcode == 0xEA, slowPath);
+                if(opcode == 0xEA)
+                {
+                    emit8(0x8A); emitRBX(1, reg8(R_A));             // mov cl, [rbx + A]
+                    emit8(0x41); emit8(0x88); emit8(0x08);          // mov [r8], cl
+                }
+                else
+                {
+                    emit8(0x8A); emit8(0x02);                       // mov al, [rdx]
+                    emit8(0x88); emitRBX(0, reg8(R_A));             // mov [rbx + A], al
+                }
+                return;
+            }
+
+            // POP rr / PUSH rr, both bytes have to be in the same page
+            emit8(0x0F); emit8(0xB7); emitRBX(0, mLayout.sp);       // movzx eax, word [rbx + sp]
+            if(z == 5)
+            {
+                emit8(0x83); emit8(0xE8); emit8(0x02);              // sub eax, 2
+                emit8(0x25); emit32(0xFFFF);                        // and eax, 0xFFFF
+            }
+            emit8(0x89); emit8(0xC1);                               // mov ecx, eax
+            emit8(0x81); emit8(0xE1); emit32(PAGE_MASK);            // and ecx, 0xFFF
+            emit8(0x81); emit8(0xF9); emit32(PAGE_MASK);            // cmp ecx, 0xFFF
+            emitJump(X86_ZERO, slowPath);
+            emitPage(z == 1, z == 5, slowPath);
+
+            if(z == 1)
+            {
+                emit8(0x0F); emit8(0xB7); emit8(0x0A);              // movzx ecx, word [rdx]
+                emit8(0x66); emit8(0x83); emitRBX(0, mLayout.sp); emit8(0x02);  // add word [rbx + sp], 2
+                if(p == 3)
+                {
+                    // POP AF, the low bits of F are always 0
+                    emit8(0x80); emit8(0xE1); emit8(0xF0);          // and cl, 0xF0
+                    emitStoreF();
+                    emit8(0x88); emitRBX(5, reg8(R_A));             // mov [rbx + A], ch
+                }
+                else
+                {
+                    emit8(0x66); emit8(0x89); emitRBX(1, pair(p));  // mov [rbx + rr], cx
+                }
+                return;
+            }
+
+            if(p == 3)
+            {
+                emit8(0x0F); emit8(0xB6); emitRBX(1, reg8(R_A));    // movzx ecx, byte [rbx + A]
+                emit8(0xC1); emit8(0xE1); emit8(0x08);              // shl ecx, 8
+                emit8(0x8A); emitRBX(1, reg8(R_F));                 // mov cl, [rbx + F]
+            }
+            else
+            {
+                emit8(0x0F); emit8(0xB7); emitRBX(1, pair(p));      // movzx ecx, word [rbx + rr]
+            }
+            emit8(0x66); emit8(0x41); emit8(0x89); emit8(0x08);     // mov [r8], cx
+            emit8(0x66); emit8(0x83); emitRBX(5, mLayout.sp); emit8(0x02);  // sub word [rbx + sp], 2
+            return;
+    }
+}
+
+/* JR, JP and JP HL end the block, pc and cycleCount are set like their op functions set them and the call after it ends the instruction */
+bool Jit::emitBranch(const uint8_t* bytes, uint16_t nextPC)
+{
+    uint8_t opcode{bytes[0]};
+    uint16_t target{0};
+    uint8_t takenCycles{0};
+    uint8_t notTakenCycles{0};
+    bool conditional{false};
+    switch(opcode)
+    {
+        case 0x18:
+        case 0x20: case 0x28: case 0x30: case 0x38:
+            conditional = (opcode != 0x18);
+            target = nextPC + static_cast<int8_t>(bytes[1]);
+            takenCycles = 3;
+            notTakenCycles = 2;
+            break;
+        case 0xC3:
+        case 0xC2: case 0xCA: case 0xD2: case 0xDA:
+            conditional = (opcode != 0xC3);
+            target = bytes[1] | (bytes[2] << 8);
+            takenCycles = 4;
+            notTakenCycles = 3;
+            break;
+        case 0xE9:
+            emit8(0x0F); emit8(0xB7); emitRBX(0, pair(RP_HL));      // movzx eax, word [rbx + HL]
+            emit8(0x66); emit8(0x89); emitRBX(0, mLayout.pc);       // mov [rbx + pc], ax
+            emitAddCycles(1);
+            return true;
+        default:
+            return false;
+    }
+
+    if(!conditional)
+    {
+        emitStorePC(target);
+        emitAddCycles(takenCycles);
+        return true;
+    }
+
+    // NZ Z NC C, the same order as the opcodes
+    uint8_t condition{(opcode >> 3) & 0b11};
+    uint32_t notTaken{newLabel()};
+    emitStorePC(nextPC);
+    emitAddCycles(notTakenCycles);
+    emit8(0xF6); emitRBX(0, reg8(R_F));                             // test byte [rbx + F], Z or C
+    emit8((condition < 2) ? (1 << F_Z) : (1 << F_C));
+    emitJump(((condition & 1) == 0) ? X86_NOT_ZERO : X86_ZERO, notTaken);
+    emitStorePC(target);
+    emitAddCycles(takenCycles - notTakenCycles);
+    bindLabel(notTaken);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include "BlockCache.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JIT_SUPPORTED 1
+#else
+#define JIT_SUPPORTED 0
+#endif
+
+/* JIT */
+constexpr uint32_t JIT_BUFFER_SIZE = 0x400000;  // 4 MB of code, everything is thrown away when it fills up
+constexpr uint8_t JIT_MAX_BLOCK_INSTRUCTIONS = BLOCK_MAX_INSTRUCTIONS;
+constexpr uint32_t JIT_MAX_BLOCK_BYTES = 192 * JIT_MAX_BLOCK_INSTRUCTIONS + 128;  // code, slow path entries and steps
+constexpr uint32_t JIT_END_OF_BLOCK = 0x10000;  // nextPC given to the last instruction, no pc matches it
+
+constexpr uint32_t JIT_SLOW_CHARGED = 0x80000000;  // in the index given to the slow path, the instruction's run was already charged
+
+class CPU;
+
+// A compiled block, it runs guest instructions from its start until one of them ends the block
+using JitBlock = void (*)(CPU* cpu);
+
+// What the slow path needs to know about each instruction of a block, kept after the block's code
+struct JitStep
+{
+    const uint8_t* resume;  // the instruction's code in the block
+    uint32_t nextPC;        // JIT_END_OF_BLOCK for the last one
+    uint16_t pc;
+    uint8_t opcode;
+    uint8_t runCycles;      // m-cycles from it to the end of its run of native instructions, 0 when the interpreter does it
+};
+
+/*
+    Where compiled code finds the CPU's state and what it calls back into.
+    endInstruction(cpu, nextPC) does everything the interpreter does after an instruction and
+    returns false when the block has to stop (branch taken, interrupt, deadline, code written...).
+    interpret(cpu, opcode, nextPC) runs one instruction through the interpreter, pc pointing past the opcode,
+    then ends it the same way.
+    Native code keeps going without either while cyclesSincePowerOn stays below horizon (see CPU::updateRunHorizon),
+    when it can't, slowPath(cpu, steps, index) interprets from that instruction on and returns where to pick up (nullptr to stop).
+*/
+struct JitLayout
+{
+    bool (*endInstruction)(CPU* cpu, uint32_t nextPC);
+    bool (*interpret)(CPU* cpu, uint32_t opcode, uint32_t nextPC);
+    const uint8_t* (*slowPath)(CPU* cpu, const JitStep* steps, uint32_t index);
+    int32_t registers;      // offset of the register bytes, already swapped for the host (see RegisterFile)
+    int32_t registerSwap;
+    int32_t sp;
+    int32_t pc;
+    int32_t cycleCount;
+    int32_t cyclesSincePowerOn;
+    int32_t ppuPendingCycles;
+    int32_t horizon;
+    int32_t readPages;      // the PageTable, a null page goes through the interpreter
+    int32_t writePages;
+};
+
+/*
+    Translates straight runs of SM83 code into x86-64.
+    Register and ALU ops, the CB ops, and loads, stores, PUSH and POP that hit a page the mapper has
+    pointed somewhere are done natively, each run of them charges its cycles once and checks once
+    that nothing (PPU, timers, input, end of the run) is due before it is over. When something is,
+    or an access needs the slow path, that instruction goes through the interpreter and the run
+    picks up after it (see CPU::jitSlowPath), so the result is exactly what the interpreter would have done.
+    Everything else is a call into the interpreter followed by the same bookkeeping it does.
+    Blocks are keyed by the host address of their first byte, which already tells banks apart,
+    and never cross a 4 KB page.
+*/
+class Jit
+{
+    public:
+        Jit();
+        ~Jit();
+
+        // Allocates the code buffer, false if there is no executable memory or the host is not x86-64
+        bool init(const JitLayout& layout);
+        bool isAvailable() const;
+
+        // Code for the block starting at code (pc in the guest), compiled the first time it is asked for
+        // page is the start of the 4 KB page code sits in, nullptr means the block can't be compiled
+        // length is set to how many bytes of guest code the block was made from
+        JitBlock getBlock(const uint8_t* code, uint16_t pc, const uint8_t* page, uint16_t& length);
+        // Same without compiling, false if there is nothing (not even a block that couldn't be compiled) for code yet
+        bool findBlock(const uint8_t* code, JitBlock& block, uint16_t& length) const;
+        // Never compile the length bytes at code, getBlock gives nullptr until the chunk is written to
+        void skipBlock(const uint8_t* code, const uint8_t* page, uint16_t length);
+
+        // Drop every block made from this chunk or page (it was written to)
+        void invalidateChunk(const uint8_t* chunk);
+        void invalidatePage(const uint8_t* page);
+        // No room left for another block, the owner has to flush (and stop watching its pages)
+        bool isFull() const;
+        void flush();
+
+    private:
+        uint8_t* mBuffer;
+        uint32_t mBufferUsed;
+        JitLayout mLayout;
+
+        std::unordered_map<const uint8_t*, std::pair<JitBlock, uint16_t>> mBlocks;  // and the length of guest code
+        std::unordered_map<const uint8_t*, std::vector<const uint8_t*>> mChunkBlocks;
+
+        // One instruction of the block being compiled
+        struct Instruction
+        {
+            const uint8_t* bytes;
+            uint8_t cycles;     // m-cycles when it is done natively, 0 when the interpreter does it
+            JitStep step;
+            uint32_t native;    // labels: its code, its way into the slow path, and the same once its run was charged
+            uint32_t slow;
+            uint32_t slowCharged;
+        };
+        std::vector<Instruction> mInstructions;
+
+        JitBlock compile(const uint8_t* code, uint16_t pc, const uint8_t* page, uint16_t& length);
+        void addBlock(const uint8_t* code, const uint8_t* page, JitBlock block, uint16_t length);
+        static uint8_t getNativeCycles(const uint8_t* bytes);
+
+        // Emitting
+        std::vector<uint8_t> mCode;
+        std::vector<uint32_t> mLabels;                          // where each label is in mCode
+        std::vector<std::pair<uint32_t, uint32_t>> mLabelJumps; // where a jump's rel32 is, and its label
+        std::vector<bool> mLabelUsed;
+        uint32_t mExit;                                         // label of the block's epilogue
+        void emit8(uint8_t data);
+        void emit16(uint16_t data);
+        void emit32(uint32_t data);
+        void emit64(uint64_t data);
+        void emitRBX(uint8_t reg, int32_t offset);
+        uint32_t newLabel();
+        void bindLabel(uint32_t label);
+        void emitJump(uint8_t condition, uint32_t label);
+        int32_t reg8(uint8_t r) const;
+        int32_t pair(uint8_t p) const;
+        void emitStorePC(uint16_t pc);
+        void emitAddCycles(uint8_t cycles);
+        void emitCall(const void* function, uint32_t argument, uint32_t argument2);
+        void emitChargeRun(uint16_t cycles, uint32_t slowPath);
+        void emitSlowPath(uint32_t label, uint32_t index, uint32_t slowPath);
+        void emitPage(bool read, bool write, uint32_t slowPath);
+        void emitHostFlags();
+        void emitKeepFlags(uint8_t mask);
+        void emitStoreF();
+        void emitAlu(uint8_t operation);
+        void emitShift(uint8_t operation, bool zeroFlag);
+        void emitNative(const uint8_t* bytes, uint32_t slowPath);
+        bool emitBranch(const uint8_t* bytes, uint16_t nextPC);
+};
+
+#endif
\ No newline at end of file
@@ -63,4 +63,25 @@ void Joypad::setJoypadState(bool dPad, uint8_t inputIndex, std::vector<uint8_t>
 void Joypad::resetJoypadState(bool dPad, uint8_t input)
 {
     Helper::setBit(mJoypadArray[dPad], input);
+}
+
+void Joypad::saveState(std::vector<uint8_t> &buffer)
+{
+    Helper::writeState(buffer, &reqInterrupt, sizeof(reqInterrupt));
+}
+
+void Joypad::loadState(const uint8_t* &buffer)
+{
+    Helper::readState(buffer, &reqInterrupt, sizeof(reqInterrupt));
+}
+
+uint16_t Joypad::getHeldButtons() const
+{
+    return (mJoypadArray[1] << 8) | mJoypadArray[0];
+}
+
+void Joypad::setHeldButtons(uint16_t held)
+{
+    mJoypadArray[0] = held & 0xFF;
+    mJoypadArray[1] = held >> 8;
 }
\ No newline at end of file
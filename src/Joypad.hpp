@@ -15,6 +15,13 @@ class Joypad
         void resetJoypadState(bool dPad, uint8_t input);
         bool reqInterrupt;
 
+        // Save state support, held buttons belong to the host so they are left alone
+        void saveState(std::vector<uint8_t> &buffer);
+        void loadState(const uint8_t* &buffer);
+        // so the host puts those back itself (dPad in the high byte)
+        uint16_t getHeldButtons() const;
+        void setHeldButtons(uint16_t held);
+
     private:
         // 1 is dPad, 0 is buttons
         uint8_t mJoypadArray[2];
@@ -0,0 +1,232 @@
+#include "MappedFile.hpp"
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+    mData = nullptr;
+    mSize = 0;
+    mWritable = false;
+    mFileHandle = nullptr;
+    mMapHandle = nullptr;
+    mFileDesc = -1;
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& fileName)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file{CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)};
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        std::cout << "Failed to open file" << std::endl;
+        return false;
+    }
+    mFileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize) || (fileSize.QuadPart == 0) || (fileSize.QuadPart > UINT32_MAX))
+    {
+        std::cout << "File is empty or too large to map" << std::endl;
+        close();
+        return false;
+    }
+    mSize = fileSize.QuadPart;
+
+    mMapHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mMapHandle == nullptr)
+    {
+        std::cout << "Failed to map file" << std::endl;
+        close();
+        return false;
+    }
+
+    mData = static_cast<uint8_t*>(MapViewOfFile(mMapHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+    mFileDesc = ::open(fileName.c_str(), O_RDONLY);
+    if(mFileDesc < 0)
+    {
+        std::cout << "Failed to open file" << std::endl;
+        return false;
+    }
+
+    struct stat fileStat;
+    if((fstat(mFileDesc, &fileStat) != 0) || (fileStat.st_size == 0) || (fileStat.st_size > UINT32_MAX))
+    {
+        std::cout << "File is empty or too large to map" << std::endl;
+        close();
+        return false;
+    }
+    mSize = fileStat.st_size;
+
+    void* mapping{mmap(nullptr, mSize, PROT_READ, MAP_SHARED, mFileDesc, 0)};
+    mData = (mapping == MAP_FAILED) ? nullptr : static_cast<uint8_t*>(mapping);
+#endif
+
+    if(mData == nullptr)
+    {
+        std::cout << "Failed to map file" << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::openWritable(const std::string& fileName, uint32_t size)
+{
+    close();
+    if(size == 0)
+    {
+        return false;
+    }
+
+#ifdef _WIN32
+    // only reads are shared, so a second writer is turned away just like with the lock below
+    HANDLE file{CreateFileA(fileName.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)};
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        if(GetLastError() == ERROR_SHARING_VIOLATION)
+        {
+            std::cout << fileName << " is already open for writing somewhere else" << std::endl;
+            return false;
+        }
+        std::cout << "Failed to open " << fileName << " for writing" << std::endl;
+        return false;
+    }
+    mFileHandle = file;
+
+    // a mapping larger than the file grows the file (with zeros), a smaller one leaves the rest alone
+    mMapHandle = CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, size, nullptr);
+    if(mMapHandle == nullptr)
+    {
+        std::cout << "Failed to map " << fileName << std::endl;
+        close();
+        return false;
+    }
+
+    mData = static_cast<uint8_t*>(MapViewOfFile(mMapHandle, FILE_MAP_WRITE, 0, 0, size));
+#else
+    mFileDesc = ::open(fileName.c_str(), O_RDWR | O_CREAT, 0644);
+    if(mFileDesc < 0)
+    {
+        std::cout << "Failed to open " << fileName << " for writing" << std::endl;
+        return false;
+    }
+
+    // one writer at a time, the lock goes with the descriptor when it is closed
+    if(flock(mFileDesc, LOCK_EX | LOCK_NB) != 0)
+    {
+        std::cout << fileName << " is already open for writing somewhere else" << std::endl;
+        close();
+        return false;
+    }
+
+    // never shrink the file, other emulators store extra data (like the RTC) after the RAM
+    struct stat fileStat;
+    if((fstat(mFileDesc, &fileStat) != 0) || ((fileStat.st_size < size) && (ftruncate(mFileDesc, size) != 0)))
+    {
+        std::cout << "Failed to resize " << fileName << std::endl;
+        close();
+        return false;
+    }
+
+    void* mapping{mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mFileDesc, 0)};
+    mData = (mapping == MAP_FAILED) ? nullptr : static_cast<uint8_t*>(mapping);
+#endif
+
+    if(mData == nullptr)
+    {
+        std::cout << "Failed to map " << fileName << std::endl;
+        close();
+        return false;
+    }
+    mSize = size;
+    mWritable = true;
+    return true;
+}
+
+void MappedFile::flush()
+{
+    if(!mWritable || (mData == nullptr))
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    FlushViewOfFile(mData, mSize);
+    FlushFileBuffers(mFileHandle);
+#else
+    msync(mData, mSize, MS_SYNC);
+#endif
+}
+
+void MappedFile::close()
+{
+    flush();
+
+#ifdef _WIN32
+    if(mData != nullptr)
+    {
+        UnmapViewOfFile(mData);
+    }
+    if(mMapHandle != nullptr)
+    {
+        CloseHandle(mMapHandle);
+    }
+    if(mFileHandle != nullptr)
+    {
+        CloseHandle(mFileHandle);
+    }
+#else
+    if(mData != nullptr)
+    {
+        munmap(mData, mSize);
+    }
+    if(mFileDesc >= 0)
+    {
+        ::close(mFileDesc);
+    }
+#endif
+
+    mData = nullptr;
+    mSize = 0;
+    mWritable = false;
+    mFileHandle = nullptr;
+    mMapHandle = nullptr;
+    mFileDesc = -1;
+}
+
+bool MappedFile::isOpen() const
+{
+    return mData != nullptr;
+}
+
+const uint8_t* MappedFile::getData() const
+{
+    return mData;
+}
+
+uint8_t* MappedFile::getWritableData()
+{
+    return mWritable ? mData : nullptr;
+}
+
+uint32_t MappedFile::getSize() const
+{
+    return mSize;
+}
\ No newline at end of file
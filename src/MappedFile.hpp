@@ -0,0 +1,46 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstdint>
+#include <string>
+
+/*
+    A view of a whole file mapped into memory.
+    Nothing is copied, pages are loaded by the OS the first time they are touched
+    and are shared with every other mapping of the same file (in this process or any other).
+    Writes to a writable mapping land in the page cache, flush() forces them out to disk.
+*/
+class MappedFile
+{
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        // a mapping owns OS handles, so it can not be copied
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::string& fileName);
+        // creates the file if needed and grows it to at least size bytes, only size bytes are mapped,
+        // fails if another writable mapping of the file is open (in this process or any other)
+        bool openWritable(const std::string& fileName, uint32_t size);
+        void flush();
+        void close();
+
+        bool isOpen() const;
+        const uint8_t* getData() const;
+        uint8_t* getWritableData();
+        uint32_t getSize() const;
+
+    private:
+        uint8_t* mData;
+        uint32_t mSize;
+        bool mWritable;
+
+        // HANDLEs on Windows, only the file descriptor is used elsewhere
+        void* mFileHandle;
+        void* mMapHandle;
+        int mFileDesc;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,500 @@
+#include "Mapper.hpp"
+#include "Helper.hpp"
+#include <cstring>
+#include <ctime>
+
+/* MAPPER */
+Mapper::Mapper(const uint8_t* rom, uint32_t romBankCount, uint8_t* ram, uint32_t ramSize, PageTable& pages)
+    : mPages(pages)
+{
+    mROM = rom;
+    mROMBankCount = romBankCount;
+    mRAM = ram;
+    mRAMSize = ramSize;
+
+    mROMBank = 1;
+    mRAMBank = 0;
+    mRAMEnabled = false;
+    mBankMode = false;
+}
+
+Mapper::~Mapper()
+{
+
+}
+
+std::unique_ptr<Mapper> Mapper::create(const Cartridge& cartridge, uint8_t* ram, uint32_t ramSize, PageTable& pages,
+                                       const uint64_t& cycles)
+{
+    const uint8_t* rom{cartridge.getROM()};
+    uint32_t romBankCount{cartridge.getROMBankCount()};
+
+    switch(cartridge.getMBCType())
+    {
+        case MBC1:
+            return std::make_unique<MapperMBC1>(rom, romBankCount, ram, ramSize, pages, cartridge.isMulticart());
+        case MBC2:
+            return std::make_unique<MapperMBC2>(rom, romBankCount, ram, ramSize, pages);
+        case MBC3:
+            return std::make_unique<MapperMBC3>(rom, romBankCount, ram, ramSize, pages, cycles);
+        case MBC5:
+            return std::make_unique<MapperMBC5>(rom, romBankCount, ram, ramSize, pages);
+        default:
+            return std::make_unique<MapperNoMBC>(rom, romBankCount, ram, ramSize, pages);
+    }
+}
+
+uint8_t Mapper::readRAM(uint16_t addr)
+{
+    // disabled or missing RAM, the bus floats high
+    return 0xFF;
+}
+
+void Mapper::writeRAM(uint16_t addr, uint8_t data)
+{
+
+}
+
+void Mapper::saveState(std::vector<uint8_t>& buffer)
+{
+    Helper::writeState(buffer, &mROMBank, sizeof(mROMBank));
+    Helper::writeState(buffer, &mRAMBank, sizeof(mRAMBank));
+    Helper::writeState(buffer, &mRAMEnabled, sizeof(mRAMEnabled));
+    Helper::writeState(buffer, &mBankMode, sizeof(mBankMode));
+}
+
+void Mapper::loadState(const uint8_t* &buffer)
+{
+    Helper::readState(buffer, &mROMBank, sizeof(mROMBank));
+    Helper::readState(buffer, &mRAMBank, sizeof(mRAMBank));
+    Helper::readState(buffer, &mRAMEnabled, sizeof(mRAMEnabled));
+    Helper::readState(buffer, &mBankMode, sizeof(mBankMode));
+    updatePages();
+}
+
+void Mapper::saveBattery(uint8_t* data)
+{
+
+}
+
+void Mapper::loadBattery(const uint8_t* data)
+{
+
+}
+
+void Mapper::mapROM(uint32_t lowBank, uint32_t highBank)
+{
+    // banks past the end of the ROM wrap around, like the unused address lines on a real cartridge
+    const uint8_t* low{mROM + (lowBank % mROMBankCount) * ROM_BANK_SIZE};
+    const uint8_t* high{mROM + (highBank % mROMBankCount) * ROM_BANK_SIZE};
+    for(uint8_t i{0}; i < 4; i++)
+    {
+        mPages.read[i] = low + i*PAGE_SIZE;
+        mPages.read[i + 4] = high + i*PAGE_SIZE;
+        mPages.write[i] = nullptr;
+        mPages.write[i + 4] = nullptr;
+    }
+}
+
+void Mapper::mapRAM(uint32_t bank)
+{
+    if(mRAMSize < RAM_BANK_SIZE)
+    {
+        unmapRAM();
+        return;
+    }
+
+    uint8_t* ramBank{mRAM + (bank % (mRAMSize / RAM_BANK_SIZE)) * RAM_BANK_SIZE};
+    mPages.read[0xA] = ramBank;
+    mPages.read[0xB] = ramBank + PAGE_SIZE;
+    mPages.write[0xA] = ramBank;
+    mPages.write[0xB] = ramBank + PAGE_SIZE;
+}
+
+void Mapper::unmapRAM()
+{
+    mPages.read[0xA] = nullptr;
+    mPages.read[0xB] = nullptr;
+    mPages.write[0xA] = nullptr;
+    mPages.write[0xB] = nullptr;
+}
+
+/* NO MBC */
+MapperNoMBC::MapperNoMBC(const uint8_t* rom, uint32_t romBankCount, uint8_t* ram, uint32_t ramSize, PageTable& pages)
+    : Mapper(rom, romBankCount, ram, ramSize, pages)
+{
+    mRAMEnabled = true;
+    updatePages();
+}
+
+void MapperNoMBC::writeRegister(uint16_t addr, uint8_t data)
+{
+    // nothing to write to
+}
+
+void MapperNoMBC::updatePages()
+{
+    mapROM(0, 1);
+    mapRAM(0);
+}
+
+/* MBC1 */
+MapperMBC1::MapperMBC1(const uint8_t* rom, uint32_t romBankCount, uint8_t* ram, uint32_t ramSize, PageTable& pages, bool multicart)
+    : Mapper(rom, romBankCount, ram, ramSize, pages)
+{
+    mBank2Shift = multicart ? 4 : 5;
+    updatePages();
+}
+
+void MapperMBC1::writeRegister(uint16_t addr, uint8_t data)
+{
+    if(addr < 0x2000)
+    {
+        mRAMEnabled = ((data & 0xF) == 0xA);
+    }
+    else if(addr < 0x4000)
+    {
+        // the zero check sees all 5 bits, even on multicarts where only 4 are wired up
+        mROMBank = data & 0b11111;
+        if(mROMBank == 0)
+        {
+            mROMBank = 1;
+        }
+    }
+    else if(addr < 0x6000)
+    {
+        mRAMBank = data & 0b11;
+    }
+    else
+    {
+        mBankMode = data & 0b1;
+    }
+    updatePages();
+}
+
+void MapperMBC1::updatePages()
+{
+    uint32_t bank1{(mBank2Shift == 4) ? (mROMBank & 0b1111) : mROMBank};
+    uint32_t bank2{mRAMBank << mBank2Shift};
+
+    // mode 1 also applies BANK2 to the 0x0000 area and to RAM
+    mapROM(mBankMode ? bank2 : 0, bank2 | bank1);
+    if(mRAMEnabled)
+    {
+        mapRAM(mBankMode ? mRAMBank : 0);
+    }
+    else
+    {
+        unmapRAM();
+    }
+}
+
+/* MBC2 */
+MapperMBC2::MapperMBC2(const uint8_t* rom, uint32_t romBankCount, uint8_t* ram, uint32_t ramSize, PageTable& pages)
+    : Mapper(rom, romBankCount, ram, ramSize, pages)
+{
+    updatePages();
+}
+
+void MapperMBC2::writeRegister(uint16_t addr, uint8_t data)
+{
+    if(addr >= 0x4000)
+    {
+        return;
+    }
+
+    // bit 8 of the address picks between RAM enable and ROM bank
+    if(!Helper::getBit(Helper::hiBits(addr), 0))
+    {
+        mRAMEnabled = ((data & 0xF) == 0xA);
+    }
+    else
+    {
+        mROMBank = data & 0b1111;
+        if(mROMBank == 0)
+        {
+            mROMBank = 1;
+        }
+    }
+    updatePages();
+}
+
+uint8_t MapperMBC2::readRAM(uint16_t addr)
+{
+    if(!mRAMEnabled || (mRAMSize < MBC2_RAM_SIZE))
+    {
+        return 0xFF;
+    }
+
+    // only the low 4 bits exist, and the 512 entries repeat through the whole area
+    return mRAM[addr & (MBC2_RAM_SIZE - 1)] | 0xF0;
+}
+
+void MapperMBC2::writeRAM(uint16_t addr, uint8_t data)
+{
+    if(mRAMEnabled && (mRAMSize >= MBC2_RAM_SIZE))
+    {
+        mRAM[addr & (MBC2_RAM_SIZE - 1)] = data & 0x0F;
+    }
+}
+
+void MapperMBC2::updatePages()
+{
+    mapROM(0, mROMBank);
+    unmapRAM();
+}
+
+/* MBC3 */
+MapperMBC3::MapperMBC3(const uint8_t* rom, uint32_t romBankCount, uint8_t* ram, uint32_t ramSize, PageTable& pages,
+                       const uint64_t& cycles)
+    : Mapper(rom, romBankCount, ram, ramSize, pages), mCycles(cycles)
+{
+    mRTCCycles = 0;
+    mRTCBaseCycle = mCycles;
+    mRTCHalted = false;
+    mDayCarry = false;
+    for(uint8_t i{0}; i < 5; i++)
+    {
+        mLatchedRTC[i] = 0;
+    }
+    mLastLatchWrite = 0xFF;
+    updatePages();
+}
+
+void MapperMBC3::writeRegister(uint16_t addr, uint8_t data)
+{
+    if(addr < 0x2000)
+    {
+        mRAMEnabled = ((data & 0xF) == 0xA);
+    }
+    else if(addr < 0x4000)
+    {
+        mROMBank = data & 0b1111111;
+        if(mROMBank == 0)
+        {
+            mROMBank = 1;
+        }
+    }
+    else if(addr < 0x6000)
+    {
+        mRAMBank = data;
+    }
+    else
+    {
+        // writing 0 then 1 copies the clock into the registers the game reads, the only time it is worked out
+        if((mLastLatchWrite == 0) && (data == 1))
+        {
+            getRTCRegisters(getRTCCycles(), mLatchedRTC);
+        }
+        mLastLatchWrite = data;
+    }
+    updatePages();
+}
+
+uint8_t MapperMBC3::readRAM(uint16_t addr)
+{
+    if(mRAMEnabled && (mRAMBank >= 0x08) && (mRAMBank <= 0x0C))
+    {
+        return mLatchedRTC[mRAMBank - 0x08];
+    }
+    return 0xFF;
+}
+
+void MapperMBC3::writeRAM(uint16_t addr, uint8_t data)
+{
+    if(!mRAMEnabled || (mRAMBank < 0x08) || (mRAMBank > 0x0C))
+    {
+        return;
+    }
+
+    uint8_t index{mRAMBank - 0x08};
+    uint64_t rtcCycles{getRTCCycles()};
+    uint8_t registers[5];
+    getRTCRegisters(rtcCycles, registers);
+    registers[index] = data;
+    mLatchedRTC[index] = data;
+
+    // writing the seconds also clears the part of a second that has gone by
+    uint64_t subSecond{(index == 0) ? 0 : (rtcCycles % RTC_CYCLES_PER_SECOND)};
+    mDayCarry = Helper::getBit(registers[4], 7);
+    mRTCHalted = Helper::getBit(registers[4], 6);
+    setRTCCycles(getRTCCycles(registers, subSecond));
+}
+
+void MapperMBC3::saveState(std::vector<uint8_t>& buffer)
+{
+    Mapper::saveState(buffer);
+    Helper::writeState(buffer, &mRTCCycles, sizeof(mRTCCycles));
+    Helper::writeState(buffer, &mRTCBaseCycle, sizeof(mRTCBaseCycle));
+    Helper::writeState(buffer, &mRTCHalted, sizeof(mRTCHalted));
+    Helper::writeState(buffer, &mDayCarry, sizeof(mDayCarry));
+    Helper::writeState(buffer, mLatchedRTC, sizeof(mLatchedRTC));
+    Helper::writeState(buffer, &mLastLatchWrite, sizeof(mLastLatchWrite));
+}
+
+void MapperMBC3::loadState(const uint8_t* &buffer)
+{
+    Mapper::loadState(buffer);
+    Helper::readState(buffer, &mRTCCycles, sizeof(mRTCCycles));
+    Helper::readState(buffer, &mRTCBaseCycle, sizeof(mRTCBaseCycle));
+    Helper::readState(buffer, &mRTCHalted, sizeof(mRTCHalted));
+    Helper::readState(buffer, &mDayCarry, sizeof(mDayCarry));
+    Helper::readState(buffer, mLatchedRTC, sizeof(mLatchedRTC));
+    Helper::readState(buffer, &mLastLatchWrite, sizeof(mLastLatchWrite));
+}
+
+/*
+    .sav clock layout (all little endian):
+        5 x uint32 live registers (seconds, minutes, hours, day low, day high)
+        5 x uint32 latched registers
+        uint64 unix time the file was written
+*/
+void MapperMBC3::saveBattery(uint8_t* data)
+{
+    uint8_t registers[5];
+    getRTCRegisters(getRTCCycles(), registers);
+    for(uint8_t i{0}; i < 5; i++)
+    {
+        uint32_t live{registers[i]};
+        uint32_t latched{mLatchedRTC[i]};
+        std::memcpy(data + i*4, &live, 4);
+        std::memcpy(data + 20 + i*4, &latched, 4);
+    }
+    uint64_t timestamp{static_cast<uint64_t>(std::time(nullptr))};
+    std::memcpy(data + 40, &timestamp, 8);
+}
+
+void MapperMBC3::loadBattery(const uint8_t* data)
+{
+    uint64_t timestamp;
+    std::memcpy(&timestamp, data + 40, 8);
+    if(timestamp == 0)
+    {
+        // a new .sav, the clock starts at zero
+        return;
+    }
+
+    uint8_t registers[5];
+    for(uint8_t i{0}; i < 5; i++)
+    {
+        uint32_t live;
+        uint32_t latched;
+        std::memcpy(&live, data + i*4, 4);
+        std::memcpy(&latched, data + 20 + i*4, 4);
+        registers[i] = live;
+        mLatchedRTC[i] = latched;
+    }
+    mDayCarry = Helper::getBit(registers[4], 7);
+    mRTCHalted = Helper::getBit(registers[4], 6);
+    uint64_t rtcCycles{getRTCCycles(registers, 0)};
+
+    // the battery kept the clock running while the game was off
+    uint64_t now{static_cast<uint64_t>(std::time(nullptr))};
+    if(!mRTCHalted && (now > timestamp))
+    {
+        rtcCycles += (now - timestamp) * RTC_CYCLES_PER_SECOND;
+    }
+    setRTCCycles(rtcCycles);
+}
+
+uint64_t MapperMBC3::getRTCCycles()
+{
+    if(mRTCHalted)
+    {
+        return mRTCCycles;
+    }
+    return mRTCCycles + (mCycles - mRTCBaseCycle);
+}
+
+void MapperMBC3::setRTCCycles(uint64_t rtcCycles)
+{
+    mRTCCycles = rtcCycles;
+    mRTCBaseCycle = mCycles;
+}
+
+void MapperMBC3::getRTCRegisters(uint64_t rtcCycles, uint8_t registers[5])
+{
+    uint64_t seconds{rtcCycles / RTC_CYCLES_PER_SECOND};
+    uint64_t days{seconds / 86400};
+
+    // the day counter is 9 bits, going past it sets the carry bit which stays set until the game clears it
+    if(days >= RTC_MAX_DAYS)
+    {
+        mDayCarry = true;
+        uint64_t overflow{(days / RTC_MAX_DAYS) * RTC_MAX_DAYS};
+        setRTCCycles(rtcCycles - overflow * 86400 * RTC_CYCLES_PER_SECOND);
+        days -= overflow;
+    }
+
+    registers[0] = seconds % 60;
+    registers[1] = (seconds / 60) % 60;
+    registers[2] = (seconds / 3600) % 24;
+    registers[3] = days & 0xFF;
+    registers[4] = ((days >> 8) & 0b1) | (mRTCHalted << 6) | (mDayCarry << 7);
+}
+
+uint64_t MapperMBC3::getRTCCycles(const uint8_t registers[5], uint64_t subSecond)
+{
+    // the registers can hold values a real clock never would (like 63 seconds), they just add up as is
+    uint64_t days{registers[3] | ((registers[4] & 0b1) << 8)};
+    uint64_t seconds{(registers[0] & 0b111111) + (registers[1] & 0b111111) * 60 + (registers[2] & 0b11111) * 3600 + days * 86400};
+    return seconds * RTC_CYCLES_PER_SECOND + subSecond;
+}
+
+void MapperMBC3::updatePages()
+{
+    mapROM(0, mROMBank);
+
+    // clock registers are not memory, they go through readRAM/writeRAM
+    if(mRAMEnabled && (mRAMBank <= 0x03))
+    {
+        mapRAM(mRAMBank);
+    }
+    else
+    {
+        unmapRAM();
+    }
+}
+
+/* MBC5 */
+MapperMBC5::MapperMBC5(const uint8_t* rom, uint32_t romBankCount, uint8_t* ram, uint32_t ramSize, PageTable& pages)
+    : Mapper(rom, romBankCount, ram, ramSize, pages)
+{
+    updatePages();
+}
+
+void MapperMBC5::writeRegister(uint16_t addr, uint8_t data)
+{
+    if(addr < 0x2000)
+    {
+        // unlike the others MBC5 looks at all 8 bits
+        mRAMEnabled = (data == 0x0A);
+    }
+    else if(addr < 0x3000)
+    {
+        mROMBank = (mROMBank & 0x100) | data;
+    }
+    else if(addr < 0x4000)
+    {
+        mROMBank = (mROMBank & 0xFF) | ((data & 0b1) << 8);
+    }
+    else if(addr < 0x6000)
+    {
+        mRAMBank = data & 0b1111;
+    }
+    updatePages();
+}
+
+void MapperMBC5::updatePages()
+{
+    // bank 0 can be selected at 0x4000 on MBC5
+    mapROM(0, mROMBank);
+    if(mRAMEnabled)
+    {
+        mapRAM(mRAMBank);
+    }
+    else
+    {
+        unmapRAM();
+    }
+}
\ No newline at end of file
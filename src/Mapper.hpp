@@ -0,0 +1,173 @@
+#ifndef MAPPER_H
+#define MAPPER_H
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+#include "Cartridge.hpp"
+
+/* MEMORY PAGES */
+constexpr uint8_t PAGE_SHIFT = 12;
+constexpr uint16_t PAGE_MASK = 0x0FFF;
+constexpr uint16_t PAGE_SIZE = 0x1000;
+constexpr uint8_t PAGE_COUNT = 16;
+
+/* MBC3 CLOCK */
+constexpr uint64_t RTC_CYCLES_PER_SECOND = 4194304; // the clock follows emulated time, not the host's
+constexpr uint32_t RTC_SAVE_SIZE = 48;              // clock stored after the RAM in the .sav, same layout as BGB and VBA-M
+constexpr uint16_t RTC_MAX_DAYS = 512;
+
+/*
+    Where each 4 KB page of the address space can be read or written directly.
+    A nullptr page has to go through the slow path in readMemory/writeMemory.
+*/
+struct PageTable
+{
+    const uint8_t* read[PAGE_COUNT];
+    uint8_t* write[PAGE_COUNT];
+};
+
+/*
+    A memory bank controller.
+    Writes to 0x0000-0x7FFF go to its registers, and whenever one changes the mapper points
+    the ROM (0x0000-0x7FFF) and external RAM (0xA000-0xBFFF) pages at the right banks,
+    so reading a banked address costs the same as reading any other memory.
+*/
+class Mapper
+{
+    public:
+        Mapper(const uint8_t* rom, uint32_t romBankCount, uint8_t* ram, uint32_t ramSize, PageTable& pages);
+        virtual ~Mapper();
+
+        // Picks the mapper the cartridge header asks for, cycles is the CPU's t-cycle count since power on
+        static std::unique_ptr<Mapper> create(const Cartridge& cartridge, uint8_t* ram, uint32_t ramSize, PageTable& pages,
+                                              const uint64_t& cycles);
+
+        // A write to 0x0000-0x7FFF
+        virtual void writeRegister(uint16_t addr, uint8_t data) = 0;
+
+        // Only called for 0xA000-0xBFFF when the page is not mapped (RAM disabled, MBC2 nibbles, MBC3 clock)
+        virtual uint8_t readRAM(uint16_t addr);
+        virtual void writeRAM(uint16_t addr, uint8_t data);
+
+        virtual void saveState(std::vector<uint8_t>& buffer);
+        virtual void loadState(const uint8_t* &buffer);
+
+        // Battery backed data other than RAM (RTC_SAVE_SIZE bytes kept after the RAM in the .sav)
+        virtual void saveBattery(uint8_t* data);
+        virtual void loadBattery(const uint8_t* data);
+
+    protected:
+        const uint8_t* mROM;
+        uint32_t mROMBankCount;
+        uint8_t* mRAM;
+        uint32_t mRAMSize;
+        PageTable& mPages;
+
+        // Registers, what each one means depends on the mapper
+        uint16_t mROMBank;
+        uint8_t mRAMBank;
+        bool mRAMEnabled;
+        bool mBankMode;
+
+        // Point the pages at the banks the registers select
+        virtual void updatePages() = 0;
+        void mapROM(uint32_t lowBank, uint32_t highBank);
+        void mapRAM(uint32_t bank);
+        void unmapRAM();
+};
+
+// ROM only carts, up to 32 KB with optional RAM that is always enabled
+class MapperNoMBC final : public Mapper
+{
+    public:
+        MapperNoMBC(const uint8_t* rom, uint32_t romBankCount, uint8_t* ram, uint32_t ramSize, PageTable& pages);
+        void writeRegister(uint16_t addr, uint8_t data) override;
+
+    private:
+        void updatePages() override;
+};
+
+/*
+    MBC1, up to 2 MB ROM and 32 KB RAM.
+    mROMBank is the 5 bit BANK1 register, mRAMBank the 2 bit BANK2 register.
+    Multicarts wire BANK1 with only 4 bits, so BANK2 starts at bank 0x10 instead of 0x20.
+*/
+class MapperMBC1 final : public Mapper
+{
+    public:
+        MapperMBC1(const uint8_t* rom, uint32_t romBankCount, uint8_t* ram, uint32_t ramSize, PageTable& pages, bool multicart);
+        void writeRegister(uint16_t addr, uint8_t data) override;
+
+    private:
+        uint8_t mBank2Shift;
+        void updatePages() override;
+};
+
+// MBC2, up to 256 KB ROM with 512 half bytes of RAM built in, so RAM always takes the slow path
+class MapperMBC2 final : public Mapper
+{
+    public:
+        MapperMBC2(const uint8_t* rom, uint32_t romBankCount, uint8_t* ram, uint32_t ramSize, PageTable& pages);
+        void writeRegister(uint16_t addr, uint8_t data) override;
+        uint8_t readRAM(uint16_t addr) override;
+        void writeRAM(uint16_t addr, uint8_t data) override;
+
+    private:
+        void updatePages() override;
+};
+
+/*
+    MBC3, up to 2 MB ROM and 32 KB RAM, RAM bank 0x08-0x0C selects a clock register instead.
+    The clock is never ticked, it is kept as a time (in cycles) plus the cycle count when that time was set,
+    and the registers are only worked out from it when the game latches or writes them.
+*/
+class MapperMBC3 final : public Mapper
+{
+    public:
+        MapperMBC3(const uint8_t* rom, uint32_t romBankCount, uint8_t* ram, uint32_t ramSize, PageTable& pages,
+                   const uint64_t& cycles);
+        void writeRegister(uint16_t addr, uint8_t data) override;
+        uint8_t readRAM(uint16_t addr) override;
+        void writeRAM(uint16_t addr, uint8_t data) override;
+
+        void saveState(std::vector<uint8_t>& buffer) override;
+        void loadState(const uint8_t* &buffer) override;
+
+        void saveBattery(uint8_t* data) override;
+        void loadBattery(const uint8_t* data) override;
+
+    private:
+        const uint64_t& mCycles;
+
+        // Clock time (in cycles) as of mRTCBaseCycle, it has moved on by the cycles run since unless halted
+        uint64_t mRTCCycles;
+        uint64_t mRTCBaseCycle;
+        bool mRTCHalted;
+        bool mDayCarry;
+
+        // Registers the game reads (seconds, minutes, hours, day low, day high/flags)
+        uint8_t mLatchedRTC[5];
+        uint8_t mLastLatchWrite;
+
+        uint64_t getRTCCycles();
+        void setRTCCycles(uint64_t rtcCycles);
+        void getRTCRegisters(uint64_t rtcCycles, uint8_t registers[5]);
+        uint64_t getRTCCycles(const uint8_t registers[5], uint64_t subSecond);
+
+        void updatePages() override;
+};
+
+// MBC5, up to 8 MB ROM (9 bit bank number, bank 0 can be selected) and 128 KB RAM
+class MapperMBC5 final : public Mapper
+{
+    public:
+        MapperMBC5(const uint8_t* rom, uint32_t romBankCount, uint8_t* ram, uint32_t ramSize, PageTable& pages);
+        void writeRegister(uint16_t addr, uint8_t data) override;
+
+    private:
+        void updatePages() override;
+};
+
+#endif
\ No newline at end of file
@@ -27,8 +27,28 @@ PPU::PPU()
     mElapsedModeTime = 0;
     mLCDPPUEn = false;
     cgbMode = false;
+    mRenderEnabled = true;
     reqLCDInterrupt = false;
     reqVBInterrupt = false;
+    mStatLine = false;
+    mLineWriteCount = 0;
+
+    mLineObjectCount = 0;
+    mNextObject = 0;
+    mFifoDot = 0;
+    mFifoX = 0;
+    mFifoStall = 0;
+    mFifoDiscard = 0;
+    mFetchX = 0;
+    mBgLo = 0;
+    mBgHi = 0;
+    mBgCount = 0;
+    std::fill(std::begin(mObjColour), std::end(mObjColour), 0);
+    std::fill(std::begin(mObjFlags), std::end(mObjFlags), 0);
+    mObjHead = 0;
+    mWindowActive = false;
+    mWindowLine = 0;
+    mHBlankTime = MODE_HORI_TIME;
 
     mPixelArray = std::vector<uint8_t>(PPU_SCREENWIDTH * PPU_SCREENHEIGHT * BYTES_PER_PIXEL, 0xFF);
     bgWinArray = std::vector<uint8_t>(PPU_SCREENWIDTH * PPU_SCREENHEIGHT * BYTES_PER_PIXEL, 0xFF);
@@ -40,12 +60,17 @@ PPU::~PPU()
 }
 
 
+template<class Accuracy>
 void PPU::PPUCycle(uint16_t thisCycles, std::vector<uint8_t>& memMap)
 {
     // check if LCD disabled
     mLCDPPUEn = Helper::getBit(memMap[LCDC], 7);
     if(!(mLCDPPUEn))
     {
+        if constexpr(Accuracy::STAT_BLOCKING)
+        {
+            mStatLine = false;
+        }
         return;
     }
 
@@ -59,40 +84,75 @@ void PPU::PPUCycle(uint16_t thisCycles, std::vector<uint8_t>& memMap)
             if(mElapsedModeTime >= MODE_OAM_TIME)
             {
                 mElapsedModeTime -= MODE_OAM_TIME;
-                setPPUMode(MODE_DRAW_PIX, memMap);
+                setPPUMode<Accuracy>(MODE_DRAW_PIX, memMap);
+                if constexpr(Accuracy::PIXEL_FIFO)
+                {
+                    startFifoLine(memMap);
+                }
             }
             
             break;
 
-        // mode 3, takes between 172-289 dots (we will only emulate the 172 dots)
+        // mode 3, takes between 172-289 dots (the line renderer only emulates the 172 dots)
         case MODE_DRAW_PIX:
-            if(mElapsedModeTime >= MODE_DRAW_TIME)
+            if constexpr(Accuracy::PIXEL_FIFO)
+            {
+                // no line is shorter than 172 dots, after that the FIFO is run to find out where it ends
+                if(mElapsedModeTime >= MODE_DRAW_TIME)
+                {
+                    renderTo(mElapsedModeTime, memMap);
+                    if(mFifoX == PPU_SCREENWIDTH)
+                    {
+                        mElapsedModeTime -= mFifoDot;
+                        mHBlankTime = SCANLINE_TIME - MODE_OAM_TIME - mFifoDot;
+                        if(mWindowActive)
+                        {
+                            mWindowLine++;
+                        }
+                        setPPUMode<Accuracy>(MODE_HORI_BLANK, memMap);
+                    }
+                }
+            }
+            else if(mElapsedModeTime >= MODE_DRAW_TIME)
             {
                 mElapsedModeTime -= MODE_DRAW_TIME;
-                drawScanline(memMap);
-                setPPUMode(MODE_HORI_BLANK, memMap);
+                if(mRenderEnabled)
+                {
+                    drawScanline(memMap);
+                }
+                mLineWriteCount = 0;
+                setPPUMode<Accuracy>(MODE_HORI_BLANK, memMap);
             }
             break;
         
-        // mode 0, takes 87-204 dots (we do 204 dots so they add up to 456)
+        // mode 0, takes 87-204 dots (the line renderer does 204 dots so they add up to 456)
         case MODE_HORI_BLANK:
-            if(mElapsedModeTime >= MODE_HORI_BLANK)
+        {
+            int16_t hBlankEnd{MODE_HORI_BLANK};
+            int16_t hBlankTime{MODE_HORI_TIME};
+            if constexpr(Accuracy::PIXEL_FIFO)
+            {
+                hBlankEnd = mHBlankTime;
+                hBlankTime = mHBlankTime;
+            }
+            if(mElapsedModeTime >= hBlankEnd)
             {
-                mElapsedModeTime -= MODE_HORI_TIME;
+                mElapsedModeTime -= hBlankTime;
                 // increment scanline counter
                 memMap[SCANLINE_REGISTER]++;
                 if(memMap[SCANLINE_REGISTER] == 144)
                 {
-                    setPPUMode(MODE_VERT_BLANK, memMap);
+                    setPPUMode<Accuracy>(MODE_VERT_BLANK, memMap);
                 }
                 else
                 {
-                    setPPUMode(MODE_OAM_SCAN, memMap);
+                    setPPUMode<Accuracy>(MODE_OAM_SCAN, memMap);
                 }
 
                 
             }
             break;
+        }
 
         // mode 1, 4560 dots (10 scanlines)
         case MODE_VERT_BLANK:
@@ -104,12 +164,31 @@ void PPU::PPUCycle(uint16_t thisCycles, std::vector<uint8_t>& memMap)
                 if(memMap[SCANLINE_REGISTER] == 154)
                 {
                     memMap[0xFF44] = 0;
-                    setPPUMode(MODE_OAM_SCAN, memMap);
+                    if constexpr(Accuracy::PIXEL_FIFO)
+                    {
+                        mWindowLine = 0;
+                    }
+                    setPPUMode<Accuracy>(MODE_OAM_SCAN, memMap);
                 }
 
             }
             break;
     }
+    // the coincidence flag always follows LY, the interrupt only fires when the STAT line goes high
+    if constexpr(Accuracy::STAT_BLOCKING)
+    {
+        if(memMap[SCANLINE_REGISTER] == memMap[0xFF45])
+        {
+            Helper::setBit(memMap[LCD_STATUS], 2);
+        }
+        else
+        {
+            Helper::resetBit(memMap[LCD_STATUS], 2);
+        }
+        updateStatLine(memMap);
+        return;
+    }
+
     // check if LYC = LY and we should call interrupt due to it
     if((Helper::getBit(memMap[LCD_STATUS], 6)) && (memMap[SCANLINE_REGISTER] == memMap[0xFF45]))
     {
@@ -124,6 +203,68 @@ void PPU::PPUCycle(uint16_t thisCycles, std::vector<uint8_t>& memMap)
     
 }
 
+template void PPU::PPUCycle<FastAccuracy>(uint16_t thisCycles, std::vector<uint8_t>& memMap);
+template void PPU::PPUCycle<CycleAccuracy>(uint16_t thisCycles, std::vector<uint8_t>& memMap);
+
+void PPU::updateStatLine(const std::vector<uint8_t>& memMap)
+{
+    uint8_t status{memMap[LCD_STATUS]};
+    uint8_t mode{status & 0b11};
+    bool statLine{(Helper::getBit(status, 6) && Helper::getBit(status, 2)) ||
+                  ((mode == MODE_HORI_BLANK) && Helper::getBit(status, 3)) ||
+                  ((mode == MODE_VERT_BLANK) && Helper::getBit(status, 4)) ||
+                  ((mode == MODE_OAM_SCAN) && Helper::getBit(status, 5))};
+    if(statLine && !mStatLine)
+    {
+        reqLCDInterrupt = true;
+    }
+    mStatLine = statLine;
+}
+
+
+uint16_t PPU::getCyclesUntilModeChange(const std::vector<uint8_t>& memMap)
+{
+    if(!Helper::getBit(memMap[LCDC], 7))
+    {
+        return 0xFFFF;
+    }
+
+    // same limits PPUCycle checks against
+    int16_t modeTime{0};
+    switch(getPPUMode(memMap))
+    {
+        case MODE_OAM_SCAN:
+            modeTime = MODE_OAM_TIME;
+            break;
+        case MODE_DRAW_PIX:
+            modeTime = MODE_DRAW_TIME;
+            break;
+        case MODE_HORI_BLANK:
+            modeTime = MODE_HORI_BLANK;
+            break;
+        case MODE_VERT_BLANK:
+            modeTime = MODE_VERT_TIME;
+            break;
+    }
+
+    if(mElapsedModeTime >= modeTime)
+    {
+        return 0;
+    }
+    return (modeTime - mElapsedModeTime - 1) / 4;
+}
+
+uint16_t PPU::getCatchUpDeadline(const std::vector<uint8_t>& memMap)
+{
+    if(Helper::getBit(memMap[LCDC], 7) && Helper::getBit(memMap[LCD_STATUS], 6) && (memMap[SCANLINE_REGISTER] == memMap[0xFF45]))
+    {
+        return 0;
+    }
+
+    // one past the last m-cycle that does not change the mode
+    uint16_t cycles{getCyclesUntilModeChange(memMap)};
+    return (cycles == 0xFFFF) ? cycles : cycles + 1;
+}
 
 uint8_t PPU::getPPUMode(const std::vector<uint8_t>& memMap)
 {
@@ -131,11 +272,22 @@ uint8_t PPU::getPPUMode(const std::vector<uint8_t>& memMap)
     return (statByte & 0b11);
 }
 
+template<class Accuracy>
 void PPU::setPPUMode(uint8_t newMode, std::vector<uint8_t>& memMap)
 {
     memMap[LCD_STATUS] &= ~(0b11); // resets PPU mode bits
     memMap[LCD_STATUS] |= newMode;
 
+    // with STAT blocking the mode is only one of the STAT line's sources, PPUCycle checks the line after this
+    if constexpr(Accuracy::STAT_BLOCKING)
+    {
+        if(newMode == MODE_VERT_BLANK)
+        {
+            reqVBInterrupt = true;
+        }
+        return;
+    }
+
     uint8_t status{memMap[LCD_STATUS]};
 
     // set potential interrupt depending on newMode
@@ -163,7 +315,58 @@ void PPU::setPPUMode(uint8_t newMode, std::vector<uint8_t>& memMap)
     }
 }
 
+void PPU::logRegisterWrite(uint16_t addr, uint8_t data, uint16_t pendingCycles, const std::vector<uint8_t>& memMap)
+{
+    if(!mLCDPPUEn || (getPPUMode(memMap) != MODE_DRAW_PIX) || (mLineWriteCount == MAX_LINE_WRITES))
+    {
+        return;
+    }
+
+    // only the registers the line is drawn from
+    if((addr == LCD_STATUS) || ((addr >= SCANLINE_REGISTER) && (addr <= 0xFF46)))
+    {
+        return;
+    }
+
+    if(mLineWriteCount == 0)
+    {
+        std::copy(&memMap[LCDC], &memMap[LCDC] + LCD_REGISTER_COUNT, mLineStartRegisters);
+    }
+    mLineWrites[mLineWriteCount] = {mElapsedModeTime + (pendingCycles * 4), addr - LCDC, data};
+    mLineWriteCount++;
+}
+
 void PPU::drawScanline(std::vector<uint8_t> &memMap)
+{
+    if(mLineWriteCount == 0)
+    {
+        drawSpan(memMap, 0, PPU_SCREENWIDTH);
+        return;
+    }
+
+    // each span is drawn with the registers as they were at its first pixel, then they are put back
+    uint8_t finalRegisters[LCD_REGISTER_COUNT];
+    std::copy(&memMap[LCDC], &memMap[LCDC] + LCD_REGISTER_COUNT, finalRegisters);
+    std::copy(mLineStartRegisters, mLineStartRegisters + LCD_REGISTER_COUNT, &memMap[LCDC]);
+
+    uint8_t startX{0};
+    for(uint8_t i{0}; i < mLineWriteCount; i++)
+    {
+        const RegisterWrite& write{mLineWrites[i]};
+        uint8_t x{(write.dot <= LINE_DOT_OFFSET) ? 0 : std::min<uint16_t>(write.dot - LINE_DOT_OFFSET, PPU_SCREENWIDTH)};
+        if(x > startX)
+        {
+            drawSpan(memMap, startX, x);
+            startX = x;
+        }
+        memMap[LCDC + write.reg] = write.value;
+    }
+    drawSpan(memMap, startX, PPU_SCREENWIDTH);
+
+    std::copy(finalRegisters, finalRegisters + LCD_REGISTER_COUNT, &memMap[LCDC]);
+}
+
+void PPU::drawSpan(std::vector<uint8_t> &memMap, uint8_t startX, uint8_t endX)
 {
     // overwrites all other conflicting enables
     bool bgWinEnable{Helper::getBit(memMap[LCDC], 0)};
@@ -172,10 +375,10 @@ void PPU::drawScanline(std::vector<uint8_t> &memMap)
     
     if(bgWinEnable)
     {
-        renderBG(memMap);
+        renderBG(memMap, startX, endX);
         if(winEnable)
         {
-            renderWindow(memMap);
+            renderWindow(memMap, startX, endX);
         }
     }
 
@@ -183,7 +386,7 @@ void PPU::drawScanline(std::vector<uint8_t> &memMap)
     else
     {
         uint32_t pixelArrayIndex;
-        for(uint8_t i{0}; i < 160; i++)
+        for(uint8_t i{startX}; i < endX; i++)
         {
             pixelArrayIndex = ((PPU_SCREENWIDTH * memMap[SCANLINE_REGISTER]) + i)*4;
             bgWinArray[pixelArrayIndex] = 0xFF;
@@ -193,19 +396,21 @@ void PPU::drawScanline(std::vector<uint8_t> &memMap)
         }
     }
 
-    // copy background and window array over, then let objects draw over
-    mPixelArray = bgWinArray;
+    // copy this span of background and window over, then let objects draw over
+    uint32_t spanStart{((PPU_SCREENWIDTH * memMap[SCANLINE_REGISTER]) + startX) * BYTES_PER_PIXEL};
+    uint32_t spanEnd{((PPU_SCREENWIDTH * memMap[SCANLINE_REGISTER]) + endX) * BYTES_PER_PIXEL};
+    std::copy(bgWinArray.begin() + spanStart, bgWinArray.begin() + spanEnd, mPixelArray.begin() + spanStart);
 
     if(objEnable)
     {
-        renderObj(memMap);
+        renderObj(memMap, startX, endX);
     }
 
     // Because of OpenGL's top left coordinate system
     //flipY();
 }
 
-void PPU::renderBG(std::vector<uint8_t> &memMap)
+void PPU::renderBG(std::vector<uint8_t> &memMap, uint8_t startX, uint8_t endX)
 {
     uint16_t bgTileMapArea{0};
     switch(Helper::getBit(memMap[LCDC], 3))
@@ -230,7 +435,7 @@ void PPU::renderBG(std::vector<uint8_t> &memMap)
     }
     uint8_t yPos{((memMap[SCANLINE_REGISTER] + memMap[SCY]) / 8) % 32};
 
-    for(uint8_t i{0}; i < 160; i++) // draw each pixel along this horizontal line
+    for(uint8_t i{startX}; i < endX; i++) // draw each pixel of the span along this horizontal line
     {
         uint8_t xPos{((i + memMap[SCX]) / 8) % 32};
 
@@ -296,7 +501,7 @@ void PPU::renderBG(std::vector<uint8_t> &memMap)
     }
 }
 
-void PPU::renderWindow(std::vector<uint8_t> &memMap)
+void PPU::renderWindow(std::vector<uint8_t> &memMap, uint8_t startX, uint8_t endX)
 {
     // if we are off the screen
     if(memMap[SCANLINE_REGISTER] < memMap[GBWINDOW_Y])
@@ -333,7 +538,7 @@ void PPU::renderWindow(std::vector<uint8_t> &memMap)
     // this is where the window starts
     uint8_t windowX{memMap[GBWINDOW_X] - 7}; // for some reason the x offset is +7 (x=7 corresponds to leftmost)
 
-    for(uint8_t i{0}; i < 160; i++)
+    for(uint8_t i{startX}; i < endX; i++)
     {
         if(windowX < i)
         {
@@ -389,7 +594,7 @@ void PPU::renderWindow(std::vector<uint8_t> &memMap)
     }
 }
 
-void PPU::renderObj(std::vector<uint8_t> &memMap)
+void PPU::renderObj(std::vector<uint8_t> &memMap, uint8_t startX, uint8_t endX)
 {
     bool tallSprite{false}; // 8x8 pixels
     int spriteHeight{8};
@@ -448,7 +653,7 @@ void PPU::renderObj(std::vector<uint8_t> &memMap)
             for(uint8_t curX{0}; curX < 8; curX++)
             {
                 int16_t xIndex = curX + xPos;
-                if(xIndex < 160 && xIndex >= 0)
+                if(xIndex < endX && xIndex >= startX)
                 {
                     uint8_t curBit = 7 - curX;
 
@@ -487,6 +692,248 @@ void PPU::renderObj(std::vector<uint8_t> &memMap)
     }
 }
 
+// one pixel of one of the 4 shades, the same format the line renderer writes
+static void setShade(std::vector<uint8_t> &pixels, uint32_t index, uint8_t shade)
+{
+    if(GREENSCALE)
+    {
+        pixels[index + 3] = mDMGGreenscale[shade][0];
+        pixels[index + 2] = mDMGGreenscale[shade][1];
+        pixels[index + 1] = mDMGGreenscale[shade][2];
+    }
+    else
+    {
+        pixels[index + 3] = mDMGGreyscale[shade];
+        pixels[index + 2] = mDMGGreyscale[shade];
+        pixels[index + 1] = mDMGGreyscale[shade];
+    }
+    pixels[index] = 0xFF;
+}
+
+void PPU::startFifoLine(const std::vector<uint8_t>& memMap)
+{
+    // OAM scan: the first 10 objects on this line in OAM order, fetched left to right (OAM order breaks ties)
+    uint8_t line{memMap[SCANLINE_REGISTER]};
+    uint8_t height{Helper::getBit(memMap[LCDC], 2) ? 16 : 8};
+    mLineObjectCount = 0;
+    for(uint16_t i{0}; (i < 160) && (mLineObjectCount < MAX_LINE_OBJECTS); i += 4)
+    {
+        uint8_t objY{memMap[OAM_START + i]};
+        if((line + 16 >= objY) && (line + 16 < objY + height))
+        {
+            LineObject object{objY, memMap[OAM_START + i + 1], memMap[OAM_START + i + 2], memMap[OAM_START + i + 3]};
+            uint8_t slot{mLineObjectCount};
+            while((slot != 0) && (mLineObjects[slot - 1].x > object.x))
+            {
+                mLineObjects[slot] = mLineObjects[slot - 1];
+                slot--;
+            }
+            mLineObjects[slot] = object;
+            mLineObjectCount++;
+        }
+    }
+    mNextObject = 0;
+
+    mFifoDot = 0;
+    mFifoX = 0;
+    mFifoStall = FIFO_LINE_START_DOTS;
+    mFifoDiscard = memMap[SCX] % 8;
+    mFetchX = 0;
+    mBgCount = 0;
+    std::fill(std::begin(mObjColour), std::end(mObjColour), 0);
+    mObjHead = 0;
+    mWindowActive = false;
+}
+
+void PPU::catchUpLine(const std::vector<uint8_t>& memMap)
+{
+    if(mLCDPPUEn && (getPPUMode(memMap) == MODE_DRAW_PIX) && (mElapsedModeTime > 0))
+    {
+        renderTo(mElapsedModeTime, memMap);
+    }
+}
+
+void PPU::renderTo(uint16_t dot, const std::vector<uint8_t>& memMap)
+{
+    while((mFifoDot < dot) && (mFifoX < PPU_SCREENWIDTH))
+    {
+        // nothing moves while a fetch is going on
+        if(mFifoStall != 0)
+        {
+            uint16_t dots{std::min<uint16_t>(mFifoStall, dot - mFifoDot)};
+            mFifoStall -= dots;
+            mFifoDot += dots;
+            continue;
+        }
+
+        uint8_t lcdc{memMap[LCDC]};
+        uint8_t windowX{memMap[GBWINDOW_X]};
+        bool windowOnLine{Helper::getBit(lcdc, 5) && (memMap[SCANLINE_REGISTER] >= memMap[GBWINDOW_Y])};
+
+        // the window takes over from the background once it is reached, the FIFO starts again from its first tile
+        if(!mWindowActive && windowOnLine && (mFifoX + 7 >= windowX))
+        {
+            mWindowActive = true;
+            mFetchX = 0;
+            mBgCount = 0;
+            mFifoDiscard = (windowX < 7) ? 7 - windowX : 0;
+            mFifoStall = FIFO_FETCH_DOTS;
+            continue;
+        }
+
+        if(mBgCount == 0)
+        {
+            fetchBgTile(memMap);
+        }
+
+        if(mFifoDiscard != 0)
+        {
+            mBgLo <<= 1;
+            mBgHi <<= 1;
+            mBgCount--;
+            mFifoDiscard--;
+            mFifoDot++;
+            continue;
+        }
+
+        // objects are fetched when the line gets to them (ones hanging off the left at pixel 0), the wait depends on where the background fetch is
+        if((mNextObject < mLineObjectCount) && (mLineObjects[mNextObject].x <= mFifoX + 8))
+        {
+            if(Helper::getBit(lcdc, 1))
+            {
+                fetchObject(mLineObjects[mNextObject], memMap);
+                uint8_t tileOffset{mWindowActive ? (mFifoX + 7 - windowX) % 8 : (mFifoX + memMap[SCX]) % 8};
+                mFifoStall = FIFO_OBJ_DOTS + 5 - std::min<uint8_t>(5, tileOffset);
+            }
+            mNextObject++;
+            continue;
+        }
+
+        // then pixels go out one a dot, as many as there are before the next fetch (or the dot being caught up to)
+        uint16_t count{std::min<uint16_t>(dot - mFifoDot, mBgCount)};
+        count = std::min<uint16_t>(count, PPU_SCREENWIDTH - mFifoX);
+        if(mNextObject < mLineObjectCount)
+        {
+            count = std::min<uint16_t>(count, mLineObjects[mNextObject].x - 8 - mFifoX);
+        }
+        if(!mWindowActive && windowOnLine)
+        {
+            count = std::min<uint16_t>(count, windowX - 7 - mFifoX);
+        }
+        outputPixels(count, memMap);
+    }
+}
+
+void PPU::fetchBgTile(const std::vector<uint8_t>& memMap)
+{
+    // the map, scroll and tile data area are read at every fetch, so writes mid-line show up a tile later
+    uint8_t lcdc{memMap[LCDC]};
+    uint16_t tileMapArea;
+    uint8_t tileX;
+    uint8_t tileY;
+    if(mWindowActive)
+    {
+        tileMapArea = Helper::getBit(lcdc, 6) ? 0x9C00 : 0x9800;
+        tileX = mFetchX;
+        tileY = mWindowLine;
+    }
+    else
+    {
+        tileMapArea = Helper::getBit(lcdc, 3) ? 0x9C00 : 0x9800;
+        tileX = (memMap[SCX] / 8) + mFetchX;
+        tileY = memMap[SCANLINE_REGISTER] + memMap[SCY];
+    }
+    uint8_t tileNumber{memMap[tileMapArea + ((tileY / 8) * 32) + (tileX % 32)]};
+
+    uint16_t tileDataIndex;
+    if(Helper::getBit(lcdc, 4))
+    {
+        tileDataIndex = VRAM_START + (tileNumber * 16);
+    }
+    else
+    {
+        tileDataIndex = 0x9000 + ((int8_t)tileNumber * 16);
+    }
+    tileDataIndex += (tileY % 8) * 2;
+
+    mBgLo = memMap[tileDataIndex];
+    mBgHi = memMap[tileDataIndex + 1];
+    mBgCount = 8;
+    mFetchX++;
+}
+
+void PPU::fetchObject(const LineObject& object, const std::vector<uint8_t>& memMap)
+{
+    bool tallSprite{Helper::getBit(memMap[LCDC], 2)};
+    uint8_t height{tallSprite ? 16 : 8};
+    uint8_t tileNumber{tallSprite ? (object.tile & 0xFE) : object.tile};
+    uint8_t tileYOffset{(memMap[SCANLINE_REGISTER] + 16 - object.y) % height};
+    if(Helper::getBit(object.flags, 6))
+    {
+        tileYOffset = (height - 1) - tileYOffset;
+    }
+    uint16_t tilePointer{VRAM_START + (tileNumber * 16) + (tileYOffset * 2)};
+    uint8_t loData{memMap[tilePointer]};
+    uint8_t hiData{memMap[tilePointer + 1]};
+
+    // an object already in the FIFO keeps its pixels, only see-through ones are filled in
+    uint8_t skipped{mFifoX + 8 - object.x};
+    for(uint8_t curX{skipped}; curX < 8; curX++)
+    {
+        uint8_t curBit{Helper::getBit(object.flags, 5) ? curX : 7 - curX};
+        uint8_t colorIndex{(Helper::getBit(hiData, curBit) << 1) | Helper::getBit(loData, curBit)};
+        uint8_t slot{(mObjHead + curX - skipped) % 8};
+        if(mObjColour[slot] == 0)
+        {
+            mObjColour[slot] = colorIndex;
+            mObjFlags[slot] = object.flags;
+        }
+    }
+}
+
+void PPU::outputPixels(uint8_t count, const std::vector<uint8_t>& memMap)
+{
+    // the palettes and enables are read as the pixels go out
+    uint8_t lcdc{memMap[LCDC]};
+    bool bgWinEnable{Helper::getBit(lcdc, 0)};
+    bool objEnable{Helper::getBit(lcdc, 1)};
+    uint8_t bgPalette{memMap[BGP]};
+    uint8_t objPalettes[2]{memMap[OBP0], memMap[OBP1]};
+    uint32_t pixelIndex{((PPU_SCREENWIDTH * memMap[SCANLINE_REGISTER]) + mFifoX) * BYTES_PER_PIXEL};
+
+    for(uint8_t i{0}; i < count; i++)
+    {
+        uint8_t colorIndex{((mBgHi >> 7) << 1) | (mBgLo >> 7)};
+        mBgLo <<= 1;
+        mBgHi <<= 1;
+        if(!bgWinEnable)
+        {
+            colorIndex = 0;
+        }
+        uint8_t shade{(bgPalette >> (colorIndex * 2)) & 0b11};
+
+        // objects behind the background only show through its colour 0
+        uint8_t objColour{mObjColour[mObjHead]};
+        uint8_t objFlags{mObjFlags[mObjHead]};
+        if(objEnable && (objColour != 0) && !(Helper::getBit(objFlags, 7) && (colorIndex != 0)))
+        {
+            shade = (objPalettes[Helper::getBit(objFlags, 4)] >> (objColour * 2)) & 0b11;
+        }
+        mObjColour[mObjHead] = 0;
+        mObjHead = (mObjHead + 1) % 8;
+
+        if(mRenderEnabled)
+        {
+            setShade(mPixelArray, pixelIndex, shade);
+        }
+        pixelIndex += BYTES_PER_PIXEL;
+    }
+
+    mBgCount -= count;
+    mFifoX += count;
+    mFifoDot += count;
+}
+
 void PPU::flipY()
 {
     std::vector<uint8_t> tempVec(PPU_SCREENHEIGHT * PPU_SCREENWIDTH * 4, 0xFF);
@@ -506,6 +953,66 @@ void PPU::flipY()
     mPixelArray = tempVec;
 }
 
+void PPU::setRenderEnabled(bool enabled)
+{
+    mRenderEnabled = enabled;
+}
+
+void PPU::saveState(std::vector<uint8_t> &buffer)
+{
+    Helper::writeState(buffer, &mElapsedModeTime, sizeof(mElapsedModeTime));
+    Helper::writeState(buffer, &mLCDPPUEn, sizeof(mLCDPPUEn));
+    Helper::writeState(buffer, &reqLCDInterrupt, sizeof(reqLCDInterrupt));
+    Helper::writeState(buffer, &reqVBInterrupt, sizeof(reqVBInterrupt));
+    Helper::writeState(buffer, &mStatLine, sizeof(mStatLine));
+
+    // the pixel FIFO can be saved in the middle of a line
+    Helper::writeState(buffer, mLineObjects, sizeof(mLineObjects));
+    Helper::writeState(buffer, &mLineObjectCount, sizeof(mLineObjectCount));
+    Helper::writeState(buffer, &mNextObject, sizeof(mNextObject));
+    Helper::writeState(buffer, &mFifoDot, sizeof(mFifoDot));
+    Helper::writeState(buffer, &mFifoX, sizeof(mFifoX));
+    Helper::writeState(buffer, &mFifoStall, sizeof(mFifoStall));
+    Helper::writeState(buffer, &mFifoDiscard, sizeof(mFifoDiscard));
+    Helper::writeState(buffer, &mFetchX, sizeof(mFetchX));
+    Helper::writeState(buffer, &mBgLo, sizeof(mBgLo));
+    Helper::writeState(buffer, &mBgHi, sizeof(mBgHi));
+    Helper::writeState(buffer, &mBgCount, sizeof(mBgCount));
+    Helper::writeState(buffer, mObjColour, sizeof(mObjColour));
+    Helper::writeState(buffer, mObjFlags, sizeof(mObjFlags));
+    Helper::writeState(buffer, &mObjHead, sizeof(mObjHead));
+    Helper::writeState(buffer, &mWindowActive, sizeof(mWindowActive));
+    Helper::writeState(buffer, &mWindowLine, sizeof(mWindowLine));
+    Helper::writeState(buffer, &mHBlankTime, sizeof(mHBlankTime));
+}
+
+void PPU::loadState(const uint8_t* &buffer)
+{
+    Helper::readState(buffer, &mElapsedModeTime, sizeof(mElapsedModeTime));
+    Helper::readState(buffer, &mLCDPPUEn, sizeof(mLCDPPUEn));
+    Helper::readState(buffer, &reqLCDInterrupt, sizeof(reqLCDInterrupt));
+    Helper::readState(buffer, &reqVBInterrupt, sizeof(reqVBInterrupt));
+    Helper::readState(buffer, &mStatLine, sizeof(mStatLine));
+
+    Helper::readState(buffer, mLineObjects, sizeof(mLineObjects));
+    Helper::readState(buffer, &mLineObjectCount, sizeof(mLineObjectCount));
+    Helper::readState(buffer, &mNextObject, sizeof(mNextObject));
+    Helper::readState(buffer, &mFifoDot, sizeof(mFifoDot));
+    Helper::readState(buffer, &mFifoX, sizeof(mFifoX));
+    Helper::readState(buffer, &mFifoStall, sizeof(mFifoStall));
+    Helper::readState(buffer, &mFifoDiscard, sizeof(mFifoDiscard));
+    Helper::readState(buffer, &mFetchX, sizeof(mFetchX));
+    Helper::readState(buffer, &mBgLo, sizeof(mBgLo));
+    Helper::readState(buffer, &mBgHi, sizeof(mBgHi));
+    Helper::readState(buffer, &mBgCount, sizeof(mBgCount));
+    Helper::readState(buffer, mObjColour, sizeof(mObjColour));
+    Helper::readState(buffer, mObjFlags, sizeof(mObjFlags));
+    Helper::readState(buffer, &mObjHead, sizeof(mObjHead));
+    Helper::readState(buffer, &mWindowActive, sizeof(mWindowActive));
+    Helper::readState(buffer, &mWindowLine, sizeof(mWindowLine));
+    Helper::readState(buffer, &mHBlankTime, sizeof(mHBlankTime));
+}
+
 void PPU::displayDebug()
 {
     if(mPixelArray[0] == 0xFF)
@@ -515,5 +1022,4 @@ void PPU::displayDebug()
     else{
         std::fill(mPixelArray.begin(), mPixelArray.end(), 0xFF);
     }
-}
-
+}
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <vector>
 
+#include "Accuracy.hpp"
+
 /* GREENSCALE OR GREYSCALE */
 constexpr bool GREENSCALE = true;
 
@@ -40,14 +42,29 @@ constexpr uint16_t MODE_VERT_TIME = 456; // we do this one ten times, each time
 constexpr uint16_t MODE_OAM_TIME = 80;
 constexpr uint16_t MODE_DRAW_TIME = 172;
 
+/* PIXEL FIFO */
+constexpr uint8_t FIFO_LINE_START_DOTS = 12;    // the first tile is fetched twice before any pixel goes out
+constexpr uint8_t FIFO_FETCH_DOTS = 6;          // one tile fetch, paid again when the window starts
+constexpr uint8_t FIFO_OBJ_DOTS = 6;            // one object fetch, plus up to 5 while the background fetch in progress finishes
+constexpr uint8_t MAX_LINE_OBJECTS = 10;
+constexpr uint16_t BGP = 0xFF47;
+
+/* MID-LINE WRITES */
+constexpr uint8_t MAX_LINE_WRITES = 16;
+constexpr uint8_t LCD_REGISTER_COUNT = 12;     // 0xFF40-0xFF4B
+constexpr uint8_t LINE_DOT_OFFSET = MODE_DRAW_TIME - PPU_SCREENWIDTH;  // dots into mode 3 before the first pixel
+
 class PPU
 {
+    // the checks in UnitTesting look at where it is in the line
+    friend class CoreTest;
+
     public:
         PPU();
         ~PPU();
     
-        // This happens on every frame
-        void PPUCycle(uint16_t thisCycles, std::vector<uint8_t>& memMap);
+        // This happens on every frame, the accurate PPU also has STAT interrupt blocking
+        template<class Accuracy = FastAccuracy> void PPUCycle(uint16_t thisCycles, std::vector<uint8_t>& memMap);
         std::vector<uint8_t> mPixelArray;
         std::vector<uint8_t> bgWinArray;
         bool reqLCDInterrupt;
@@ -55,23 +72,94 @@ class PPU
 
         void displayDebug();
 
+        // m-cycles that can go by (in one PPUCycle call or many) before the mode changes, LCD off never changes
+        uint16_t getCyclesUntilModeChange(const std::vector<uint8_t>& memMap);
+
+        // m-cycles the PPU can be left behind by and caught up in one PPUCycle call with the same result,
+        // 0 while every call raises the LYC interrupt again
+        uint16_t getCatchUpDeadline(const std::vector<uint8_t>& memMap);
+
+        // Frames nobody will see (run-ahead) can skip drawing, timing and interrupts are unaffected
+        void setRenderEnabled(bool enabled);
+
+        // The line renderer draws the line in spans split where LCD registers were written during mode 3,
+        // pendingCycles is the m-cycle of the current instruction the write lands in, the PPU is still at its start
+        void logRegisterWrite(uint16_t addr, uint8_t data, uint16_t pendingCycles, const std::vector<uint8_t>& memMap);
+
+        // The pixel FIFO draws the line up to now with the registers as they were, before one of them is written
+        void catchUpLine(const std::vector<uint8_t>& memMap);
+
+        // Save state support (the pixel arrays are output, so they are not saved)
+        void saveState(std::vector<uint8_t> &buffer);
+        void loadState(const uint8_t* &buffer);
+
     private:
         uint8_t getPPUMode(const std::vector<uint8_t>& memMap);
-        void setPPUMode(uint8_t newMode, std::vector<uint8_t>& memMap);
+        template<class Accuracy> void setPPUMode(uint8_t newMode, std::vector<uint8_t>& memMap);
+        // the STAT interrupt sources ORed together, the interrupt only fires when this goes high
+        bool mStatLine;
+        void updateStatLine(const std::vector<uint8_t>& memMap);
         
         // Timers
         int16_t mElapsedModeTime;
         
         bool mLCDPPUEn;
         bool cgbMode;
+        bool mRenderEnabled;
+
+        // LCD register writes during this line's mode 3, oldest first (reg is the offset from LCDC)
+        struct RegisterWrite
+        {
+            uint16_t dot;
+            uint8_t reg;
+            uint8_t value;
+        };
+        RegisterWrite mLineWrites[MAX_LINE_WRITES];
+        uint8_t mLineWriteCount;
+        uint8_t mLineStartRegisters[LCD_REGISTER_COUNT];    // as they were before the first write
 
         void drawScanline(std::vector<uint8_t> &memMap);
-        void renderBG(std::vector<uint8_t> &memMap);
-        void renderWindow(std::vector<uint8_t> &memMap);
-        void renderObj(std::vector<uint8_t> &memMap);
+        void drawSpan(std::vector<uint8_t> &memMap, uint8_t startX, uint8_t endX);
+        void renderBG(std::vector<uint8_t> &memMap, uint8_t startX, uint8_t endX);
+        void renderWindow(std::vector<uint8_t> &memMap, uint8_t startX, uint8_t endX);
+        void renderObj(std::vector<uint8_t> &memMap, uint8_t startX, uint8_t endX);
 
         void flipY();
 
+        // Pixel FIFO (the accurate PPU). Nothing is stepped through until mode 3 could be over or a register
+        // is written in the middle of a line, then it runs from where it stopped a tile or a run of pixels at a time
+        struct LineObject
+        {
+            uint8_t y;
+            uint8_t x;
+            uint8_t tile;
+            uint8_t flags;
+        };
+        LineObject mLineObjects[MAX_LINE_OBJECTS];  // found by the OAM scan, left to right
+        uint8_t mLineObjectCount;
+        uint8_t mNextObject;
+
+        uint16_t mFifoDot;          // dots into mode 3 the line is drawn up to
+        uint8_t mFifoX;             // next pixel on the line
+        uint16_t mFifoStall;        // dots of fetching the pixels are waiting on
+        uint8_t mFifoDiscard;       // pixels thrown away before the line starts (fine SCX, window left of the screen)
+        uint8_t mFetchX;            // tile column the background fetcher is on
+        uint8_t mBgLo;              // background FIFO, one tile row shifted out from bit 7
+        uint8_t mBgHi;
+        uint8_t mBgCount;
+        uint8_t mObjColour[8];      // object FIFO, a ring from mObjHead, 0 is see-through
+        uint8_t mObjFlags[8];
+        uint8_t mObjHead;
+        bool mWindowActive;
+        uint8_t mWindowLine;        // window lines drawn this frame
+        uint16_t mHBlankTime;       // what mode 3 left of the line
+
+        void startFifoLine(const std::vector<uint8_t>& memMap);
+        void renderTo(uint16_t dot, const std::vector<uint8_t>& memMap);
+        void fetchBgTile(const std::vector<uint8_t>& memMap);
+        void fetchObject(const LineObject& object, const std::vector<uint8_t>& memMap);
+        void outputPixels(uint8_t count, const std::vector<uint8_t>& memMap);
+
 };
 
 
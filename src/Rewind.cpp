@@ -0,0 +1,291 @@
+#include "Rewind.hpp"
+#include <cstring>
+
+/*
+    Encoded format, repeated until the end of the state:
+        uint16 number of unchanged bytes to skip
+        uint16 number of changed bytes that follow
+        the changed bytes (already XORed with the base)
+    Runs longer than 0xFFFF are split up.
+*/
+constexpr uint32_t MAX_RUN = 0xFFFF;
+
+// a literal run only stops once this many unchanged bytes are in a row,
+// so short gaps do not cost a whole new 4 byte header
+constexpr uint32_t MIN_ZERO_RUN = 4;
+
+Rewind::Rewind(uint32_t bufferSize, uint16_t captureInterval, uint16_t keyframeInterval)
+{
+    mBuffer = std::vector<uint8_t>(bufferSize, 0);
+    mWritePos = 0;
+    mUsedBytes = 0;
+
+    mCaptureInterval = captureInterval;
+    mKeyframeInterval = keyframeInterval;
+    mFramesSinceCapture = 0;
+    mSinceKeyframe = 0;
+}
+
+Rewind::~Rewind()
+{
+
+}
+
+bool Rewind::shouldCapture()
+{
+    mFramesSinceCapture++;
+    if(mFramesSinceCapture >= mCaptureInterval)
+    {
+        mFramesSinceCapture = 0;
+        return true;
+    }
+    return false;
+}
+
+void Rewind::capture(const std::vector<uint8_t>& state)
+{
+    // a state of a different size means a different game, the old history is useless
+    if(state.size() != mLastState.size())
+    {
+        clear();
+        mZeroState = std::vector<uint8_t>(state.size(), 0);
+    }
+
+    bool keyframe{mEntries.empty() || (mSinceKeyframe >= mKeyframeInterval)};
+    if(keyframe)
+    {
+        encodeDelta(state, mZeroState);
+        mSinceKeyframe = 0;
+    }
+    else
+    {
+        encodeDelta(state, mLastState);
+    }
+    mSinceKeyframe++;
+
+    store(keyframe);
+
+    // making room can throw out the keyframe this delta was taken against
+    if(!keyframe && (mEntries.size() == 1))
+    {
+        dropNewest();
+        encodeDelta(state, mZeroState);
+        store(true);
+        mSinceKeyframe = 1;
+    }
+
+    // assign keeps the capacity, so this does not allocate once the sizes settle
+    mLastState.assign(state.begin(), state.end());
+}
+
+bool Rewind::rewind(std::vector<uint8_t>& state)
+{
+    if(mEntries.size() < 2)
+    {
+        return false;
+    }
+
+    dropNewest();
+    rebuild(mEntries.size() - 1, mLastState);
+    state = mLastState;
+
+    // count how far the new newest entry is from its keyframe
+    mSinceKeyframe = 0;
+    for(uint32_t i{mEntries.size()}; i > 0; i--)
+    {
+        mSinceKeyframe++;
+        if(mEntries[i - 1].keyframe)
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+void Rewind::clear()
+{
+    mEntries.clear();
+    mLastState.clear();
+    mWritePos = 0;
+    mUsedBytes = 0;
+    mSinceKeyframe = 0;
+    mFramesSinceCapture = 0;
+}
+
+uint32_t Rewind::getEntryCount()
+{
+    return mEntries.size();
+}
+
+uint32_t Rewind::getUsedBytes()
+{
+    return mUsedBytes;
+}
+
+void Rewind::encodeDelta(const std::vector<uint8_t>& state, const std::vector<uint8_t>& base)
+{
+    const uint8_t* cur{state.data()};
+    const uint8_t* old{base.data()};
+    uint32_t size{state.size()};
+
+    // a header is paid for by the unchanged bytes it skips, except for the first one,
+    // the one after the last literal and one per split at the max run length
+    mEncoded.resize(size + (size / MAX_RUN + 2) * 4);
+    uint8_t* out{mEncoded.data()};
+
+    uint32_t i{0};
+    while(i < size)
+    {
+        // skip unchanged bytes, 8 at a time while we can
+        uint32_t runStart{i};
+        while((i + 8 <= size) && (i - runStart + 8 <= MAX_RUN))
+        {
+            uint64_t a;
+            uint64_t b;
+            std::memcpy(&a, cur + i, 8);
+            std::memcpy(&b, old + i, 8);
+            if(a != b)
+            {
+                break;
+            }
+            i += 8;
+        }
+        while((i < size) && (i - runStart < MAX_RUN) && (cur[i] == old[i]))
+        {
+            i++;
+        }
+        uint16_t zeroRun{i - runStart};
+
+        // changed bytes, until enough unchanged ones follow each other
+        uint32_t litStart{i};
+        uint32_t unchanged{0};
+        while((i < size) && (i - litStart < MAX_RUN))
+        {
+            if(cur[i] == old[i])
+            {
+                unchanged++;
+                if(unchanged == MIN_ZERO_RUN)
+                {
+                    i -= (MIN_ZERO_RUN - 1);
+                    break;
+                }
+            }
+            else
+            {
+                unchanged = 0;
+            }
+            i++;
+        }
+        // never end a literal run with unchanged bytes when the state ends
+        if((i == size) && (unchanged > 0) && (unchanged < MIN_ZERO_RUN))
+        {
+            i -= unchanged;
+        }
+        uint16_t litRun{i - litStart};
+
+        std::memcpy(out, &zeroRun, 2);
+        std::memcpy(out + 2, &litRun, 2);
+        out += 4;
+        for(uint32_t j{litStart}; j < litStart + litRun; j++)
+        {
+            *out = cur[j] ^ old[j];
+            out++;
+        }
+    }
+
+    mEncoded.resize(out - mEncoded.data());
+}
+
+void Rewind::applyDelta(const Entry& entry, std::vector<uint8_t>& state)
+{
+    const uint8_t* in{mBuffer.data() + entry.offset};
+    const uint8_t* end{in + entry.size};
+    uint8_t* out{state.data()};
+
+    while(in < end)
+    {
+        uint16_t zeroRun;
+        uint16_t litRun;
+        std::memcpy(&zeroRun, in, 2);
+        std::memcpy(&litRun, in + 2, 2);
+        in += 4;
+
+        out += zeroRun;
+        for(uint16_t j{0}; j < litRun; j++)
+        {
+            out[j] ^= in[j];
+        }
+        out += litRun;
+        in += litRun;
+    }
+}
+
+void Rewind::rebuild(uint32_t index, std::vector<uint8_t>& state)
+{
+    // walk back to the keyframe this entry depends on
+    uint32_t keyIndex{index};
+    while(!mEntries[keyIndex].keyframe)
+    {
+        keyIndex--;
+    }
+
+    state.assign(mZeroState.size(), 0);
+    for(uint32_t i{keyIndex}; i <= index; i++)
+    {
+        applyDelta(mEntries[i], state);
+    }
+}
+
+void Rewind::store(bool keyframe)
+{
+    uint32_t size{mEncoded.size()};
+    if(size > mBuffer.size())
+    {
+        // a single snapshot that does not fit can never be rebuilt
+        clear();
+        return;
+    }
+
+    // entries are never split, wrap around when the end of the buffer is reached
+    if(mWritePos + size > mBuffer.size())
+    {
+        // everything between here and the end of the buffer is older than what sits at the start
+        while(!mEntries.empty() && (mEntries.front().offset >= mWritePos))
+        {
+            dropOldest();
+        }
+        mWritePos = 0;
+    }
+
+    // make room by removing whatever is in the way
+    while(!mEntries.empty() && (mEntries.front().offset >= mWritePos) && (mEntries.front().offset < mWritePos + size))
+    {
+        dropOldest();
+    }
+
+    std::memcpy(mBuffer.data() + mWritePos, mEncoded.data(), size);
+    mEntries.push_back(Entry{mWritePos, size, keyframe});
+    mWritePos += size;
+    mUsedBytes += size;
+}
+
+void Rewind::dropNewest()
+{
+    mUsedBytes -= mEntries.back().size;
+    mWritePos = mEntries.back().offset;
+    mEntries.pop_back();
+}
+
+void Rewind::dropOldest()
+{
+    mUsedBytes -= mEntries.front().size;
+    mEntries.pop_front();
+
+    // deltas without their keyframe can not be rebuilt anymore
+    while(!mEntries.empty() && !mEntries.front().keyframe)
+    {
+        mUsedBytes -= mEntries.front().size;
+        mEntries.pop_front();
+    }
+}
\ No newline at end of file
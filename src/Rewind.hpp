@@ -0,0 +1,75 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+
+/* REWIND DEFAULTS */
+constexpr uint32_t REWIND_BUFFER_SIZE = 4 * 1024 * 1024; // 4 MiB holds well over a minute of history
+constexpr uint16_t REWIND_CAPTURE_INTERVAL = 1;          // frames between snapshots
+constexpr uint16_t REWIND_KEYFRAME_INTERVAL = 120;       // snapshots between full keyframes
+
+/*
+    Keeps a history of save states in a fixed size ring buffer.
+    Every snapshot is stored as the XOR against the snapshot before it, run-length encoded,
+    since most of memory does not change from one frame to the next the XOR is mostly zeros.
+    Every so often a keyframe (XOR against nothing, so the full state) is stored instead,
+    a snapshot is rebuilt by starting at its keyframe and applying the deltas after it.
+    When the buffer is full the oldest keyframe and its deltas are thrown away.
+*/
+class Rewind
+{
+    public:
+        Rewind(uint32_t bufferSize = REWIND_BUFFER_SIZE, uint16_t captureInterval = REWIND_CAPTURE_INTERVAL,
+               uint16_t keyframeInterval = REWIND_KEYFRAME_INTERVAL);
+        ~Rewind();
+
+        // Call once per emulated frame, true when this frame should be captured
+        bool shouldCapture();
+
+        // Store a snapshot as the newest entry in the history
+        void capture(const std::vector<uint8_t>& state);
+
+        // Drop the newest entry and rebuild the one before it into state
+        // returns false if there is nothing left to go back to
+        bool rewind(std::vector<uint8_t>& state);
+
+        void clear();
+
+        uint32_t getEntryCount();
+        uint32_t getUsedBytes();
+
+    private:
+        struct Entry
+        {
+            uint32_t offset;
+            uint32_t size;
+            bool keyframe;
+        };
+
+        // Ring buffer of encoded entries, oldest entry at the front of mEntries
+        std::vector<uint8_t> mBuffer;
+        std::deque<Entry> mEntries;
+        uint32_t mWritePos;
+        uint32_t mUsedBytes;
+
+        uint16_t mCaptureInterval;
+        uint16_t mKeyframeInterval;
+        uint16_t mFramesSinceCapture;
+        uint16_t mSinceKeyframe;
+
+        // The newest snapshot (what the next delta is taken against) and scratch space
+        std::vector<uint8_t> mLastState;
+        std::vector<uint8_t> mZeroState;
+        std::vector<uint8_t> mEncoded;
+
+        void encodeDelta(const std::vector<uint8_t>& state, const std::vector<uint8_t>& base);
+        void applyDelta(const Entry& entry, std::vector<uint8_t>& state);
+        void rebuild(uint32_t index, std::vector<uint8_t>& state);
+        void store(bool keyframe);
+        void dropNewest();
+        void dropOldest();
+};
+
+#endif
\ No newline at end of file
@@ -1,13 +1,14 @@
 #include "Timers.hpp"
 #include "Helper.hpp"
 #include <iostream>
+#include <algorithm>
 
 Timers::Timers()
 {
-    curCycles = 0;
-    divCycles = 0;
-    timeCycles = 0;
-    timaMaxTime = 256;
+    reqInterrupt = false;
+    mLastUpdate = 0;
+    mDivider = DIVIDER_AFTER_BOOT;
+    mNextOverflow = NO_TIMER_EVENT;
 }
 
 Timers::~Timers()
@@ -15,80 +16,152 @@ Timers::~Timers()
 
 }
 
-void Timers::cycleDivReg(std::vector<uint8_t> &memMap)
+uint16_t Timers::getDivider(uint64_t now)
 {
-    // 16384 Hz cycle
-    // at 4.194304 MHz means one tick every 256 clocks
-    divCycles += curCycles * 4;
-    if(divCycles >= 256)
+    return mDivider + static_cast<uint16_t>(now - mLastUpdate);
+}
+
+uint16_t Timers::getTimerBit(uint8_t tac)
+{
+    // 4096 Hz, 262144 Hz, 65536 Hz, 16384 Hz at 4.194304 MHz, bit 9 falls every 1024 T-cycles
+    constexpr uint16_t timerBits[4]{1 << 9, 1 << 3, 1 << 5, 1 << 7};
+    if(!Helper::getBit(tac, 2))
     {
-        divCycles -= 256;
-        memMap[DIV_LOC]++;
+        return 0;
     }
+    return timerBits[tac & 0b11];
+}
 
+uint64_t Timers::getNextEvent()
+{
+    return mNextOverflow;
 }
 
-void Timers::cycleTIMA(std::vector<uint8_t> &memMap)
+void Timers::incrementTIMA(uint64_t count, std::vector<uint8_t>& memMap)
 {
-    uint8_t cycleSelect{memMap[TAC_LOC] & 0b11};
-    uint16_t newMax{0};
-    switch(cycleSelect)
+    while(count != 0)
     {
-        case 0:
-            newMax = 256;
-            break;
-        case 1:
-            newMax = 4;
-            break;
-        case 2:
-            newMax = 16;
-            break;
-        case 3:
-            newMax = 64;
-            break;
+        uint16_t untilOverflow{0x100 - memMap[TIMA_LOC]};
+        if(count < untilOverflow)
+        {
+            memMap[TIMA_LOC] += count;
+            return;
+        }
+        count -= untilOverflow;
+        memMap[TIMA_LOC] = memMap[TMA_LOC];
+        reqInterrupt = true;
+    }
+}
 
+void Timers::catchUp(uint64_t now, std::vector<uint8_t>& memMap)
+{
+    uint64_t elapsed{now - mLastUpdate};
+    uint16_t timerBit{getTimerBit(memMap[TAC_LOC])};
+    if(timerBit != 0)
+    {
+        // the bit falls every time the bits up to it wrap around
+        uint64_t period{timerBit * 2u};
+        incrementTIMA(((mDivider & (period - 1)) + elapsed) / period, memMap);
     }
-    if(newMax != timaMaxTime)
+
+    mDivider += static_cast<uint16_t>(elapsed);
+    mLastUpdate = now;
+    scheduleOverflow(memMap);
+}
+
+void Timers::scheduleOverflow(const std::vector<uint8_t>& memMap)
+{
+    uint16_t timerBit{getTimerBit(memMap[TAC_LOC])};
+    if(timerBit == 0)
     {
-        timeCycles = 0;
-        timaMaxTime = newMax;
+        mNextOverflow = NO_TIMER_EVENT;
+        return;
     }
 
-    timeCycles += curCycles;
-    if(timeCycles >= timaMaxTime)
+    // the next fall, then one period for every increment left after it
+    uint64_t period{timerBit * 2u};
+    uint64_t firstFall{period - (mDivider & (period - 1))};
+    mNextOverflow = mLastUpdate + firstFall + ((0xFF - memMap[TIMA_LOC]) * period);
+}
+
+uint16_t Timers::getCyclesUntilOverflow(uint64_t now)
+{
+    if(mNextOverflow == NO_TIMER_EVENT)
     {
-        timeCycles -= timaMaxTime;
-        if(memMap[TIMA_LOC] == 0xFF)
-        {
-            uint8_t resetVal{memMap[TMA_LOC]};
-            memMap[TIMA_LOC] = resetVal;
-            // request interrupt
-            reqInterrupt = true;
-        }
-        else
-        {
-            memMap[TIMA_LOC]++;
-        }
-        
+        return 0xFFFF;
     }
+    if(mNextOverflow <= now)
+    {
+        return 0;
+    }
+    return std::min<uint64_t>((mNextOverflow - now - 1) / 4, 0xFFFF);
+}
 
+uint8_t Timers::readDIV(uint64_t now)
+{
+    return getDivider(now) >> 8;
 }
 
-void Timers::tickTimer(uint16_t thisCycles, std::vector<uint8_t> &memMap)
+uint8_t Timers::readTIMA(uint64_t now, std::vector<uint8_t>& memMap)
 {
-    curCycles = thisCycles;
+    catchUp(now, memMap);
+    return memMap[TIMA_LOC];
+}
 
-    // Div always ticks regardless of TAC values
-    cycleDivReg(memMap);
+void Timers::writeDIV(uint64_t now, std::vector<uint8_t>& memMap)
+{
+    catchUp(now, memMap);
 
-    bool clockEn{Helper::getBit(memMap[TAC_LOC], 2)};
-    if(clockEn)
+    // the whole counter goes back to 0, so if TIMA's bit was set it falls
+    if((mDivider & getTimerBit(memMap[TAC_LOC])) != 0)
     {
-        cycleTIMA(memMap);
+        incrementTIMA(1, memMap);
     }
+    mDivider = 0;
+    scheduleOverflow(memMap);
+}
+
+void Timers::writeTIMA(uint64_t now, uint8_t data, std::vector<uint8_t>& memMap)
+{
+    catchUp(now, memMap);
+    memMap[TIMA_LOC] = data;
+    scheduleOverflow(memMap);
+}
+
+void Timers::writeTMA(uint64_t now, uint8_t data, std::vector<uint8_t>& memMap)
+{
+    // an overflow before now reloads the old value
+    catchUp(now, memMap);
+    memMap[TMA_LOC] = data;
+}
+
+void Timers::writeTAC(uint64_t now, uint8_t data, std::vector<uint8_t>& memMap)
+{
+    catchUp(now, memMap);
+
+    // TIMA counts falls of (bit AND enable), so switching to a bit that is clear or turning the timer off can be one
+    bool oldSignal{(mDivider & getTimerBit(memMap[TAC_LOC])) != 0};
+    bool newSignal{(mDivider & getTimerBit(data)) != 0};
+    if(oldSignal && !newSignal)
+    {
+        incrementTIMA(1, memMap);
+    }
+    memMap[TAC_LOC] = data;
+    scheduleOverflow(memMap);
+}
+
+void Timers::saveState(std::vector<uint8_t> &buffer)
+{
+    Helper::writeState(buffer, &mLastUpdate, sizeof(mLastUpdate));
+    Helper::writeState(buffer, &mDivider, sizeof(mDivider));
+    Helper::writeState(buffer, &mNextOverflow, sizeof(mNextOverflow));
+    Helper::writeState(buffer, &reqInterrupt, sizeof(reqInterrupt));
 }
 
-uint16_t Timers::getTimeCycles()
+void Timers::loadState(const uint8_t* &buffer)
 {
-    return timeCycles;
+    Helper::readState(buffer, &mLastUpdate, sizeof(mLastUpdate));
+    Helper::readState(buffer, &mDivider, sizeof(mDivider));
+    Helper::readState(buffer, &mNextOverflow, sizeof(mNextOverflow));
+    Helper::readState(buffer, &reqInterrupt, sizeof(reqInterrupt));
 }
\ No newline at end of file
@@ -10,6 +10,16 @@ constexpr uint16_t TIMA_LOC = 0xFF05;
 constexpr uint16_t TMA_LOC = 0xFF06;
 constexpr uint16_t TAC_LOC = 0xFF07;
 
+/* TIMER CONSTANTS */
+constexpr uint64_t NO_TIMER_EVENT = UINT64_MAX;
+constexpr uint16_t DIVIDER_AFTER_BOOT = 0x1800;  // DIV reads 0x18 when the game starts
+
+/*
+    DIV and TIMA both come from one 16-bit counter that goes up every T-cycle. DIV is its top byte and TIMA
+    goes up when the counter bit TAC picks (ANDed with the enable bit) falls. Nothing is counted as time goes by:
+    the counter is worked out from the timestamp (CPU::cyclesSincePowerOn) whenever a register is accessed, and TIMA
+    only has to be brought up to date then or when it overflows, which is worked out ahead of time.
+*/
 class Timers
 {
     public:
@@ -18,19 +28,35 @@ class Timers
 
         bool reqInterrupt;
 
-    private:
-        uint16_t curCycles;
-        uint16_t divCycles;
-        uint16_t timeCycles;
-
-        uint16_t timaMaxTime;
-
-        void cycleDivReg(std::vector<uint8_t>& memMap);
-        void cycleTIMA(std::vector<uint8_t>& memMap);
+        // Nothing needs doing before this timestamp (NO_TIMER_EVENT with TIMA stopped)
+        uint64_t getNextEvent();
+        // Brings TIMA up to now, overflows reload TMA and request the interrupt
+        void catchUp(uint64_t now, std::vector<uint8_t>& memMap);
+        // m-cycles that can go by from now without TIMA overflowing
+        uint16_t getCyclesUntilOverflow(uint64_t now);
+
+        // Register accesses at timestamp now
+        uint8_t readDIV(uint64_t now);
+        uint8_t readTIMA(uint64_t now, std::vector<uint8_t>& memMap);
+        void writeDIV(uint64_t now, std::vector<uint8_t>& memMap);
+        void writeTIMA(uint64_t now, uint8_t data, std::vector<uint8_t>& memMap);
+        void writeTMA(uint64_t now, uint8_t data, std::vector<uint8_t>& memMap);
+        void writeTAC(uint64_t now, uint8_t data, std::vector<uint8_t>& memMap);
+
+        // Save state support
+        void saveState(std::vector<uint8_t>& buffer);
+        void loadState(const uint8_t*& buffer);
 
-    public:
-        void tickTimer(uint16_t thisCycles, std::vector<uint8_t>& memMap);
-        uint16_t getTimeCycles();
+    private:
+        uint64_t mLastUpdate;   // timestamp TIMA was last brought up to
+        uint16_t mDivider;      // the counter at mLastUpdate
+        uint64_t mNextOverflow;
+
+        uint16_t getDivider(uint64_t now);
+        // the counter bit TIMA counts the falls of, 0 with TIMA stopped
+        uint16_t getTimerBit(uint8_t tac);
+        void incrementTIMA(uint64_t count, std::vector<uint8_t>& memMap);
+        void scheduleOverflow(const std::vector<uint8_t>& memMap);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,2668 @@
+// Made by tools/RomToCpp from GBMooTest_replay.gb, do not edit
+#include "AotRuntime.hpp"
+
+using R = AotRuntime;
+
+namespace
+{
+
+// bank 0
+void block_00_0060(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0060:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 14);
+            }
+            if(charged && !(R::canPush(cpu)))
+            {
+                charged = R::uncharge(cpu, 14);
+            }
+            R::push(cpu, charged, R::getAF(cpu));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0061;
+                R::addCycles(cpu, 4);
+                if(!R::next(cpu, 0x0061))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0061:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 10);
+            }
+            if(charged && !(R::canRead(cpu, 0xFF00 + 0x83)))
+            {
+                charged = R::uncharge(cpu, 10);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::reg(cpu, R_A) = R::read(cpu, charged, 0xFF00 + 0x83);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0063;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0063))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0063:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            R::reg(cpu, R_A) = R::inc(cpu, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0064;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0064))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0064:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            if(charged && !(R::canWrite(cpu, 0xFF00 + 0x83)))
+            {
+                charged = R::uncharge(cpu, 6);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::write(cpu, charged, 0xFF00 + 0x83, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0066;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0066))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0066:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(charged && !(R::canPop(cpu)))
+            {
+                charged = R::uncharge(cpu, 3);
+            }
+            R::setAF(cpu, R::pop(cpu, charged));
+            R::pc(cpu) = 0x0067;
+            if(!charged)
+            {
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0067))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0067:
+            charged = false;
+            R::execute(cpu, {0xD9, 0x00, 0x00});
+            R::end(cpu);
+    }
+}
+
+// bank 0
+void block_00_0058(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0058:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0059;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0059))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0059:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x005A;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x005A))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x005A:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x005B;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x005B))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x005B:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 5);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x005C;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x005C))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x005C:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x005D;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x005D))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x005D:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x005E;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x005E))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x005E:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x005F;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x005F))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x005F:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::pc(cpu) = 0x0060;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                R::end(cpu);
+            }
+    }
+}
+
+// bank 0
+void block_00_0050(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0050:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0051;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0051))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0051:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0052;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0052))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0052:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0053;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0053))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0053:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 5);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0054;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0054))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0054:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0055;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0055))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0055:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0056;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0056))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0056:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0057;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0057))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0057:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::pc(cpu) = 0x0058;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                R::end(cpu);
+            }
+    }
+}
+
+// bank 0
+void block_00_0048(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0048:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            R::alu(cpu, 0, R::reg(cpu, R_B));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0049;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0049))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0049:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(charged && !(R::canPop(cpu)))
+            {
+                charged = R::uncharge(cpu, 3);
+            }
+            R::setAF(cpu, R::pop(cpu, charged));
+            R::pc(cpu) = 0x004A;
+            if(!charged)
+            {
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x004A))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x004A:
+            charged = false;
+            R::execute(cpu, {0xD9, 0x00, 0x00});
+            R::end(cpu);
+    }
+}
+
+// bank 0
+void block_00_0040(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0040:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 15);
+            }
+            if(charged && !(R::canPush(cpu)))
+            {
+                charged = R::uncharge(cpu, 15);
+            }
+            R::push(cpu, charged, R::getAF(cpu));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0041;
+                R::addCycles(cpu, 4);
+                if(!R::next(cpu, 0x0041))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0041:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 11);
+            }
+            if(charged && !(R::canRead(cpu, 0xFF00 + 0x82)))
+            {
+                charged = R::uncharge(cpu, 11);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::reg(cpu, R_A) = R::read(cpu, charged, 0xFF00 + 0x82);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0043;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0043))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0043:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            R::reg(cpu, R_A) = R::inc(cpu, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0044;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0044))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0044:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(charged && !(R::canWrite(cpu, 0xFF00 + 0x82)))
+            {
+                charged = R::uncharge(cpu, 7);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::write(cpu, charged, 0xFF00 + 0x82, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0046;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0046))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0046:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            if(charged && !(R::canWrite(cpu, 0x8000)))
+            {
+                charged = R::uncharge(cpu, 4);
+            }
+            R::fetchOperands(cpu, charged, 2);
+            R::write(cpu, charged, 0x8000, R::reg(cpu, R_A));
+            R::pc(cpu) = 0x0049;
+            if(!charged)
+            {
+                R::addCycles(cpu, 4);
+                R::end(cpu);
+            }
+    }
+}
+
+// bank 0
+void block_00_0038(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0038:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0039;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0039))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0039:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x003A;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x003A))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x003A:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x003B;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x003B))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x003B:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 5);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x003C;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x003C))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x003C:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x003D;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x003D))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x003D:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x003E;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x003E))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x003E:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x003F;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x003F))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x003F:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::pc(cpu) = 0x0040;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                R::end(cpu);
+            }
+    }
+}
+
+// bank 0
+void block_00_0030(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0030:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0031;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0031))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0031:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0032;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0032))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0032:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0033;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0033))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0033:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 5);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0034;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0034))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0034:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0035;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0035))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0035:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0036;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0036))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0036:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0037;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0037))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0037:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::pc(cpu) = 0x0038;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                R::end(cpu);
+            }
+    }
+}
+
+// bank 0
+void block_00_0028(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0028:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0029;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0029))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0029:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x002A;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x002A))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x002A:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x002B;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x002B))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x002B:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 5);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x002C;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x002C))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x002C:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x002D;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x002D))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x002D:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x002E;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x002E))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x002E:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x002F;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x002F))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x002F:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::pc(cpu) = 0x0030;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                R::end(cpu);
+            }
+    }
+}
+
+// bank 0
+void block_00_0020(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0020:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0021;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0021))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0021:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0022;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0022))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0022:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0023;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0023))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0023:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 5);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0024;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0024))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0024:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0025;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0025))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0025:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0026;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0026))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0026:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0027;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0027))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0027:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::pc(cpu) = 0x0028;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                R::end(cpu);
+            }
+    }
+}
+
+// bank 0
+void block_00_0018(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0018:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0019;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0019))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0019:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x001A;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x001A))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x001A:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x001B;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x001B))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x001B:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 5);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x001C;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x001C))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x001C:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x001D;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x001D))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x001D:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x001E;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x001E))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x001E:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x001F;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x001F))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x001F:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::pc(cpu) = 0x0020;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                R::end(cpu);
+            }
+    }
+}
+
+// bank 0
+void block_00_0010(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0010:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0011;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0011))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0011:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0012;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0012))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0012:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0013;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0013))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0013:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 5);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0014;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0014))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0014:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0015;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0015))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0015:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0016;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0016))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0016:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0017;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0017))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0017:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::pc(cpu) = 0x0018;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                R::end(cpu);
+            }
+    }
+}
+
+// bank 0
+void block_00_0008(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0008:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0009;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0009))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0009:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x000A;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x000A))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x000A:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x000B;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x000B))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x000B:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 5);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x000C;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x000C))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x000C:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x000D;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x000D))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x000D:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x000E;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x000E))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x000E:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x000F;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x000F))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x000F:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::pc(cpu) = 0x0010;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                R::end(cpu);
+            }
+    }
+}
+
+// bank 0
+void block_00_0000(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0000:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0001;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0001))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0001:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0002;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0002))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0002:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0003;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0003))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0003:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 5);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0004;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0004))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0004:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0005;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0005))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0005:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0006;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0006))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0006:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0007;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0007))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0007:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::pc(cpu) = 0x0008;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                R::end(cpu);
+            }
+    }
+}
+
+// bank 0
+void block_00_0100(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0100:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::pc(cpu) = 0x0101;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0101))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0101:
+            charged = false;
+            R::pc(cpu) = 0x0150;
+            R::addCycles(cpu, 4);
+            R::end(cpu);
+    }
+}
+
+// bank 0
+void block_00_0150(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0150:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 15);
+            }
+            R::sp(cpu) = 0xDFFE;
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0153;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0153))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0153:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 12);
+            }
+            R::reg(cpu, R_A) = 0x11;
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0155;
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x0155))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0155:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 10);
+            }
+            if(charged && !(R::canWrite(cpu, 0xFF00 + 0xFF)))
+            {
+                charged = R::uncharge(cpu, 10);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::write(cpu, charged, 0xFF00 + 0xFF, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0157;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0157))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0157:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            R::alu(cpu, 5, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0158;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0158))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0158:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            if(charged && !(R::canWrite(cpu, 0xFF00 + 0x0F)))
+            {
+                charged = R::uncharge(cpu, 6);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::write(cpu, charged, 0xFF00 + 0x0F, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x015A;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x015A))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x015A:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            R::pair(cpu, RP_HL) = 0x9800;
+            R::pc(cpu) = 0x015D;
+            if(!charged)
+            {
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x015D))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x015D:
+            charged = false;
+            R::execute(cpu, {0xFB, 0x00, 0x00});
+            R::end(cpu);
+    }
+}
+
+// bank 0
+void block_00_015e(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x015E:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            R::reg(cpu, R_A) = 0x20;
+            R::pc(cpu) = 0x0160;
+            if(!charged)
+            {
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x0160))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0160:
+            charged = R::charge(cpu, 32);
+            if(charged && !(R::canWrite(cpu, 0xFF00 + 0x00)))
+            {
+                charged = R::uncharge(cpu, 32);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::write(cpu, charged, 0xFF00 + 0x00, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0162;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0162))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0162:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 29);
+            }
+            if(charged && !(R::canRead(cpu, 0xFF00 + 0x00)))
+            {
+                charged = R::uncharge(cpu, 29);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::reg(cpu, R_A) = R::read(cpu, charged, 0xFF00 + 0x00);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0164;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0164))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0164:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 26);
+            }
+            if(charged && !(R::canRead(cpu, 0xFF00 + 0x00)))
+            {
+                charged = R::uncharge(cpu, 26);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::reg(cpu, R_A) = R::read(cpu, charged, 0xFF00 + 0x00);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0166;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0166))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0166:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 23);
+            }
+            R::cpl(cpu);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0167;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0167))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0167:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 22);
+            }
+            R::alu(cpu, 4, 0x0F);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0169;
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x0169))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0169:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 20);
+            }
+            R::reg(cpu, R_B) = R::reg(cpu, R_A);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x016A;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x016A))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x016A:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 19);
+            }
+            R::reg(cpu, R_A) = 0x10;
+            if(!charged)
+            {
+                R::pc(cpu) = 0x016C;
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x016C))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x016C:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 17);
+            }
+            if(charged && !(R::canWrite(cpu, 0xFF00 + 0x00)))
+            {
+                charged = R::uncharge(cpu, 17);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::write(cpu, charged, 0xFF00 + 0x00, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x016E;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x016E))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x016E:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 14);
+            }
+            if(charged && !(R::canRead(cpu, 0xFF00 + 0x00)))
+            {
+                charged = R::uncharge(cpu, 14);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::reg(cpu, R_A) = R::read(cpu, charged, 0xFF00 + 0x00);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0170;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0170))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0170:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 11);
+            }
+            R::cpl(cpu);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0171;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0171))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0171:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 10);
+            }
+            R::alu(cpu, 4, 0x0F);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0173;
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x0173))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0173:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            R::reg(cpu, R_A) = R::rotate(cpu, 6, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0175;
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x0175))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0175:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 6);
+            }
+            R::alu(cpu, 6, R::reg(cpu, R_B));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0176;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0176))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0176:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 5);
+            }
+            if(charged && !(R::canWrite(cpu, 0xFF00 + 0x81)))
+            {
+                charged = R::uncharge(cpu, 5);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::write(cpu, charged, 0xFF00 + 0x81, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0178;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0178))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0178:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            R::bit(cpu, 0, R::reg(cpu, R_A));
+            R::pc(cpu) = 0x017A;
+            if(!charged)
+            {
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x017A))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x017A:
+            charged = false;
+            if(R::condition(cpu, 1))
+            {
+                R::pc(cpu) = 0x017D;
+                R::addCycles(cpu, 3);
+            }
+            else
+            {
+                R::pc(cpu) = 0x017C;
+                R::addCycles(cpu, 2);
+            }
+            R::end(cpu);
+    }
+}
+
+// bank 0
+void block_00_017c(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x017C:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            R::reg(cpu, R_L) = R::inc(cpu, R::reg(cpu, R_L));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x017D;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x017D))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x017D:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            R::bit(cpu, 1, R::reg(cpu, R_A));
+            R::pc(cpu) = 0x017F;
+            if(!charged)
+            {
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x017F))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x017F:
+            charged = false;
+            if(R::condition(cpu, 1))
+            {
+                R::pc(cpu) = 0x0182;
+                R::addCycles(cpu, 3);
+            }
+            else
+            {
+                R::pc(cpu) = 0x0181;
+                R::addCycles(cpu, 2);
+            }
+            R::end(cpu);
+    }
+}
+
+// bank 0
+void block_00_0181(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0181:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            R::reg(cpu, R_L) = R::dec(cpu, R::reg(cpu, R_L));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0182;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0182))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0182:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 2);
+            }
+            R::bit(cpu, 4, R::reg(cpu, R_A));
+            R::pc(cpu) = 0x0184;
+            if(!charged)
+            {
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x0184))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0184:
+            charged = false;
+            if(R::condition(cpu, 1))
+            {
+                R::pc(cpu) = 0x0189;
+                R::addCycles(cpu, 3);
+            }
+            else
+            {
+                R::pc(cpu) = 0x0186;
+                R::addCycles(cpu, 2);
+            }
+            R::end(cpu);
+    }
+}
+
+// bank 0
+void block_00_0186(CPU& cpu)
+{
+    switch(R::pc(cpu))
+    {
+        case 0x0186:
+            R::push(cpu, false, 0x0189);
+            R::pc(cpu) = 0x0300;
+            R::addCycles(cpu, 6);
+            R::end(cpu);
+    }
+}
+
+// bank 0
+void block_00_0300(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0300:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 19);
+            }
+            if(charged && !(R::canPush(cpu)))
+            {
+                charged = R::uncharge(cpu, 19);
+            }
+            R::push(cpu, charged, R::pair(cpu, RP_HL));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0301;
+                R::addCycles(cpu, 4);
+                if(!R::next(cpu, 0x0301))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0301:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 15);
+            }
+            R::pair(cpu, RP_HL) = 0x0400;
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0304;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0304))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0304:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 12);
+            }
+            R::pair(cpu, RP_DE) = 0xC100;
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0307;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0307))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0307:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 9);
+            }
+            R::reg(cpu, R_C) = 0x10;
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0309;
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x0309))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0309:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(charged && !(R::canRead(cpu, R::pair(cpu, RP_HL))))
+            {
+                charged = R::uncharge(cpu, 7);
+            }
+            R::reg(cpu, R_A) = R::read(cpu, charged, R::pair(cpu, RP_HL));
+            R::pair(cpu, RP_HL)++;
+            if(!charged)
+            {
+                R::pc(cpu) = 0x030A;
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x030A))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x030A:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 5);
+            }
+            if(charged && !(R::canWrite(cpu, R::pair(cpu, RP_DE))))
+            {
+                charged = R::uncharge(cpu, 5);
+            }
+            R::write(cpu, charged, R::pair(cpu, RP_DE), R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x030B;
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x030B))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x030B:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            R::pair(cpu, RP_DE)++;
+            if(!charged)
+            {
+                R::pc(cpu) = 0x030C;
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x030C))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x030C:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::reg(cpu, R_C) = R::dec(cpu, R::reg(cpu, R_C));
+            R::pc(cpu) = 0x030D;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x030D))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x030D:
+            charged = false;
+            if(R::condition(cpu, 0))
+            {
+                R::pc(cpu) = 0x0309;
+                R::addCycles(cpu, 3);
+            }
+            else
+            {
+                R::pc(cpu) = 0x030F;
+                R::addCycles(cpu, 2);
+            }
+            R::end(cpu);
+    }
+}
+
+// bank 0
+void block_00_030f(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x030F:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 10);
+            }
+            if(charged && !(R::canPop(cpu)))
+            {
+                charged = R::uncharge(cpu, 10);
+            }
+            R::pair(cpu, RP_HL) = R::pop(cpu, charged);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0310;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0310))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0310:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(charged && !(R::canRead(cpu, 0xFF00 + 0x80)))
+            {
+                charged = R::uncharge(cpu, 7);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::reg(cpu, R_A) = R::read(cpu, charged, 0xFF00 + 0x80);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0312;
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0312))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0312:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 4);
+            }
+            R::reg(cpu, R_A) = R::inc(cpu, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0313;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0313))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0313:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            if(charged && !(R::canWrite(cpu, 0xFF00 + 0x80)))
+            {
+                charged = R::uncharge(cpu, 3);
+            }
+            R::fetchOperands(cpu, charged, 1);
+            R::write(cpu, charged, 0xFF00 + 0x80, R::reg(cpu, R_A));
+            R::pc(cpu) = 0x0315;
+            if(!charged)
+            {
+                R::addCycles(cpu, 3);
+                if(!R::next(cpu, 0x0315))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0315:
+            charged = false;
+            R::pc(cpu) = R::pop(cpu, false);
+            R::addCycles(cpu, 4);
+            R::end(cpu);
+    }
+}
+
+// bank 0
+void block_00_0189(CPU& cpu)
+{
+    bool charged{false};
+    switch(R::pc(cpu))
+    {
+        case 0x0189:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 15);
+            }
+            if(charged && !(R::canWrite(cpu, R::pair(cpu, RP_HL))))
+            {
+                charged = R::uncharge(cpu, 15);
+            }
+            R::write(cpu, charged, R::pair(cpu, RP_HL), R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x018A;
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x018A))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x018A:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 13);
+            }
+            R::reg(cpu, R_C) = R::reg(cpu, R_A);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x018B;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x018B))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x018B:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 12);
+            }
+            if(charged && !(R::canRead(cpu, 0xC000)))
+            {
+                charged = R::uncharge(cpu, 12);
+            }
+            R::fetchOperands(cpu, charged, 2);
+            R::reg(cpu, R_A) = R::read(cpu, charged, 0xC000);
+            if(!charged)
+            {
+                R::pc(cpu) = 0x018E;
+                R::addCycles(cpu, 4);
+                if(!R::next(cpu, 0x018E))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x018E:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 8);
+            }
+            R::alu(cpu, 0, R::reg(cpu, R_C));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x018F;
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x018F))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x018F:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 7);
+            }
+            if(charged && !(R::canWrite(cpu, 0xC000)))
+            {
+                charged = R::uncharge(cpu, 7);
+            }
+            R::fetchOperands(cpu, charged, 2);
+            R::write(cpu, charged, 0xC000, R::reg(cpu, R_A));
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0192;
+                R::addCycles(cpu, 4);
+                if(!R::next(cpu, 0x0192))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0192:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 3);
+            }
+            R::reg(cpu, R_B) = 0x20;
+            if(!charged)
+            {
+                R::pc(cpu) = 0x0194;
+                R::addCycles(cpu, 2);
+                if(!R::next(cpu, 0x0194))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0194:
+            if(!charged)
+            {
+                charged = R::charge(cpu, 1);
+            }
+            R::reg(cpu, R_B) = R::dec(cpu, R::reg(cpu, R_B));
+            R::pc(cpu) = 0x0195;
+            if(!charged)
+            {
+                R::addCycles(cpu, 1);
+                if(!R::next(cpu, 0x0195))
+                {
+                    return;
+                }
+            }
+            [[fallthrough]];
+        case 0x0195:
+            charged = false;
+            if(R::condition(cpu, 0))
+            {
+                R::pc(cpu) = 0x0194;
+                R::addCycles(cpu, 3);
+            }
+            else
+            {
+                R::pc(cpu) = 0x0197;
+                R::addCycles(cpu, 2);
+            }
+            R::end(cpu);
+    }
+}
+
+// bank 0
+void block_00_0197(CPU& cpu)
+{
+    switch(R::pc(cpu))
+    {
+        case 0x0197:
+            R::pc(cpu) = 0x015E;
+            R::addCycles(cpu, 3);
+            R::end(cpu);
+    }
+}
+
+const AotEntry entries[]
+{
+    {0, 0x0060, &block_00_0060},
+    {0, 0x0061, &block_00_0060},
+    {0, 0x0063, &block_00_0060},
+    {0, 0x0064, &block_00_0060},
+    {0, 0x0066, &block_00_0060},
+    {0, 0x0067, &block_00_0060},
+    {0, 0x0058, &block_00_0058},
+    {0, 0x0059, &block_00_0058},
+    {0, 0x005A, &block_00_0058},
+    {0, 0x005B, &block_00_0058},
+    {0, 0x005C, &block_00_0058},
+    {0, 0x005D, &block_00_0058},
+    {0, 0x005E, &block_00_0058},
+    {0, 0x005F, &block_00_0058},
+    {0, 0x0050, &block_00_0050},
+    {0, 0x0051, &block_00_0050},
+    {0, 0x0052, &block_00_0050},
+    {0, 0x0053, &block_00_0050},
+    {0, 0x0054, &block_00_0050},
+    {0, 0x0055, &block_00_0050},
+    {0, 0x0056, &block_00_0050},
+    {0, 0x0057, &block_00_0050},
+    {0, 0x0048, &block_00_0048},
+    {0, 0x0049, &block_00_0048},
+    {0, 0x004A, &block_00_0048},
+    {0, 0x0040, &block_00_0040},
+    {0, 0x0041, &block_00_0040},
+    {0, 0x0043, &block_00_0040},
+    {0, 0x0044, &block_00_0040},
+    {0, 0x0046, &block_00_0040},
+    {0, 0x0038, &block_00_0038},
+    {0, 0x0039, &block_00_0038},
+    {0, 0x003A, &block_00_0038},
+    {0, 0x003B, &block_00_0038},
+    {0, 0x003C, &block_00_0038},
+    {0, 0x003D, &block_00_0038},
+    {0, 0x003E, &block_00_0038},
+    {0, 0x003F, &block_00_0038},
+    {0, 0x0030, &block_00_0030},
+    {0, 0x0031, &block_00_0030},
+    {0, 0x0032, &block_00_0030},
+    {0, 0x0033, &block_00_0030},
+    {0, 0x0034, &block_00_0030},
+    {0, 0x0035, &block_00_0030},
+    {0, 0x0036, &block_00_0030},
+    {0, 0x0037, &block_00_0030},
+    {0, 0x0028, &block_00_0028},
+    {0, 0x0029, &block_00_0028},
+    {0, 0x002A, &block_00_0028},
+    {0, 0x002B, &block_00_0028},
+    {0, 0x002C, &block_00_0028},
+    {0, 0x002D, &block_00_0028},
+    {0, 0x002E, &block_00_0028},
+    {0, 0x002F, &block_00_0028},
+    {0, 0x0020, &block_00_0020},
+    {0, 0x0021, &block_00_0020},
+    {0, 0x0022, &block_00_0020},
+    {0, 0x0023, &block_00_0020},
+    {0, 0x0024, &block_00_0020},
+    {0, 0x0025, &block_00_0020},
+    {0, 0x0026, &block_00_0020},
+    {0, 0x0027, &block_00_0020},
+    {0, 0x0018, &block_00_0018},
+    {0, 0x0019, &block_00_0018},
+    {0, 0x001A, &block_00_0018},
+    {0, 0x001B, &block_00_0018},
+    {0, 0x001C, &block_00_0018},
+    {0, 0x001D, &block_00_0018},
+    {0, 0x001E, &block_00_0018},
+    {0, 0x001F, &block_00_0018},
+    {0, 0x0010, &block_00_0010},
+    {0, 0x0011, &block_00_0010},
+    {0, 0x0012, &block_00_0010},
+    {0, 0x0013, &block_00_0010},
+    {0, 0x0014, &block_00_0010},
+    {0, 0x0015, &block_00_0010},
+    {0, 0x0016, &block_00_0010},
+    {0, 0x0017, &block_00_0010},
+    {0, 0x0008, &block_00_0008},
+    {0, 0x0009, &block_00_0008},
+    {0, 0x000A, &block_00_0008},
+    {0, 0x000B, &block_00_0008},
+    {0, 0x000C, &block_00_0008},
+    {0, 0x000D, &block_00_0008},
+    {0, 0x000E, &block_00_0008},
+    {0, 0x000F, &block_00_0008},
+    {0, 0x0000, &block_00_0000},
+    {0, 0x0001, &block_00_0000},
+    {0, 0x0002, &block_00_0000},
+    {0, 0x0003, &block_00_0000},
+    {0, 0x0004, &block_00_0000},
+    {0, 0x0005, &block_00_0000},
+    {0, 0x0006, &block_00_0000},
+    {0, 0x0007, &block_00_0000},
+    {0, 0x0100, &block_00_0100},
+    {0, 0x0101, &block_00_0100},
+    {0, 0x0150, &block_00_0150},
+    {0, 0x0153, &block_00_0150},
+    {0, 0x0155, &block_00_0150},
+    {0, 0x0157, &block_00_0150},
+    {0, 0x0158, &block_00_0150},
+    {0, 0x015A, &block_00_0150},
+    {0, 0x015D, &block_00_0150},
+    {0, 0x015E, &block_00_015e},
+    {0, 0x0160, &block_00_015e},
+    {0, 0x0162, &block_00_015e},
+    {0, 0x0164, &block_00_015e},
+    {0, 0x0166, &block_00_015e},
+    {0, 0x0167, &block_00_015e},
+    {0, 0x0169, &block_00_015e},
+    {0, 0x016A, &block_00_015e},
+    {0, 0x016C, &block_00_015e},
+    {0, 0x016E, &block_00_015e},
+    {0, 0x0170, &block_00_015e},
+    {0, 0x0171, &block_00_015e},
+    {0, 0x0173, &block_00_015e},
+    {0, 0x0175, &block_00_015e},
+    {0, 0x0176, &block_00_015e},
+    {0, 0x0178, &block_00_015e},
+    {0, 0x017A, &block_00_015e},
+    {0, 0x017C, &block_00_017c},
+    {0, 0x017D, &block_00_017c},
+    {0, 0x017F, &block_00_017c},
+    {0, 0x0181, &block_00_0181},
+    {0, 0x0182, &block_00_0181},
+    {0, 0x0184, &block_00_0181},
+    {0, 0x0186, &block_00_0186},
+    {0, 0x0300, &block_00_0300},
+    {0, 0x0301, &block_00_0300},
+    {0, 0x0304, &block_00_0300},
+    {0, 0x0307, &block_00_0300},
+    {0, 0x0309, &block_00_0300},
+    {0, 0x030A, &block_00_0300},
+    {0, 0x030B, &block_00_0300},
+    {0, 0x030C, &block_00_0300},
+    {0, 0x030D, &block_00_0300},
+    {0, 0x030F, &block_00_030f},
+    {0, 0x0310, &block_00_030f},
+    {0, 0x0312, &block_00_030f},
+    {0, 0x0313, &block_00_030f},
+    {0, 0x0315, &block_00_030f},
+    {0, 0x0189, &block_00_0189},
+    {0, 0x018A, &block_00_0189},
+    {0, 0x018B, &block_00_0189},
+    {0, 0x018E, &block_00_0189},
+    {0, 0x018F, &block_00_0189},
+    {0, 0x0192, &block_00_0189},
+    {0, 0x0194, &block_00_0189},
+    {0, 0x0195, &block_00_0189},
+    {0, 0x0197, &block_00_0197},
+};
+
+const bool registered{AotRuntime::registerProgram({0x1A3E63, 2, entries, 150})};
+
+}
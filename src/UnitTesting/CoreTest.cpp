@@ -0,0 +1,534 @@
+#include "CoreTest.hpp"
+#include "nlohmann/json.hpp"
+
+bool CoreTest::JsonState(const std::string fileName)
+{
+    std::ifstream fJson(fileName);
+    if(fJson.fail())
+    {
+        std::cout << "File does not exist" << std::endl;
+        return false;
+    }
+    nlohmann::json data = nlohmann::json::parse(fJson);
+
+    const std::pair<const char*, uint8_t> registerNames[]
+    {
+        {"a", R_A}, {"b", R_B}, {"c", R_C}, {"d", R_D}, {"e", R_E}, {"f", R_F}, {"h", R_H}, {"l", R_L}
+    };
+
+    bool passed{true};
+    for(bool lazyFlags : {true, false})
+    {
+        CPU cpu;
+        cpu.setLazyFlags(lazyFlags);
+        mapFlatMemory(cpu);
+        std::string mode{lazyFlags ? "lazy flags" : "eager flags"};
+
+        for(const nlohmann::json& test : data)
+        {
+            const nlohmann::json& initial{test["initial"]};
+            const nlohmann::json& final{test["final"]};
+            for(const auto& [name, index] : registerNames)
+            {
+                cpu.registers[index] = initial[name];
+            }
+            cpu.mFlagOp = FLAG_OP_NONE;
+            cpu.sp = initial["sp"];
+            cpu.isHalted = false;
+            for(const nlohmann::json& byte : initial["ram"])
+            {
+                cpu.memMap[byte[0]] = byte[1];
+            }
+
+            // the tests have the opcode already fetched, pc is one past it before and after
+            cpu.pc = static_cast<uint16_t>(initial["pc"]) - 1;
+            cpu.beginInstruction();
+            cpu.executeInstruction();
+            cpu.cycleCount = 0;
+            cpu.pc++;
+            cpu.materializeFlags();
+
+            std::string failMessage{""};
+            for(const auto& [name, index] : registerNames)
+            {
+                if(cpu.registers[index] != final[name])
+                {
+                    failMessage += std::string{"Incorrect "} + name + " Yours: " + std::to_string(cpu.registers[index]) +
+                                   " Correct: " + std::to_string(static_cast<uint8_t>(final[name])) + "\n";
+                }
+            }
+            if(cpu.pc != final["pc"])
+            {
+                failMessage += "Incorrect PC: Yours: " + std::to_string(cpu.pc) + " Correct: " + std::to_string(static_cast<uint16_t>(final["pc"])) + "\n";
+            }
+            if(cpu.sp != final["sp"])
+            {
+                failMessage += "Incorrect SP: Yours: " + std::to_string(cpu.sp) + " Correct: " + std::to_string(static_cast<uint16_t>(final["sp"])) + "\n";
+            }
+            for(const nlohmann::json& byte : final["ram"])
+            {
+                uint16_t addr{byte[0]};
+                if(cpu.memMap[addr] != byte[1])
+                {
+                    failMessage += "Incorrect memory at " + std::to_string(addr) + " Yours: " + std::to_string(cpu.memMap[addr]) +
+                                   " Correct: " + std::to_string(static_cast<uint8_t>(byte[1])) + "\n";
+                }
+            }
+            passed &= check(failMessage.empty(), std::string{test["name"]} + " (" + mode + ")\n" + failMessage);
+        }
+    }
+    return passed;
+}
+
+std::vector<uint8_t> CoreTest::makeROM()
+{
+    std::vector<uint8_t> rom(TEST_ROM_SIZE, 0);
+    put(rom, 0x100, {0x00, 0xC3, TEST_CODE & 0xFF, TEST_CODE >> 8});
+    return rom;
+}
+
+void CoreTest::put(std::vector<uint8_t>& rom, uint16_t addr, const std::vector<uint8_t>& bytes)
+{
+    std::copy(bytes.begin(), bytes.end(), rom.begin() + addr);
+}
+
+std::string CoreTest::writeROM(const std::string& name, std::vector<uint8_t> rom)
+{
+    for(uint8_t i{0}; (i < name.size()) && (i < 15); i++)
+    {
+        rom[0x134 + i] = std::toupper(name[i]);
+    }
+    uint8_t headerChecksum{0};
+    for(uint16_t addr{0x134}; addr < HEADER_CHECKSUM; addr++)
+    {
+        headerChecksum = headerChecksum - rom[addr] - 1;
+    }
+    rom[HEADER_CHECKSUM] = headerChecksum;
+    uint16_t globalChecksum{0};
+    for(uint32_t addr{0}; addr < rom.size(); addr++)
+    {
+        if((addr != GLOBAL_CHECKSUM) && (addr != GLOBAL_CHECKSUM + 1))
+        {
+            globalChecksum += rom[addr];
+        }
+    }
+    rom[GLOBAL_CHECKSUM] = globalChecksum >> 8;
+    rom[GLOBAL_CHECKSUM + 1] = globalChecksum & 0xFF;
+
+    std::filesystem::path path{std::filesystem::temp_directory_path() / ("GBMooTest_" + name + ".gb")};
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(rom.data()), rom.size());
+    return path.string();
+}
+
+void CoreTest::mapFlatMemory(CPU& cpu)
+{
+    for(uint8_t i{0}; i < PAGE_COUNT; i++)
+    {
+        cpu.mPages.read[i] = cpu.memMap.data() + (i * PAGE_SIZE);
+        cpu.mPages.write[i] = cpu.memMap.data() + (i * PAGE_SIZE);
+    }
+}
+
+void CoreTest::step(CPU& cpu)
+{
+    cpu.runUntil(cpu.cyclesSincePowerOn + 1);
+}
+
+bool CoreTest::compareRuns(const std::string& name, CPU& expected, CPU& actual, uint16_t frames, uint32_t stepCycles)
+{
+    uint64_t start{expected.cyclesSincePowerOn};
+    for(uint16_t frame{0}; frame < frames; frame++)
+    {
+        uint64_t frameEnd{start + ((frame + 1) * static_cast<uint64_t>(CYCLES_PER_FRAME))};
+        for(CPU* cpu : {&expected, &actual})
+        {
+            while(cpu->cyclesSincePowerOn < frameEnd)
+            {
+                cpu->runUntil(std::min(frameEnd, cpu->cyclesSincePowerOn + stepCycles));
+            }
+        }
+
+        if(!check(stateHash(expected) == stateHash(actual), name + ": state differs after frame " + std::to_string(frame)) ||
+           !check(frameHash(expected) == frameHash(actual), name + ": picture differs after frame " + std::to_string(frame)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// FNV-1a
+static uint64_t hashBytes(const uint8_t* bytes, size_t length, uint64_t hash = 0xCBF29CE484222325)
+{
+    for(size_t i{0}; i < length; i++)
+    {
+        hash = (hash ^ bytes[i]) * 0x100000001B3;
+    }
+    return hash;
+}
+
+uint64_t CoreTest::stateHash(CPU& cpu)
+{
+    cpu.materializeFlags();
+    uint64_t hash{hashBytes(cpu.registers.r8, sizeof(cpu.registers.r8))};
+    hash = hashBytes(reinterpret_cast<const uint8_t*>(&cpu.sp), sizeof(cpu.sp), hash);
+    hash = hashBytes(reinterpret_cast<const uint8_t*>(&cpu.pc), sizeof(cpu.pc), hash);
+    hash = hashBytes(reinterpret_cast<const uint8_t*>(&cpu.cyclesSincePowerOn), sizeof(cpu.cyclesSincePowerOn), hash);
+    hash = hashBytes(reinterpret_cast<const uint8_t*>(&cpu.IMEflag), sizeof(cpu.IMEflag), hash);
+    return hashBytes(cpu.memMap.data() + VRAM, cpu.memMap.size() - VRAM, hash);
+}
+
+uint64_t CoreTest::frameHash(CPU& cpu)
+{
+    return hashBytes(cpu.getPPUArray(), PPU_SCREENWIDTH * PPU_SCREENHEIGHT * BYTES_PER_PIXEL);
+}
+
+bool CoreTest::check(bool passed, const std::string& message)
+{
+    if(!passed)
+    {
+        std::cout << "Failed " << message << std::endl;
+    }
+    return passed;
+}
+
+bool CoreTest::midLineWrites()
+{
+    // the background is columns of tile 0 (colour 0) and tile 1 (colour 3), every line looks the same until a write changes it
+    std::vector<uint8_t> rom{makeROM()};
+    put(rom, TEST_CODE, {0x18, 0xFE}); // JR -2
+
+    struct WriteCase
+    {
+        const char* name;
+        std::vector<uint8_t> code;
+        uint16_t reg;
+        uint8_t value;
+        uint8_t accessCycle;    // the m-cycle of the instruction the write is made in
+    };
+    const WriteCase cases[]
+    {
+        {"LDH (n),A to BGP", {0xE0, 0x47}, BGP, 0x1B, 3},
+        {"LD (nn),A to BGP", {0xEA, 0x47, 0xFF}, BGP, 0x1B, 4},
+        {"LD (HL),A to BGP", {0x77}, BGP, 0x1B, 2},
+        {"LDH (n),A to SCX", {0xE0, 0x43}, SCX, 8, 3},
+        {"LD (C),A to SCX", {0xE2}, SCX, 8, 2},
+        {"LD (HL),n to SCX", {0x36, 0x08}, SCX, 8, 3},
+    };
+    for(uint8_t i{0}; i < std::size(cases); i++)
+    {
+        put(rom, 0x200 + (i * 4), cases[i].code);
+    }
+    std::string fileName{writeROM("midline", rom)};
+
+    bool passed{true};
+    for(const char* mode : {"interpreter", "decoded blocks", "recompiler"})
+    {
+        CPU cpu;
+        cpu.loadROM(fileName, "");
+        cpu.setRenderEnabled(true);
+        cpu.setBlockCacheEnabled(mode != std::string{"interpreter"});
+        if((mode == std::string{"recompiler"}) && !cpu.setJitEnabled(true))
+        {
+            continue;
+        }
+
+        for(uint16_t i{0}; i < 16; i++)
+        {
+            cpu.memMap[VRAM_START + 16 + i] = 0xFF;
+        }
+        for(uint16_t i{0}; i < 0x400; i++)
+        {
+            cpu.memMap[0x9800 + i] = i & 1;
+        }
+        cpu.writeMemory(BGP, 0xE4);
+        cpu.writeMemory(SCX, 0);
+        cpu.writeMemory(LCDC, 0x91);
+
+        for(uint8_t i{0}; i < std::size(cases); i++)
+        {
+            const WriteCase& writeCase{cases[i]};
+
+            // somewhere in mode 3 the write still lands in, each case a bit further in and on a line of its own
+            uint8_t caseLine{8 + (i * 16)};
+            uint16_t earliest{8 + (i * 20)};
+            while(true)
+            {
+                step(cpu);
+                uint8_t line{cpu.memMap[SCANLINE_REGISTER]};
+                int16_t dot{cpu.mPPU.mElapsedModeTime};
+                if((cpu.mPPU.getPPUMode(cpu.memMap) == MODE_DRAW_PIX) && (line == caseLine) &&
+                   (dot >= earliest) && (dot + (writeCase.accessCycle * 4) < MODE_DRAW_TIME))
+                {
+                    break;
+                }
+            }
+
+            uint8_t line{cpu.memMap[SCANLINE_REGISTER]};
+            uint16_t expected{cpu.mPPU.mElapsedModeTime + (writeCase.accessCycle * 4) - LINE_DOT_OFFSET};
+            uint8_t oldValue{cpu.memMap[writeCase.reg]};
+            cpu.registers[R_A] = writeCase.value;
+            cpu.registers[R_C] = writeCase.reg & 0xFF;
+            cpu.registers.pair(RP_HL) = writeCase.reg;
+            cpu.pc = 0x200 + (i * 4);
+            step(cpu);
+
+            // the line is drawn when mode 3 is over, then the register goes back for the next case
+            cpu.pc = TEST_CODE;
+            while(cpu.memMap[SCANLINE_REGISTER] == line)
+            {
+                step(cpu);
+            }
+            cpu.writeMemory(writeCase.reg, oldValue);
+
+            // the line above was drawn with the old value all the way across
+            const uint8_t* pixels{cpu.getPPUArray()};
+            uint16_t split{0};
+            while((split < PPU_SCREENWIDTH) &&
+                  std::equal(pixels + (((line * PPU_SCREENWIDTH) + split) * BYTES_PER_PIXEL),
+                             pixels + (((line * PPU_SCREENWIDTH) + split + 1) * BYTES_PER_PIXEL),
+                             pixels + ((((line - 1) * PPU_SCREENWIDTH) + split) * BYTES_PER_PIXEL)))
+            {
+                split++;
+            }
+            passed &= check(split == expected, std::string{writeCase.name} + " (" + mode + "): line " + std::to_string(line) +
+                            " split at " + std::to_string(split) + ", should be at " + std::to_string(expected));
+        }
+    }
+    return passed;
+}
+
+bool CoreTest::interruptDispatch()
+{
+    std::vector<uint8_t> rom{makeROM()};
+    put(rom, TEST_CODE, {0x00, 0x18, 0xFD}); // NOP, JR -3
+    std::string fileName{writeROM("dispatch", rom)};
+
+    bool passed{true};
+    for(AccuracyMode accuracy : {AccuracyMode::Fast, AccuracyMode::Cycle})
+    {
+        CPU cpu;
+        cpu.loadROM(fileName, "");
+        cpu.setAccuracy(accuracy);
+        std::string mode{(accuracy == AccuracyMode::Fast) ? "fast" : "accurate"};
+        uint64_t expected{(accuracy == AccuracyMode::Fast) ? 4u : 24u};
+
+        // the timer interrupt is taken after the NOP
+        cpu.pc = TEST_CODE;
+        cpu.IMEflag = true;
+        cpu.writeMemory(INTERRUPT_ENABLE, 1 << INT_TIMER);
+        cpu.writeMemory(INTERRUPT_FLAG, 1 << INT_TIMER);
+        uint16_t sp{cpu.sp};
+        uint64_t start{cpu.cyclesSincePowerOn};
+        step(cpu);
+
+        uint64_t taken{cpu.cyclesSincePowerOn - start};
+        passed &= check(taken == expected, "NOP and interrupt dispatch (" + mode + "): took " + std::to_string(taken) +
+                        " t-cycles, should take " + std::to_string(expected));
+        passed &= check(cpu.pc == INTERRUPT_VECTOR + (INT_TIMER * 8), "interrupt dispatch (" + mode + "): did not jump to the vector");
+        passed &= check((cpu.sp == sp - 2) && (cpu.memMap[sp - 1] == ((TEST_CODE + 1) >> 8)) && (cpu.memMap[sp - 2] == ((TEST_CODE + 1) & 0xFF)),
+                        "interrupt dispatch (" + mode + "): return address not pushed");
+    }
+    return passed;
+}
+
+bool CoreTest::jitDifferential()
+{
+    std::vector<uint8_t> rom{makeROM()};
+
+    // VBlank counts frames into tile 0, so the picture changes every frame, the timer counts into HRAM
+    put(rom, 0x40, {0xF5, 0xFA, 0x00, 0xD1, 0x3C, 0xEA, 0x00, 0xD1, 0xEA, 0x00, 0x80, 0xEA, 0x01, 0x80, 0xF1, 0xD9});
+    put(rom, 0x50, {0xF5, 0xF0, 0x80, 0x3C, 0xE0, 0x80, 0xF1, 0xD9});
+
+    // copies C bytes from HL to DE
+    put(rom, 0x200, {0x2A, 0x12, 0x13, 0x0D, 0x20, 0xFA, 0xC9});
+
+    put(rom, TEST_CODE,
+    {
+        0x31, 0xFE, 0xDF,           // LD SP,DFFE
+        0x21, 0x00, 0x10,           // LD HL,1000
+        0x11, 0x00, 0xC0,           // LD DE,C000
+        0x0E, 0x20,                 // LD C,20
+        0xCD, 0x00, 0x02,           // CALL 0200
+        0x21, 0x80, 0x10,           // LD HL,1080
+        0x11, 0x00, 0xC1,           // LD DE,C100
+        0x0E, 0x10,                 // LD C,10
+        0xCD, 0x00, 0x02,           // CALL 0200
+        0x3E, 0xF0, 0xE0, 0x06,     // TMA = F0
+        0x3E, 0x05, 0xE0, 0x07,     // TAC = 05, TIMA overflows every 64 m-cycles
+        0x3E, 0x05, 0xE0, 0xFF,     // IE = VBlank and timer
+        0xAF, 0xE0, 0x0F,           // IF = 0
+        0xFB,                       // EI
+        0xCD, 0x00, 0xC0,           // 0179: CALL C000
+        0xCD, 0x00, 0x11,           // CALL 1100
+        0xCD, 0x00, 0x12,           // CALL 1200
+        0xF0, 0x80, 0xE0, 0x43,     // SCX = timer count
+        0xC3, 0x79, 0x01,           // JP 0179
+    });
+
+    // copied to C000, rewrites its own immediate and an instruction further into its block
+    put(rom, 0x1000,
+    {
+        0x3E, 0x00,                 // C000: LD A,n
+        0x3C,                       // INC A
+        0xEA, 0x01, 0xC0,           // LD (C001),A
+        0xEA, 0x00, 0xD0,           // LD (D000),A
+        0x21, 0x10, 0xC0,           // LD HL,C010
+        0x36, 0x3C,                 // LD (HL),3C (the NOP at C010 becomes INC A)
+        0x00, 0x00,                 // NOP NOP
+        0x00,                       // C010: NOP or INC A
+        0xEA, 0x02, 0xD0,           // LD (D002),A
+        0x36, 0x00,                 // LD (HL),00
+        0x47, 0x4F, 0x57, 0x5F, 0x67, 0x6F, // LD B,A ... LD L,A
+        0x21, 0x00, 0xD0,           // LD HL,D000
+        0xC9,                       // RET
+    });
+
+    // copied to C100, its chunk is written every time round the main loop (by 1200) until it is only interpreted
+    put(rom, 0x1080, {0x06, 0x00, 0x78, 0x87, 0xEA, 0x01, 0xD2, 0xC9}); // LD B,n; LD A,B; ADD A,A; LD (D201),A; RET
+
+    // 48 m-cycles of register ops in one native run, longer than the timer leaves between interrupts most of the time
+    const std::vector<uint8_t> registerOps{0x04, 0x81, 0xAA, 0x5F, 0x25, 0x8C, 0x93, 0x0C, 0xB0, 0x57, 0x2C, 0x9D};
+    for(uint16_t i{0}; i < 4; i++)
+    {
+        put(rom, 0x1100 + (i * registerOps.size()), registerOps);
+    }
+    put(rom, 0x1100 + (4 * registerOps.size()), {0xC9});
+
+    put(rom, 0x1200,
+    {
+        0xFA, 0x00, 0xD2,           // LD A,(D200)
+        0x3C,                       // INC A
+        0xEA, 0x00, 0xD2,           // LD (D200),A
+        0xEA, 0x01, 0xC1,           // LD (C101),A
+        0xCD, 0x00, 0xC1,           // CALL C100
+        0xC9,                       // RET
+    });
+    std::string fileName{writeROM("jit", rom)};
+
+    CPU expected;
+    CPU actual;
+    expected.loadROM(fileName, "");
+    actual.loadROM(fileName, "");
+    if(!actual.setJitEnabled(true))
+    {
+        std::cout << "No recompiler on this host, skipped jitDifferential" << std::endl;
+        return true;
+    }
+    expected.setRenderEnabled(true);
+    actual.setRenderEnabled(true);
+
+    // the end of each run lands in the middle of a native run as often as not
+    bool passed{compareRuns("recompiler against decoded blocks", expected, actual, 120, 457)};
+
+    // what the run was meant to go through did happen
+    passed &= check(actual.isCodeUncached(0xC000) && actual.isCodeUncached(0xC100),
+                    "recompiler against decoded blocks: the work RAM chunks never reached the invalidation limit");
+    passed &= check(actual.memMap[0xD100] >= 100, "recompiler against decoded blocks: VBlank was not taken every frame");
+    return passed;
+}
+
+bool CoreTest::aotReplay()
+{
+    std::vector<uint8_t> rom{makeROM()};
+
+    // VBlank counts frames into tile 0, the joypad interrupt counts presses
+    put(rom, 0x40, {0xF5, 0xF0, 0x82, 0x3C, 0xE0, 0x82, 0xEA, 0x00, 0x80, 0xF1, 0xD9});
+    put(rom, 0x60, {0xF5, 0xF0, 0x83, 0x3C, 0xE0, 0x83, 0xF1, 0xD9});
+
+    // the buttons held move a cursor over the tile map and are written under it, A also copies a block into work RAM
+    std::vector<uint8_t> loop
+    {
+        0x3E, 0x20, 0xE0, 0x00,     // select the d-pad
+        0xF0, 0x00, 0xF0, 0x00,     // LDH A,(00) twice
+        0x2F, 0xE6, 0x0F,           // CPL, AND 0F
+        0x47,                       // LD B,A
+        0x3E, 0x10, 0xE0, 0x00,     // select the buttons
+        0xF0, 0x00,                 // LDH A,(00)
+        0x2F, 0xE6, 0x0F,           // CPL, AND 0F
+        0xCB, 0x37, 0xB0,           // SWAP A, OR B
+        0xE0, 0x81,                 // LDH (81),A
+        0xCB, 0x47, 0x28, 0x01, 0x2C,   // right: INC L
+        0xCB, 0x4F, 0x28, 0x01, 0x2D,   // left: DEC L
+        0xCB, 0x67, 0x28, 0x03, 0xCD, 0x00, 0x03,   // A: CALL 0300
+        0x77,                       // LD (HL),A
+        0x4F, 0xFA, 0x00, 0xC0, 0x81, 0xEA, 0x00, 0xC0, // (C000) += A
+        0x06, 0x20, 0x05, 0x20, 0xFD,   // wait a bit
+    };
+    loop.push_back(0x18);           // JR loop
+    loop.push_back(-(loop.size() + 1));
+    std::vector<uint8_t> main
+    {
+        0x31, 0xFE, 0xDF,           // LD SP,DFFE
+        0x3E, 0x11, 0xE0, 0xFF,     // IE = VBlank and joypad
+        0xAF, 0xE0, 0x0F,           // IF = 0
+        0x21, 0x00, 0x98,           // LD HL,9800
+        0xFB,                       // EI
+    };
+    main.insert(main.end(), loop.begin(), loop.end());
+    put(rom, TEST_CODE, main);
+
+    put(rom, 0x300,
+    {
+        0xE5,                       // PUSH HL
+        0x21, 0x00, 0x04,           // LD HL,0400
+        0x11, 0x00, 0xC1,           // LD DE,C100
+        0x0E, 0x10,                 // LD C,10
+        0x2A, 0x12, 0x13, 0x0D, 0x20, 0xFA, // copy
+        0xE1,                       // POP HL
+        0xF0, 0x80, 0x3C, 0xE0, 0x80,   // (FF80)++
+        0xC9,                       // RET
+    });
+    for(uint16_t i{0}; i < 16; i++)
+    {
+        rom[0x400 + i] = i * 17;
+    }
+    std::string fileName{writeROM("replay", rom)};
+
+    // a short session: right, left, A a few times and A held across frames, t-cycles since power on
+    const InputEvent recording[]
+    {
+        {1404480, SDL_SCANCODE_D, true},
+        {1897311, SDL_SCANCODE_D, false},
+        {2106723, SDL_SCANCODE_G, true},
+        {2180107, SDL_SCANCODE_G, false},
+        {2809013, SDL_SCANCODE_A, true},
+        {2950999, SDL_SCANCODE_G, true},
+        {3014521, SDL_SCANCODE_A, false},
+        {3511200, SDL_SCANCODE_G, false},
+        {4213441, SDL_SCANCODE_RETURN, true},
+        {4213441, SDL_SCANCODE_D, true},
+        {4355327, SDL_SCANCODE_RETURN, false},
+        {4917763, SDL_SCANCODE_D, false},
+        {5617921, SDL_SCANCODE_G, true},
+        {5618000, SDL_SCANCODE_G, false},
+        {6320163, SDL_SCANCODE_SPACE, true},
+        {6320164, SDL_SCANCODE_SPACE, false},
+        {7022400, SDL_SCANCODE_G, true},
+        {7724643, SDL_SCANCODE_G, false},
+    };
+
+    CPU expected;
+    CPU actual;
+    expected.loadROM(fileName, "");
+    actual.loadROM(fileName, "");
+    if(!check(!actual.mAotBlocks.empty(), "AOT replay: no generated code for the test ROM, AotReplay.cpp has to be made again"))
+    {
+        return false;
+    }
+    expected.setAotEnabled(false);
+    expected.setBlockCacheEnabled(false);
+    for(CPU* cpu : {&expected, &actual})
+    {
+        cpu->setRenderEnabled(true);
+        for(const InputEvent& event : recording)
+        {
+            cpu->queueInput(event.timestamp, event.key, event.pressed);
+        }
+    }
+
+    bool passed{compareRuns("AOT replay against the interpreter", expected, actual, 120, CYCLES_PER_FRAME)};
+    passed &= check(actual.memMap[0xFF83] >= 5, "AOT replay: the recorded input did not reach the game");
+    return passed;
+}
@@ -0,0 +1,60 @@
+#ifndef CORETEST_H
+#define CORETEST_H
+
+#include <cstdint>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <string>
+
+#include "../CPU.hpp"
+
+/* TEST ROMS */
+constexpr uint16_t TEST_CODE = 0x150;     // where the entry point jumps to
+constexpr uint16_t TEST_ROM_SIZE = 0x8000; // no MBC, two banks
+
+/*
+    Checks run on the real CPU (CPUTest is a copy of an older core). Each one prints what went wrong and returns false,
+    the ROMs they run are built here and written to the temp directory.
+*/
+class CoreTest
+{
+    public:
+        // every case in one file of the JSON opcode tests, once with lazy flags and once without
+        bool JsonState(const std::string fileName);
+        // LCD registers written during mode 3 split the line at the pixel the write lands on
+        bool midLineWrites();
+        // the accurate core takes 5 m-cycles to dispatch an interrupt, the fast core none
+        bool interruptDispatch();
+        // the recompiler against the decoded blocks on self-modifying work RAM code, a chunk past its invalidation limit
+        // and native runs cut short by the timer and the end of the run
+        bool jitDifferential();
+        // code translated ahead of time against the interpreter, both given the same recorded input
+        // (AotReplay.cpp is made from the ROM this writes: RomToCpp GBMooTest_replay.gb src/UnitTesting/AotReplay.cpp)
+        bool aotReplay();
+
+    private:
+        // a ROM only cart that jumps to TEST_CODE, bytes are put in wherever code says
+        static std::vector<uint8_t> makeROM();
+        static void put(std::vector<uint8_t>& rom, uint16_t addr, const std::vector<uint8_t>& bytes);
+        // the name goes in the title and the checksums are filled in, so every test ROM hashes differently (see Cartridge::getROMHash)
+        static std::string writeROM(const std::string& name, std::vector<uint8_t> rom);
+
+        // the whole address space as plain memory, the JSON tests read and write anywhere
+        static void mapFlatMemory(CPU& cpu);
+
+        // one instruction in the fast core, however the CPU is set up to run it
+        static void step(CPU& cpu);
+
+        // both run a frame at a time in runUntil calls of stepCycles, false from the first frame they differ at
+        static bool compareRuns(const std::string& name, CPU& expected, CPU& actual, uint16_t frames, uint32_t stepCycles);
+        // registers, emulated time and everything from VRAM up
+        static uint64_t stateHash(CPU& cpu);
+        static uint64_t frameHash(CPU& cpu);
+
+        static bool check(bool passed, const std::string& message);
+};
+
+#endif
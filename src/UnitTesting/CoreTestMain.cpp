@@ -0,0 +1,30 @@
+#include "CoreTest.hpp"
+
+
+int main(int argc, char* argv[])
+{
+    CoreTest test;
+    bool passed{true};
+
+    // GBMooTest path/to/sm83/v1 also runs the JSON opcode tests, one file per opcode
+    if(argc > 1)
+    {
+        for(const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(argv[1]))
+        {
+            if(entry.path().extension() == ".json")
+            {
+                passed &= test.JsonState(entry.path().string());
+            }
+        }
+    }
+    passed &= test.midLineWrites();
+    passed &= test.interruptDispatch();
+    passed &= test.jitDifferential();
+    passed &= test.aotReplay();
+
+    if(passed)
+    {
+        std::cout << "All tests passed" << std::endl;
+    }
+    return passed ? 0 : 1;
+}
@@ -8,6 +8,12 @@ int main(int argc, char* argv[])
     FrontendSystem frontEnd = FrontendSystem("GBMoo", 600, 600);
     std::string fileAppend = ".gb";
     frontEnd.loadCPURom(argv[1] + fileAppend);
+
+    // GBMoo game accurate runs the cycle accurate core instead of the fast one
+    if((argc > 2) && (std::string(argv[2]) == "accurate"))
+    {
+        frontEnd.setAccuracy(AccuracyMode::Cycle);
+    }
     frontEnd.run();
    
     return 0;
@@ -0,0 +1,817 @@
+/*
+    Ahead of time translation of a game's code to C++ (see src/AotRuntime.hpp).
+
+    RomToCpp game.gb src/AotGame.cpp
+
+    Code is found by walking every jump, call and fallthrough from the entry point, the restart vectors
+    and the interrupt vectors. Code in a switchable bank is walked in the bank it was reached from, or
+    when it was reached from bank 0, in every bank the game was seen selecting with LD A,n / LD (nn),A.
+    Jump tables (JP HL) and code copied to RAM can't be found this way and are left to the interpreter.
+    The generated file goes in src/ with the rest of the emulator and is only used for the ROM it was made from.
+*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <string>
+#include <filesystem>
+
+#include "Cartridge.hpp"
+#include "Mapper.hpp"
+#include "BlockCache.hpp"
+
+/* ENTRY POINTS */
+constexpr uint16_t CART_ENTRY = 0x100;
+constexpr uint16_t RESTART_VECTORS[]{0x00, 0x08, 0x10, 0x18, 0x20, 0x28, 0x30, 0x38};
+constexpr uint16_t INTERRUPT_VECTORS[]{0x40, 0x48, 0x50, 0x58, 0x60};
+constexpr uint16_t SWITCHABLE_BANK = 0x4000;
+constexpr uint16_t CODE_END = 0x8000;           // code in RAM is never translated
+constexpr uint16_t BANK_SELECT = 0x2000;        // writes from here to 0x3FFF pick the switchable bank
+
+/* REGISTERS (same indices as CPU.hpp) */
+constexpr uint8_t REG_C = 1;
+constexpr uint8_t REG_HL_ADDRESS = 6;   // (HL) in the opcode's register fields
+constexpr uint8_t REG_A = 7;
+
+/* RUNS */
+constexpr uint16_t MAX_RUN_CYCLES = 32;         // longer runs would keep ending up past a deadline and be ended one instruction at a time
+
+using CodeAddress = std::pair<uint16_t, uint16_t>; // bank, pc
+
+struct Instruction
+{
+    uint16_t pc;
+    uint8_t bytes[3];
+    uint8_t length;
+};
+
+struct Block
+{
+    CodeAddress start;
+    std::vector<Instruction> instructions;
+};
+
+class RomWalker
+{
+    public:
+        RomWalker(const Cartridge& cartridge)
+        : mROM{cartridge.getROM()}, mROMBanks{cartridge.getROMBankCount()}
+        {
+            // until the game is seen selecting a bank, only the one mapped at power on
+            mSelectedBanks.insert(1);
+        }
+
+        void walk()
+        {
+            addTarget(0, CART_ENTRY);
+            for(uint16_t vector : RESTART_VECTORS)
+            {
+                addTarget(0, vector);
+            }
+            for(uint16_t vector : INTERRUPT_VECTORS)
+            {
+                addTarget(0, vector);
+            }
+
+            // bank 0 jumping into the switchable bank depends on banks that can still be found, so go until nothing new turns up
+            bool found{true};
+            while(found)
+            {
+                while(!mWork.empty())
+                {
+                    CodeAddress address{mWork.back()};
+                    mWork.pop_back();
+                    if(mInstructionStarts.count(address) == 0)
+                    {
+                        walkBlock(address);
+                    }
+                }
+
+                found = false;
+                for(uint16_t pc : mBankedTargets)
+                {
+                    for(uint16_t bank : mSelectedBanks)
+                    {
+                        found |= addCode(bank, pc);
+                    }
+                }
+            }
+        }
+
+        const std::vector<Block>& getBlocks() const
+        {
+            return mBlocks;
+        }
+
+    private:
+        const uint8_t* mROM;
+        uint16_t mROMBanks;
+        std::vector<Block> mBlocks;
+        std::vector<CodeAddress> mWork;
+        std::set<CodeAddress> mQueued;
+        std::set<CodeAddress> mInstructionStarts;
+        std::set<uint16_t> mBankedTargets;  // switchable bank addresses reached from bank 0
+        std::set<uint16_t> mSelectedBanks;
+
+        const uint8_t* getCode(uint16_t bank, uint16_t pc) const
+        {
+            return mROM + (bank * ROM_BANK_SIZE) + (pc % ROM_BANK_SIZE);
+        }
+
+        bool addCode(uint16_t bank, uint16_t pc)
+        {
+            if((bank >= mROMBanks) || !mQueued.insert({bank, pc}).second)
+            {
+                return false;
+            }
+            mWork.push_back({bank, pc});
+            return true;
+        }
+
+        void addTarget(uint16_t fromBank, uint16_t pc)
+        {
+            if(pc >= CODE_END)
+            {
+                return;
+            }
+            if(pc < SWITCHABLE_BANK)
+            {
+                addCode(0, pc);
+            }
+            else if(fromBank != 0)
+            {
+                addCode(fromBank, pc);
+            }
+            else
+            {
+                mBankedTargets.insert(pc);
+                for(uint16_t bank : mSelectedBanks)
+                {
+                    addCode(bank, pc);
+                }
+            }
+        }
+
+        void walkBlock(CodeAddress start)
+        {
+            // like the decoded blocks, a block never crosses a page and stops where another block already starts
+            Block block{start, {}};
+            auto [bank, pc] = start;
+            while(true)
+            {
+                const uint8_t* code{getCode(bank, pc)};
+                uint8_t length{BlockCache::getLength(code[0])};
+                if((pc & PAGE_MASK) + length > PAGE_SIZE)
+                {
+                    break;
+                }
+
+                Instruction instruction{pc, {code[0], 0, 0}, length};
+                for(uint8_t i{1}; i < length; i++)
+                {
+                    instruction.bytes[i] = code[i];
+                }
+                block.instructions.push_back(instruction);
+                mInstructionStarts.insert({bank, pc});
+                findBankSelect(block);
+
+                uint16_t nextPC{pc + length};
+                if(BlockCache::endsBlock(code[0]))
+                {
+                    addSuccessors(bank, instruction, nextPC);
+                    break;
+                }
+                if(((nextPC & PAGE_MASK) == 0) || (mInstructionStarts.count({bank, nextPC}) != 0))
+                {
+                    addTarget(bank, nextPC);
+                    break;
+                }
+                pc = nextPC;
+            }
+
+            if(!block.instructions.empty())
+            {
+                mBlocks.push_back(block);
+            }
+        }
+
+        void addSuccessors(uint16_t bank, const Instruction& instruction, uint16_t nextPC)
+        {
+            uint8_t opcode{instruction.bytes[0]};
+            uint16_t immediate{(instruction.bytes[2] << 8) | instruction.bytes[1]};
+            switch(opcode)
+            {
+                // JR d, then JR cc,d which can also fall through
+                case 0x18:
+                    addTarget(bank, nextPC + static_cast<int8_t>(instruction.bytes[1]));
+                    break;
+                case 0x20: case 0x28: case 0x30: case 0x38:
+                    addTarget(bank, nextPC + static_cast<int8_t>(instruction.bytes[1]));
+                    addTarget(bank, nextPC);
+                    break;
+
+                // JP nn, then JP cc,nn and calls which come back after themselves
+                case 0xC3:
+                    addTarget(bank, immediate);
+                    break;
+                case 0xC2: case 0xCA: case 0xD2: case 0xDA:
+                case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC:
+                    addTarget(bank, immediate);
+                    addTarget(bank, nextPC);
+                    break;
+
+                // RET cc, RST (the vectors are already walked), HALT, STOP and EI go on to the next instruction
+                case 0xC0: case 0xC8: case 0xD0: case 0xD8:
+                case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+                case 0x76: case 0x10: case 0xFB:
+                    addTarget(bank, nextPC);
+                    break;
+            }
+        }
+
+        void findBankSelect(const Block& block)
+        {
+            // LD A,n / LD (nn),A with nn in the bank select range, bank 0 selects bank 1
+            size_t count{block.instructions.size()};
+            if(count < 2)
+            {
+                return;
+            }
+            const Instruction& load{block.instructions[count - 2]};
+            const Instruction& store{block.instructions[count - 1]};
+            uint16_t addr{(store.bytes[2] << 8) | store.bytes[1]};
+            if((load.bytes[0] == 0x3E) && (store.bytes[0] == 0xEA) && (addr >= BANK_SELECT) && (addr < SWITCHABLE_BANK))
+            {
+                uint16_t selected{load.bytes[1] % mROMBanks};
+                mSelectedBanks.insert((selected == 0) ? 1 : selected);
+            }
+        }
+};
+
+class BlockWriter
+{
+    public:
+        BlockWriter(std::ostream& out)
+        : mOut{out}, mNative{0}, mInterpreted{0}
+        {
+        }
+
+        void writeBlock(const Block& block)
+        {
+            // written out first so each instruction knows how many m-cycles are left of its run from there
+            std::vector<Operation> operations;
+            for(const Instruction& instruction : block.instructions)
+            {
+                operations.push_back(writeOperation(instruction));
+            }
+            std::vector<uint16_t> runCycles(operations.size() + 1, 0);
+            std::vector<bool> runStarts(operations.size() + 1, false);  // runs that start right after another one
+            for(size_t i{operations.size()}; i-- > 0;)
+            {
+                uint8_t cycles{operations[i].cycles};
+                if((cycles != 0) && (runCycles[i + 1] != 0) && (runCycles[i + 1] + cycles <= MAX_RUN_CYCLES))
+                {
+                    runCycles[i] = cycles + runCycles[i + 1];
+                    continue;
+                }
+                runCycles[i] = cycles;
+                runStarts[i + 1] = (cycles != 0) && (runCycles[i + 1] != 0);
+            }
+
+            mOut << "// bank " << block.start.first << "\n";
+            mOut << "void " << getName(block) << "(CPU& cpu)\n{\n";
+            if(std::any_of(operations.begin(), operations.end(), [](const Operation& operation) { return operation.cycles != 0; }))
+            {
+                mOut << "    bool charged{false};\n";
+            }
+            mOut << "    switch(R::pc(cpu))\n    {\n";
+            for(size_t i{0}; i < operations.size(); i++)
+            {
+                // every instruction is somewhere the block can be entered
+                const Instruction& instruction{block.instructions[i]};
+                const Operation& operation{operations[i]};
+                bool last{i + 1 == operations.size()};
+                std::string nextPC{hex(instruction.pc + instruction.length, 4)};
+                mOut << "        case " << hex(instruction.pc, 4) << ":\n";
+                if(operation.cycles == 0)
+                {
+                    if((i != 0) && (runCycles[i - 1] != 0))
+                    {
+                        line("charged = false;");
+                    }
+                    writeLines(operation.lines);
+                    writeNext(last, nextPC);
+                    continue;
+                }
+
+                // entered here (charged is still false), after the one before could not be charged, or a new run
+                std::string cycles{std::to_string(runCycles[i])};
+                if(runStarts[i])
+                {
+                    line("charged = R::charge(cpu, " + cycles + ");");
+                }
+                else
+                {
+                    line("if(!charged)");
+                    line("{");
+                    line("    charged = R::charge(cpu, " + cycles + ");");
+                    line("}");
+                }
+                if(!operation.guards.empty())
+                {
+                    std::string guards{operation.guards[0]};
+                    for(size_t j{1}; j < operation.guards.size(); j++)
+                    {
+                        guards += " && " + operation.guards[j];
+                    }
+                    line("if(charged && !(" + guards + "))");
+                    line("{");
+                    line("    charged = R::uncharge(cpu, " + cycles + ");");
+                    line("}");
+                }
+                writeLines(operation.lines);
+
+                // the end of a run leaves pc where an uncharged instruction would have
+                bool runEnds{runStarts[i + 1] || (runCycles[i + 1] == 0)};
+                if(runEnds)
+                {
+                    line("R::pc(cpu) = " + nextPC + ";");
+                }
+                line("if(!charged)");
+                line("{");
+                if(!runEnds)
+                {
+                    line("    R::pc(cpu) = " + nextPC + ";");
+                }
+                line("    R::addCycles(cpu, " + std::to_string(operation.cycles) + ");");
+                if(last)
+                {
+                    line("    R::end(cpu);");
+                }
+                else
+                {
+                    line("    if(!R::next(cpu, " + nextPC + "))");
+                    line("    {");
+                    line("        return;");
+                    line("    }");
+                }
+                line("}");
+                if(!last)
+                {
+                    line("[[fallthrough]];");
+                }
+            }
+            mOut << "    }\n}\n\n";
+        }
+
+        static std::string getName(const Block& block)
+        {
+            std::ostringstream name;
+            name << "block_" << std::hex << std::setfill('0') << std::setw(2) << block.start.first << "_"
+                 << std::setw(4) << block.start.second;
+            return name.str();
+        }
+
+        static std::string hex(uint32_t value, int digits)
+        {
+            std::ostringstream text;
+            text << "0x" << std::uppercase << std::hex << std::setfill('0') << std::setw(digits) << value;
+            return text.str();
+        }
+
+        uint32_t getNativeCount() const
+        {
+            return mNative;
+        }
+
+        uint32_t getInterpretedCount() const
+        {
+            return mInterpreted;
+        }
+
+    private:
+        std::ostream& mOut;
+        uint32_t mNative;
+        uint32_t mInterpreted;
+
+        // What one instruction does in C++
+        struct Operation
+        {
+            std::vector<std::string> lines;
+            std::vector<std::string> guards;    // what has to hold for it to run charged, only plain memory (see AotRuntime::canRead)
+            uint8_t cycles;                     // m-cycles when it can be part of a run, 0 when its lines set pc and cycles themselves
+        };
+
+        void line(const std::string& text)
+        {
+            mOut << "            " << text << "\n";
+        }
+
+        void writeLines(const std::vector<std::string>& lines)
+        {
+            for(const std::string& text : lines)
+            {
+                line(text);
+            }
+        }
+
+        void writeNext(bool last, const std::string& nextPC)
+        {
+            if(last)
+            {
+                line("R::end(cpu);");
+                return;
+            }
+            line("if(!R::next(cpu, " + nextPC + "))");
+            line("{");
+            line("    return;");
+            line("}");
+            line("[[fallthrough]];");
+        }
+
+        static std::string reg(uint8_t index)
+        {
+            static const char* names[]{"R_B", "R_C", "R_D", "R_E", "R_H", "R_L", "R_HL", "R_A"};
+            return std::string{"R::reg(cpu, "} + names[index] + ")";
+        }
+
+        static std::string pair(uint8_t index)
+        {
+            static const char* names[]{"R::pair(cpu, RP_BC)", "R::pair(cpu, RP_DE)", "R::pair(cpu, RP_HL)", "R::sp(cpu)"};
+            return names[index];
+        }
+
+        // memory goes through the page table when the instruction is charged, a guard checks it can first
+        static std::string read(Operation& operation, const std::string& addr)
+        {
+            operation.guards.push_back("R::canRead(cpu, " + addr + ")");
+            return "R::read(cpu, charged, " + addr + ")";
+        }
+
+        static std::string write(Operation& operation, const std::string& addr, const std::string& data)
+        {
+            operation.guards.push_back("R::canWrite(cpu, " + addr + ")");
+            return "R::write(cpu, charged, " + addr + ", " + data + ");";
+        }
+
+        // the same as the op functions in CPUOpcode.cpp
+        Operation writeOperation(const Instruction& instruction)
+        {
+            Operation operation{{}, {}, 0};
+            std::vector<std::string>& lines{operation.lines};
+            uint8_t opcode{instruction.bytes[0]};
+            uint8_t XX{opcode >> 6};
+            uint8_t YYY{(opcode >> 3) & 0b111};
+            uint8_t ZZZ{opcode & 0b111};
+            uint8_t P{(opcode >> 4) & 0b11};
+            std::string n{hex(instruction.bytes[1], 2)};
+            std::string nn{hex((instruction.bytes[2] << 8) | instruction.bytes[1], 4)};
+            std::string nextPC{hex(instruction.pc + instruction.length, 4)};
+            std::string target{hex(static_cast<uint16_t>(instruction.pc + instruction.length + static_cast<int8_t>(instruction.bytes[1])), 4)};
+            std::string hl{"R::pair(cpu, RP_HL)"};
+            uint8_t cycles{0};
+
+            // NOP
+            if(opcode == 0x00)
+            {
+                cycles = 1;
+            }
+            // LD rr,nn
+            else if((XX == 0) && ((opcode & 0x0F) == 0x01))
+            {
+                lines.push_back(pair(P) + " = " + nn + ";");
+                cycles = 3;
+            }
+            // ADD HL,rr
+            else if((XX == 0) && ((opcode & 0x0F) == 0x09))
+            {
+                lines.push_back("R::addHL(cpu, " + pair(P) + ");");
+                cycles = 2;
+            }
+            // INC rr / DEC rr
+            else if((XX == 0) && (ZZZ == 3))
+            {
+                lines.push_back(pair(P) + ((opcode & 0x08) ? "--;" : "++;"));
+                cycles = 2;
+            }
+            // INC r / DEC r / INC (HL) / DEC (HL)
+            else if((XX == 0) && ((ZZZ == 4) || (ZZZ == 5)))
+            {
+                std::string function{(ZZZ == 4) ? "R::inc" : "R::dec"};
+                if(YYY == REG_HL_ADDRESS)
+                {
+                    lines.push_back(write(operation, hl, function + "(cpu, " + read(operation, hl) + ")"));
+                    cycles = 3;
+                }
+                else
+                {
+                    lines.push_back(reg(YYY) + " = " + function + "(cpu, " + reg(YYY) + ");");
+                    cycles = 1;
+                }
+            }
+            // LD r,n / LD (HL),n
+            else if((XX == 0) && (ZZZ == 6))
+            {
+                if(YYY == REG_HL_ADDRESS)
+                {
+                    lines.push_back(write(operation, hl, n));
+                    cycles = 3;
+                }
+                else
+                {
+                    lines.push_back(reg(YYY) + " = " + n + ";");
+                    cycles = 2;
+                }
+            }
+            // LD (BC),A / LD (DE),A / LD A,(BC) / LD A,(DE)
+            else if((opcode == 0x02) || (opcode == 0x12))
+            {
+                lines.push_back(write(operation, pair(P), reg(REG_A)));
+                cycles = 2;
+            }
+            else if((opcode == 0x0A) || (opcode == 0x1A))
+            {
+                lines.push_back(reg(REG_A) + " = " + read(operation, pair(P)) + ";");
+                cycles = 2;
+            }
+            // LD (HL+),A / LD (HL-),A / LD A,(HL+) / LD A,(HL-)
+            else if((opcode == 0x22) || (opcode == 0x32))
+            {
+                lines.push_back(write(operation, hl, reg(REG_A)));
+                lines.push_back(hl + ((opcode == 0x22) ? "++;" : "--;"));
+                cycles = 2;
+            }
+            else if((opcode == 0x2A) || (opcode == 0x3A))
+            {
+                lines.push_back(reg(REG_A) + " = " + read(operation, hl) + ";");
+                lines.push_back(hl + ((opcode == 0x2A) ? "++;" : "--;"));
+                cycles = 2;
+            }
+            // RLCA / RRCA / RLA / RRA / CPL / SCF / CCF, not DAA
+            else if((XX == 0) && (ZZZ == 7) && (YYY < 4))
+            {
+                lines.push_back("R::rotateA(cpu, " + std::to_string(YYY) + ");");
+                cycles = 1;
+            }
+            else if(opcode == 0x2F)
+            {
+                lines.push_back("R::cpl(cpu);");
+                cycles = 1;
+            }
+            else if((opcode == 0x37) || (opcode == 0x3F))
+            {
+                lines.push_back(std::string{"R::setCarry(cpu, "} + ((opcode == 0x3F) ? "true" : "false") + ");");
+                cycles = 1;
+            }
+            // LD r,r' / LD (HL),r / LD r,(HL), not HALT
+            else if((XX == 1) && (opcode != 0x76))
+            {
+                if(YYY == REG_HL_ADDRESS)
+                {
+                    lines.push_back(write(operation, hl, reg(ZZZ)));
+                    cycles = 2;
+                }
+                else if(ZZZ == REG_HL_ADDRESS)
+                {
+                    lines.push_back(reg(YYY) + " = " + read(operation, hl) + ";");
+                    cycles = 2;
+                }
+                else
+                {
+                    lines.push_back(reg(YYY) + " = " + reg(ZZZ) + ";");
+                    cycles = 1;
+                }
+            }
+            // ADD ADC SUB SBC AND XOR OR CP with r, (HL) or n
+            else if((XX == 2) || ((XX == 3) && (ZZZ == 6)))
+            {
+                std::string operand{(XX == 3) ? n : (ZZZ == REG_HL_ADDRESS) ? read(operation, hl) : reg(ZZZ)};
+                lines.push_back("R::alu(cpu, " + std::to_string(YYY) + ", " + operand + ");");
+                cycles = ((XX == 3) || (ZZZ == REG_HL_ADDRESS)) ? 2 : 1;
+            }
+            // LDH (n),A / LDH A,(n) / LD (C),A / LD A,(C) / LD (nn),A / LD A,(nn)
+            else if(opcode == 0xE0)
+            {
+                lines.push_back(write(operation, "0xFF00 + " + n, reg(REG_A)));
+                cycles = 3;
+            }
+            else if(opcode == 0xF0)
+            {
+                lines.push_back(reg(REG_A) + " = " + read(operation, "0xFF00 + " + n) + ";");
+                cycles = 3;
+            }
+            else if(opcode == 0xE2)
+            {
+                lines.push_back(write(operation, "0xFF00 + " + reg(REG_C), reg(REG_A)));
+                cycles = 2;
+            }
+            else if(opcode == 0xF2)
+            {
+                lines.push_back(reg(REG_A) + " = " + read(operation, "0xFF00 + " + reg(REG_C)) + ";");
+                cycles = 2;
+            }
+            else if(opcode == 0xEA)
+            {
+                lines.push_back(write(operation, nn, reg(REG_A)));
+                cycles = 4;
+            }
+            else if(opcode == 0xFA)
+            {
+                lines.push_back(reg(REG_A) + " = " + read(operation, nn) + ";");
+                cycles = 4;
+            }
+            // LD SP,HL / POP rr / PUSH rr, AF through F's own rules
+            else if(opcode == 0xF9)
+            {
+                lines.push_back("R::sp(cpu) = " + hl + ";");
+                cycles = 2;
+            }
+            else if((XX == 3) && (ZZZ == 1) && ((opcode & 0x08) == 0))
+            {
+                operation.guards.push_back("R::canPop(cpu)");
+                lines.push_back((P == 3) ? "R::setAF(cpu, R::pop(cpu, charged));" : pair(P) + " = R::pop(cpu, charged);");
+                cycles = 3;
+            }
+            else if((XX == 3) && (ZZZ == 5) && ((opcode & 0x08) == 0))
+            {
+                operation.guards.push_back("R::canPush(cpu)");
+                lines.push_back("R::push(cpu, charged, " + ((P == 3) ? std::string{"R::getAF(cpu)"} : pair(P)) + ");");
+                cycles = 4;
+            }
+            // CB rotates and shifts / BIT / RES / SET, on r or (HL)
+            else if(opcode == 0xCB)
+            {
+                uint8_t prefixed{instruction.bytes[1]};
+                uint8_t group{prefixed >> 6};
+                uint8_t y{(prefixed >> 3) & 0b111};
+                uint8_t z{prefixed & 0b111};
+                std::string data{(z == REG_HL_ADDRESS) ? read(operation, hl) : reg(z)};
+                std::string result;
+                switch(group)
+                {
+                    case 0:
+                        result = "R::rotate(cpu, " + std::to_string(y) + ", " + data + ")";
+                        break;
+                    case 1:
+                        lines.push_back("R::bit(cpu, " + std::to_string(y) + ", " + data + ");");
+                        break;
+                    case 2:
+                        result = data + " & " + hex(~(1 << y) & 0xFF, 2);
+                        break;
+                    case 3:
+                        result = data + " | " + hex(1 << y, 2);
+                        break;
+                }
+                if(!result.empty())
+                {
+                    lines.push_back((z == REG_HL_ADDRESS) ? write(operation, hl, result) : reg(z) + " = " + result + ";");
+                }
+                cycles = (z != REG_HL_ADDRESS) ? 2 : (group == 1) ? 3 : 4;
+            }
+
+            // JR d / JR cc,d / JP nn / JP cc,nn / JP HL, pc is set here so the block is done
+            else if(opcode == 0x18)
+            {
+                writeJump(lines, target, "3");
+            }
+            else if((opcode == 0x20) || (opcode == 0x28) || (opcode == 0x30) || (opcode == 0x38))
+            {
+                writeBranch(lines, YYY - 4, {"R::pc(cpu) = " + target + ";"}, "3", nextPC, "2");
+            }
+            else if(opcode == 0xC3)
+            {
+                writeJump(lines, nn, "4");
+            }
+            else if((opcode == 0xC2) || (opcode == 0xCA) || (opcode == 0xD2) || (opcode == 0xDA))
+            {
+                writeBranch(lines, YYY, {"R::pc(cpu) = " + nn + ";"}, "4", nextPC, "3");
+            }
+            else if(opcode == 0xE9)
+            {
+                writeJump(lines, hl, "1");
+            }
+            // CALL nn / CALL cc,nn / RET / RET cc / RST, never charged as they end the block
+            else if(opcode == 0xCD)
+            {
+                lines.push_back("R::push(cpu, false, " + nextPC + ");");
+                writeJump(lines, nn, "6");
+            }
+            else if((opcode == 0xC4) || (opcode == 0xCC) || (opcode == 0xD4) || (opcode == 0xDC))
+            {
+                writeBranch(lines, YYY, {"R::push(cpu, false, " + nextPC + ");", "R::pc(cpu) = " + nn + ";"}, "6", nextPC, "3");
+            }
+            else if(opcode == 0xC9)
+            {
+                writeJump(lines, "R::pop(cpu, false)", "4");
+            }
+            else if((opcode == 0xC0) || (opcode == 0xC8) || (opcode == 0xD0) || (opcode == 0xD8))
+            {
+                writeBranch(lines, YYY, {"R::pc(cpu) = R::pop(cpu, false);"}, "5", nextPC, "2");
+            }
+            else if((XX == 3) && (ZZZ == 7))
+            {
+                lines.push_back("R::push(cpu, false, " + nextPC + ");");
+                writeJump(lines, hex(YYY * 8, 4), "4");
+            }
+            else
+            {
+                lines.push_back("R::execute(cpu, {" + hex(instruction.bytes[0], 2) + ", " + hex(instruction.bytes[1], 2) + ", " +
+                                hex(instruction.bytes[2], 2) + "});");
+                mInterpreted++;
+                return operation;
+            }
+
+            // an uncharged access lands after the operand bytes (see CPU::mAccessCycles)
+            if(!operation.guards.empty() && (instruction.length > 1))
+            {
+                lines.insert(lines.begin(), "R::fetchOperands(cpu, charged, " + std::to_string(instruction.length - 1) + ");");
+            }
+
+            operation.cycles = cycles;
+            mNative++;
+            return operation;
+        }
+
+        static void writeJump(std::vector<std::string>& lines, const std::string& target, const std::string& cycles)
+        {
+            lines.push_back("R::pc(cpu) = " + target + ";");
+            lines.push_back("R::addCycles(cpu, " + cycles + ");");
+        }
+
+        static void writeBranch(std::vector<std::string>& lines, uint8_t condition, const std::vector<std::string>& taken,
+                                const std::string& takenCycles, const std::string& nextPC, const std::string& notTakenCycles)
+        {
+            lines.push_back("if(R::condition(cpu, " + std::to_string(condition) + "))");
+            lines.push_back("{");
+            for(const std::string& text : taken)
+            {
+                lines.push_back("    " + text);
+            }
+            lines.push_back("    R::addCycles(cpu, " + takenCycles + ");");
+            lines.push_back("}");
+            lines.push_back("else");
+            lines.push_back("{");
+            lines.push_back("    R::pc(cpu) = " + nextPC + ";");
+            lines.push_back("    R::addCycles(cpu, " + notTakenCycles + ");");
+            lines.push_back("}");
+        }
+};
+
+int main(int argc, char* argv[])
+{
+    if(argc != 3)
+    {
+        std::cout << "Usage: RomToCpp game.gb src/AotGame.cpp" << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<const Cartridge> cartridge{Cartridge::load(argv[1])};
+    if(!cartridge)
+    {
+        return 1;
+    }
+
+    RomWalker walker{*cartridge};
+    walker.walk();
+
+    std::ofstream out{argv[2]};
+    if(!out)
+    {
+        std::cout << "Could not write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    out << "// Made by tools/RomToCpp from " << std::filesystem::path(argv[1]).filename().string() << ", do not edit\n";
+    out << "#include \"AotRuntime.hpp\"\n\n";
+    out << "using R = AotRuntime;\n\n";
+    out << "namespace\n{\n\n";
+
+    BlockWriter writer{out};
+    uint32_t entryCount{0};
+    for(const Block& block : walker.getBlocks())
+    {
+        writer.writeBlock(block);
+        entryCount += block.instructions.size();
+    }
+
+    out << "const AotEntry entries[]\n{\n";
+    for(const Block& block : walker.getBlocks())
+    {
+        for(const Instruction& instruction : block.instructions)
+        {
+            out << "    {" << block.start.first << ", " << BlockWriter::hex(instruction.pc, 4) << ", &" << BlockWriter::getName(block) << "},\n";
+        }
+    }
+    out << "};\n\n";
+    out << "const bool registered{AotRuntime::registerProgram({" << BlockWriter::hex(cartridge->getROMHash(), 6) << ", "
+        << cartridge->getROMBankCount() << ", entries, " << entryCount << "})};\n\n";
+    out << "}\n";
+
+    std::cout << walker.getBlocks().size() << " blocks, " << entryCount << " instructions (" << writer.getNativeCount()
+              << " written out, " << writer.getInterpretedCount() << " left to the interpreter)" << std::endl;
+    return 0;
+}
\ No newline at end of file